@@ -0,0 +1,206 @@
+#include <GL/glew.h>
+#include <glfw3.h>
+#include <common/shader.hpp>
+#include <playground/gameData.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace gameData;
+using namespace std::chrono;
+
+/*
+* benchmark of the antialiasing modes of the playground (see playground.h -> antialiasingMode)
+*  - msaa: 4 samples per pixel, rectangular fields, resolved to a single-sampled framebuffer
+*  - sdf:  1 sample per pixel, rounded rectangles with coverage calculated by the fragment shader (blended)
+*  - none: 1 sample per pixel without antialiasing (reference)
+* every frame redraws every field of the playground's layout (the worst case of the damage tracking) and is copied to a
+* single-sampled framebuffer like the playground's window, the GPU is synchronized by glFinish after every run
+* usage (from the playground directory, the shaders are loaded from the working directory): antialiasingBenchmark [width] [height]
+*/
+
+//number of frames per run
+constexpr int frameCountPerRun = 500;
+//number of fields (main field and preview field)
+constexpr int rectangleCount = fieldX * fieldY + 16;
+
+//modes of the benchmark
+struct Mode {
+	const char* name;
+	int samples;
+	bool sdf;
+};
+
+/*
+* offscreen framebuffer with a single color renderbuffer
+*/
+struct FrameBuffer {
+	GLuint frameBuffer = 0, color = 0;
+	/*
+	* create the framebuffer
+	* @param width, height size in pixels
+	* @param samples samples per pixel (0 without multisampling)
+	* @return whether the framebuffer is complete
+	*/
+	bool create(const int width, const int height, const int samples) {
+		glGenRenderbuffers(1, &color);
+		glBindRenderbuffer(GL_RENDERBUFFER, color);
+		glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_RGBA8, width, height);
+		glGenFramebuffers(1, &frameBuffer);
+		glBindFramebuffer(GL_FRAMEBUFFER, frameBuffer);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+		return glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+	}
+	void destroy() {
+		glDeleteFramebuffers(1, &frameBuffer);
+		glDeleteRenderbuffers(1, &color);
+	}
+};
+
+/*
+* fill the vertex, color and shape buffers with the fields of the playground (every field in units of fields, see staticInitVertexBuffer)
+* @param vertices, colors, shapes vectors, the data of every vertex will be added to
+*/
+static void createFields(std::vector<GLfloat>& vertices, std::vector<GLfloat>& colors, std::vector<GLfloat>& shapes) {
+	uint32_t random = 12345;
+	for (int i = 0; i < rectangleCount; i++) {
+		const int x = i < 16 ? i % 4 : (i - 16) % fieldX;
+		const int y = i < 16 ? i / 4 : (i - 16) / fieldX;
+		//random colors of the bricks (or empty fields)
+		random ^= random << 13;
+		random ^= random >> 17;
+		random ^= random << 5;
+		float r, g, b;
+		getTypeColor((int)(random % (brickCount + 1)) - 1, &r, &g, &b);
+		for (int v = 0; v < 6; v++) {
+			vertices.push_back(x + spacing + vertex_buffer_single[3 * v] * (1 - spacing * 2));
+			vertices.push_back(y + spacing + vertex_buffer_single[3 * v + 1] * (1 - spacing * 2));
+			vertices.push_back(0.0f);
+			colors.push_back(r);
+			colors.push_back(g);
+			colors.push_back(b);
+			shapes.push_back(vertex_buffer_single[3 * v]);
+			shapes.push_back(vertex_buffer_single[3 * v + 1]);
+			shapes.push_back(1 - spacing * 2);
+			shapes.push_back(1 - spacing * 2);
+		}
+	}
+}
+
+int main(int argc, char* argv[]) {
+	const int width = argc > 1 ? atoi(argv[1]) : 714;
+	const int height = argc > 2 ? atoi(argv[2]) : 900;
+
+	//hidden window, only it's context is used
+	if (!glfwInit()) {
+		fprintf(stderr, "Failed to initialize GLFW\n");
+		return -1;
+	}
+	glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	GLFWwindow* window = glfwCreateWindow(64, 64, "antialiasingBenchmark", NULL, NULL);
+	if (window == NULL) {
+		fprintf(stderr, "Failed to open GLFW window\n");
+		glfwTerminate();
+		return -1;
+	}
+	glfwMakeContextCurrent(window);
+	glewExperimental = true;
+	if (glewInit() != GLEW_OK) {
+		fprintf(stderr, "Failed to initialize GLEW\n");
+		glfwTerminate();
+		return -1;
+	}
+
+	GLuint programID = LoadShaders("SimpleVertexShader.vertexshader", "SimpleFragmentShader.fragmentshader");
+	if (programID == 0) return -1;
+
+	//buffers of every field
+	std::vector<GLfloat> vertices, colors, shapes;
+	createFields(vertices, colors, shapes);
+	GLuint vertexArray, buffers[3];
+	glGenVertexArrays(1, &vertexArray);
+	glBindVertexArray(vertexArray);
+	glGenBuffers(3, buffers);
+	const std::vector<GLfloat>* data[3] = { &vertices, &colors, &shapes };
+	const int components[3] = { 3, 3, 4 };
+	for (int i = 0; i < 3; i++) {
+		glBindBuffer(GL_ARRAY_BUFFER, buffers[i]);
+		glBufferData(GL_ARRAY_BUFFER, data[i]->size() * sizeof(GLfloat), data[i]->data(), GL_STATIC_DRAW);
+		glEnableVertexAttribArray(i);
+		glVertexAttribPointer(i, components[i], GL_FLOAT, GL_FALSE, 0, (void*)0);
+	}
+
+	//layout of the playground (see updateLayout): the main field on the left, the preview field in the upper right corner
+	const float layoutWidth = 2.0f / mx, layoutHeight = 2.0f / my, previewScale = mxPreview / mx;
+	const float scale = std::min(width / layoutWidth, height / layoutHeight);
+	const float mainX = (width - layoutWidth * scale) / 2, mainY = (height - layoutHeight * scale) / 2;
+	const float previewX = mainX + (layoutWidth - (4 + 2 * spacing) * previewScale) * scale;
+	const float previewY = mainY + (layoutHeight - (4 + 2 * spacing) * previewScale) * scale;
+
+	glUseProgram(programID);
+	const GLint layoutTransformID = glGetUniformLocation(programID, "layoutTransform");
+	glUniform2f(glGetUniformLocation(programID, "framebufferSize"), (float)width, (float)height);
+	glUniform1f(glGetUniformLocation(programID, "cornerRadius"), 0.3f);
+	glClearColor(backgroundColor[0], backgroundColor[1], backgroundColor[2], 1.0f);
+	glViewport(0, 0, width, height);
+
+	//single-sampled target of every frame (like the playground's window)
+	FrameBuffer target;
+	if (!target.create(width, height, 0)) {
+		fprintf(stderr, "Failed to create the target framebuffer\n");
+		return -1;
+	}
+
+	const Mode modes[] = { { "msaa", 4, false }, { "sdf", 0, true }, { "none", 0, false } };
+	printf("%dx%d pixels, %d fields, %d frames per run\n", width, height, rectangleCount, frameCountPerRun);
+	printf("mode   color buffer   frame (fastest of 3 runs)\n");
+	for (const Mode& mode : modes) {
+		FrameBuffer frameBuffer;
+		if (!frameBuffer.create(width, height, mode.samples)) {
+			fprintf(stderr, "Failed to create the framebuffer of mode %s\n", mode.name);
+			return -1;
+		}
+		glUniform1i(glGetUniformLocation(programID, "sdfAntialiasing"), mode.sdf);
+		if (mode.sdf) {
+			glEnable(GL_BLEND);
+			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		}
+		else glDisable(GL_BLEND);
+
+		double best = 1e9;
+		for (int run = 0; run < 3; run++) {
+			glFinish();
+			auto tStart = high_resolution_clock::now();
+			for (int frame = 0; frame < frameCountPerRun; frame++) {
+				glBindFramebuffer(GL_FRAMEBUFFER, frameBuffer.frameBuffer);
+				glClear(GL_COLOR_BUFFER_BIT);
+				glUniform4f(layoutTransformID, 2 * previewScale * scale / width, 2 * previewScale * scale / height, 2 * previewX / width - 1, 2 * previewY / height - 1);
+				glDrawArrays(GL_TRIANGLES, 0, 6 * 16);
+				glUniform4f(layoutTransformID, 2 * scale / width, 2 * scale / height, 2 * mainX / width - 1, 2 * mainY / height - 1);
+				glDrawArrays(GL_TRIANGLES, 6 * 16, 6 * (rectangleCount - 16));
+				//resolving (or copying) the frame to the target
+				glBindFramebuffer(GL_READ_FRAMEBUFFER, frameBuffer.frameBuffer);
+				glBindFramebuffer(GL_DRAW_FRAMEBUFFER, target.frameBuffer);
+				glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+			}
+			glFinish();
+			best = std::min(best, duration_cast<nanoseconds>(high_resolution_clock::now() - tStart).count() / 1e6 / frameCountPerRun);
+		}
+		const double megabytes = width * height * 4.0 * (mode.samples > 0 ? mode.samples : 1) / (1024 * 1024);
+		printf("%-6s %9.1f MB   %10.3f ms\n", mode.name, megabytes, best);
+		frameBuffer.destroy();
+	}
+
+	target.destroy();
+	glDeleteBuffers(3, buffers);
+	glDeleteVertexArrays(1, &vertexArray);
+	glDeleteProgram(programID);
+	glfwTerminate();
+	return 0;
+}
@@ -0,0 +1,217 @@
+#include <vector>
+#include <glm/glm.hpp>
+#include <common/assetpack.hpp>
+#include <common/objloader.hpp>
+#include <chrono>
+#include <algorithm>
+#include <string>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+using namespace std::chrono;
+
+/*
+* benchmark of loading the assets of a game: loose files vs. an asset pack (see common/assetpack.hpp)
+*  - files: every asset is opened and read with stdio like the loaders did, meshes are parsed by loadOBJ
+*  - pack:  the pack is mapped once, every asset is used in place, meshes are copied from their transcoded triangles
+* the assets are generated shaders, BMP textures, DDS textures and OBJ meshes, the bytes of every asset and the triangles
+* of every mesh are compared between the two
+* the files are in the page cache after the first run (the time of a cold start depends on the disk)
+*/
+
+//number of assets of every kind
+constexpr int shaderCount = 48;
+constexpr int textureCount = 16;
+constexpr int meshCount = 4;
+//rings and segments of the meshes (about 2 MB of OBJ each)
+constexpr int rings = 100;
+constexpr int segments = 100;
+//the pack (in the working directory, removed at the end with the assets)
+static const char* packPath = "assetPackBenchmark.pak";
+
+/*
+* write a file
+* @return whether the file was written
+*/
+static bool writeFile(const std::string& path, const std::vector<unsigned char>& data) {
+	FILE* file = fopen(path.c_str(), "wb");
+	if (file == NULL) return false;
+	const bool complete = fwrite(data.data(), 1, data.size(), file) == data.size();
+	return fclose(file) == 0 && complete;
+}
+
+/*
+* read a whole file with stdio
+* @return whether the file could be read
+*/
+static bool readFile(const std::string& path, std::vector<unsigned char>& data) {
+	FILE* file = fopen(path.c_str(), "rb");
+	if (file == NULL) return false;
+	fseek(file, 0, SEEK_END);
+	data.resize(ftell(file));
+	fseek(file, 0, SEEK_SET);
+	const bool complete = data.empty() || fread(&data[0], 1, data.size(), file) == data.size();
+	fclose(file);
+	return complete;
+}
+
+/*
+* generate the assets
+* @param paths vector, the file names of the assets will be added to
+* @return whether every asset was written
+*/
+static bool writeAssets(std::vector<std::string>& paths) {
+	uint32_t random = 12345;
+	auto next = [&random]() {
+		random ^= random << 13;
+		random ^= random >> 17;
+		random ^= random << 5;
+		return random;
+	};
+	for (int i = 0; i < shaderCount; i++) {
+		std::string source = "#version 330 core\n";
+		while (source.size() < 3000) source += "uniform vec4 parameter" + std::to_string(next() % 1000) + ";\n";
+		source += "void main(){ gl_Position = vec4(0.0); }\n";
+		paths.push_back("assetPackBenchmark" + std::to_string(i) + (i % 2 == 0 ? ".vertexshader" : ".fragmentshader"));
+		if (!writeFile(paths.back(), std::vector<unsigned char>(source.begin(), source.end()))) return false;
+	}
+	for (int i = 0; i < textureCount; i++) {
+		//256x256 24bpp BMP files and 512x512 DXT1 DDS files (the headers aren't read by the benchmark)
+		std::vector<unsigned char> data(i % 2 == 0 ? 54 + 256 * 256 * 3 : 128 + 512 * 512 / 2 * 4 / 3);
+		for (unsigned char& byte : data) byte = (unsigned char)next();
+		paths.push_back("assetPackBenchmark" + std::to_string(i) + (i % 2 == 0 ? ".bmp" : ".dds"));
+		if (!writeFile(paths.back(), data)) return false;
+	}
+	for (int i = 0; i < meshCount; i++) {
+		paths.push_back("assetPackBenchmark" + std::to_string(i) + ".obj");
+		FILE* file = fopen(paths.back().c_str(), "w");
+		if (file == NULL) return false;
+		for (int r = 0; r <= rings; r++) {
+			for (int s = 0; s <= segments; s++) {
+				const float theta = 3.14159265f * r / rings, phi = 6.2831853f * s / segments;
+				const float x = sinf(theta) * cosf(phi), y = cosf(theta), z = sinf(theta) * sinf(phi);
+				fprintf(file, "v %.6f %.6f %.6f\nvt %.6f %.6f\nvn %.6f %.6f %.6f\n", x * (i + 1), y * (i + 1), z * (i + 1), (float)s / segments, (float)r / rings, x, y, z);
+			}
+		}
+		for (int r = 0; r < rings; r++) {
+			for (int s = 0; s < segments; s++) {
+				const int a = r * (segments + 1) + s + 1, b = a + segments + 1;
+				fprintf(file, "f %d/%d/%d %d/%d/%d %d/%d/%d\n", a, a, a, b, b, b, a + 1, a + 1, a + 1);
+				fprintf(file, "f %d/%d/%d %d/%d/%d %d/%d/%d\n", a + 1, a + 1, a + 1, b, b, b, b + 1, b + 1, b + 1);
+			}
+		}
+		if (fclose(file) != 0) return false;
+	}
+	return true;
+}
+
+/*
+* loaded assets of an implementation: the bytes of every shader and texture, the triangles of the meshes
+*/
+struct Assets {
+	std::vector<std::vector<unsigned char>> files;
+	std::vector<glm::vec3> vertices;
+	std::vector<glm::vec2> uvs;
+	std::vector<glm::vec3> normals;
+};
+
+/*
+* load every asset from the loose files
+* @return milliseconds of the load (negative if an asset couldn't be loaded)
+*/
+static double loadFiles(const std::vector<std::string>& paths, Assets* assets) {
+	*assets = Assets();
+	auto tStart = high_resolution_clock::now();
+	for (const std::string& path : paths) {
+		if (path.compare(path.size() - 4, 4, ".obj") == 0) {
+			if (!loadOBJ(path.c_str(), assets->vertices, assets->uvs, assets->normals)) return -1;
+		}
+		else {
+			assets->files.push_back(std::vector<unsigned char>());
+			if (!readFile(path, assets->files.back())) return -1;
+		}
+	}
+	return duration_cast<microseconds>(high_resolution_clock::now() - tStart).count() / 1000.0;
+}
+
+/*
+* load every asset from the pack (the bytes of shaders and textures are copied for the comparison, a loader uses them in place)
+* @param copyTime milliseconds of those copies (not part of the load)
+* @return milliseconds of the load (negative if an asset couldn't be loaded)
+*/
+static double loadPack(const std::vector<std::string>& paths, Assets* assets, double* copyTime) {
+	*assets = Assets();
+	auto tStart = high_resolution_clock::now();
+	double copies = 0;
+	AssetPack pack;
+	if (!pack.open(packPath)) return -1;
+	for (const std::string& path : paths) {
+		const AssetSpan span = pack.find(path.c_str());
+		if (span.data == NULL) return -1;
+		if (span.flags & ASSET_TRANSCODED_OBJ) {
+			if (!loadOBJFromMemory(span.data, span.size, path.c_str(), assets->vertices, assets->uvs, assets->normals)) return -1;
+		}
+		else {
+			auto tCopy = high_resolution_clock::now();
+			const unsigned char* data = (const unsigned char*)span.data;
+			assets->files.push_back(std::vector<unsigned char>(data, data + span.size));
+			copies += duration_cast<nanoseconds>(high_resolution_clock::now() - tCopy).count() / 1e6;
+		}
+	}
+	*copyTime = copies;
+	return duration_cast<microseconds>(high_resolution_clock::now() - tStart).count() / 1000.0 - copies;
+}
+
+int main() {
+	std::vector<std::string> paths;
+	if (!writeAssets(paths)) {
+		fprintf(stderr, "Can't write the assets\n");
+		return 1;
+	}
+	//the pack is written like the assetpack builder does (OBJ files transcoded)
+	std::vector<AssetPackInput> inputs;
+	size_t fileBytes = 0;
+	for (const std::string& path : paths) {
+		AssetPackInput input;
+		input.name = path;
+		input.flags = 0;
+		if (path.compare(path.size() - 4, 4, ".obj") == 0) {
+			std::vector<glm::vec3> vertices, normals;
+			std::vector<glm::vec2> uvs;
+			if (!loadOBJ(path.c_str(), vertices, uvs, normals) || !encodeOBJCache(vertices, uvs, normals, input.data)) return 1;
+			input.flags = ASSET_TRANSCODED_OBJ;
+		}
+		else if (!readFile(path, input.data)) {
+			return 1;
+		}
+		std::vector<unsigned char> file;
+		readFile(path, file);
+		fileBytes += file.size();
+		inputs.push_back(input);
+	}
+	if (!writeAssetPack(packPath, inputs)) {
+		fprintf(stderr, "Can't write %s\n", packPath);
+		return 1;
+	}
+
+	//fastest of 5 runs
+	Assets files, packed;
+	double filesTime = 1e18, packTime = 1e18, copyTime = 0;
+	for (int run = 0; run < 5; run++) {
+		filesTime = std::min(filesTime, loadFiles(paths, &files));
+		packTime = std::min(packTime, loadPack(paths, &packed, &copyTime));
+	}
+
+	const bool equal = filesTime >= 0 && packTime >= 0 && files.files == packed.files && files.vertices == packed.vertices
+		&& files.uvs == packed.uvs && files.normals == packed.normals;
+
+	printf("%zu assets, %.1f MB of files (fastest of 5 runs, files in the page cache)\n", paths.size(), fileBytes / 1e6);
+	printf("files: %8.2f ms (%zu opens)\n", filesTime, paths.size());
+	printf("pack:  %8.2f ms (1 open, %.1fx)\n", packTime, filesTime / packTime);
+	printf("assets equal: %s\n", equal ? "yes" : "no");
+	for (const std::string& path : paths) remove(path.c_str());
+	remove(packPath);
+	return equal ? 0 : 1;
+}
@@ -0,0 +1,42 @@
+#include "benchmarkMeshes.h"
+#include <algorithm>
+#include <math.h>
+
+Mesh createGrid(const int quads, const float jitter, const int flags) {
+	Mesh mesh;
+	uint32_t random = 12345;
+	auto next = [&random]() {
+		return (nextRandom(random) >> 8) / 16777216.0f - 0.5f;
+	};
+	//two triangles per quad
+	const int corners[6][2] = { { 0, 0 }, { 1, 0 }, { 0, 1 }, { 0, 1 }, { 1, 0 }, { 1, 1 } };
+	for (int y = 0; y < quads; y++) {
+		for (int x = 0; x < quads; x++) {
+			for (int i = 0; i < 6; i++) {
+				const float u = (float)(x + corners[i][0]) / quads, v = (float)(y + corners[i][1]) / quads;
+				const float height = 0.2f * sinf(u * 20) * cosf(v * 20);
+				//adding 0 turns -0 into +0, so the corners of neighbouring quads are bitwise equal without jitter
+				mesh.vertices.push_back(glm::vec3(u * 10 + jitter * next(), height + jitter * next() + 0.0f, v * 10 + jitter * next()));
+				mesh.uvs.push_back(glm::vec2(u, (flags & GRID_MIRRORED_UVS) && y % 2 != 0 ? -v : v));
+				mesh.normals.push_back(glm::normalize(glm::vec3(-4 * cosf(u * 20) * cosf(v * 20), 10, 4 * sinf(u * 20) * sinf(v * 20))));
+				mesh.tangents.push_back(glm::vec3(1, next(), 0));
+				mesh.bitangents.push_back(glm::vec3(0, next(), 1));
+			}
+		}
+	}
+	if (flags & GRID_SHUFFLED) {
+		//Fisher-Yates shuffle of the triangles (their three corners stay together)
+		uint32_t order = 12345;
+		for (size_t i = mesh.vertices.size() / 3 - 1; i > 0; i--) {
+			const size_t j = nextRandom(order) % (i + 1);
+			for (int k = 0; k < 3; k++) {
+				std::swap(mesh.vertices[3 * i + k], mesh.vertices[3 * j + k]);
+				std::swap(mesh.uvs[3 * i + k], mesh.uvs[3 * j + k]);
+				std::swap(mesh.normals[3 * i + k], mesh.normals[3 * j + k]);
+				std::swap(mesh.tangents[3 * i + k], mesh.tangents[3 * j + k]);
+				std::swap(mesh.bitangents[3 * i + k], mesh.bitangents[3 * j + k]);
+			}
+		}
+	}
+	return mesh;
+}
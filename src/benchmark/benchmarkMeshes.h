@@ -0,0 +1,64 @@
+#ifndef BENCHMARK_MESHES_H
+#define BENCHMARK_MESHES_H
+
+#include <vector>
+#include <chrono>
+#include <stdint.h>
+#include <glm/glm.hpp>
+
+/*
+* meshes shared by the benchmarks of the mesh functions (vboIndexer, vertexCache, tangentBasis)
+*/
+
+/*
+* triangle corners of a mesh (every triangle has it's own corners, like the output of loadOBJ)
+*/
+struct Mesh {
+	std::vector<glm::vec3> vertices, normals, tangents, bitangents;
+	std::vector<glm::vec2> uvs;
+};
+
+/*
+* indexed mesh
+*/
+struct IndexedMesh {
+	std::vector<unsigned int> indices;
+	Mesh mesh;
+};
+
+/*
+* advance a linear congruential generator (the random numbers of the meshes are the same on every platform)
+* @param state state of the generator
+* @return 32 random bits
+*/
+inline uint32_t nextRandom(uint32_t& state) {
+	state = state * 1664525u + 1013904223u;
+	return state;
+}
+
+//flags of createGrid: the triangles in random order (like exported meshes often are),
+//mirrored uvs in every other row of quads (triangles of both handednesses)
+constexpr int GRID_SHUFFLED = 1;
+constexpr int GRID_MIRRORED_UVS = 2;
+
+/*
+* create the triangles of a wavy grid (10x10 units, the uvs cover [0, 1]), the tangents and bitangents are random
+* @param quads quads per side
+* @param jitter maximum distance of a corner to it's grid point
+* @param flags combination of the GRID_ flags
+* @return the mesh
+*/
+Mesh createGrid(const int quads, const float jitter = 0, const int flags = 0);
+
+/*
+* measure the duration of a call
+* @param function the function to call
+* @return milliseconds of the call
+*/
+template<class F> double measureMilliseconds(F function) {
+	auto tStart = std::chrono::high_resolution_clock::now();
+	function();
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - tStart).count() / 1000.0;
+}
+
+#endif
@@ -0,0 +1,69 @@
+#include <playground/brickGenerator.h>
+#include <stdio.h>
+
+using namespace gameUtils;
+
+/*
+* checks the lookahead of the brick generator at it's boundaries:
+* peeking at MAX_LOOKAHEAD - 1 works, peeking outside of the lookahead returns -1 and doesn't change the sequence of bricks
+*/
+
+//number of bricks compared per mode
+constexpr int sequenceLength = 4 * BrickGenerator::MAX_LOOKAHEAD;
+
+static int failures = 0;
+
+/*
+* count a failed check
+* @param condition result of the check
+* @param description printed if the check failed
+*/
+static void check(const bool condition, const char* description) {
+	if (condition) return;
+	printf("FAILED: %s\n", description);
+	failures++;
+}
+
+/*
+* run the checks for one mode of the generator
+* @param mode MODE_UNIFORM or MODE_BAG
+*/
+static void checkMode(const int mode) {
+	//the reference generator is never peeked, so it returns the plain sequence
+	BrickGenerator reference(42, mode);
+	BrickGenerator generator(42, mode);
+	int expected[sequenceLength];
+	for (int i = 0; i < sequenceLength; i++) {
+		expected[i] = reference.next();
+	}
+
+	const int last = generator.peek(BrickGenerator::MAX_LOOKAHEAD - 1);
+	check(last == expected[BrickGenerator::MAX_LOOKAHEAD - 1], "peek(MAX_LOOKAHEAD - 1) returns the brick at that position");
+	check(generator.peek(BrickGenerator::MAX_LOOKAHEAD) == -1, "peek(MAX_LOOKAHEAD) returns -1");
+	check(generator.peek(-1) == -1, "peek(-1) returns -1");
+	check(generator.peek(BrickGenerator::MAX_LOOKAHEAD - 1) == last, "peek outside of the lookahead doesn't change the queue");
+
+	int bricks[BrickGenerator::MAX_LOOKAHEAD + 4];
+	generator.peek(bricks, BrickGenerator::MAX_LOOKAHEAD + 4);
+	for (int i = 0; i < BrickGenerator::MAX_LOOKAHEAD + 4; i++) {
+		const int brick = i < BrickGenerator::MAX_LOOKAHEAD ? expected[i] : -1;
+		check(bricks[i] == brick, "peek(bricks, count) fills the lookahead and sets the rest to -1");
+	}
+
+	//the sequence continues after the queue is drained and refilled
+	for (int i = 0; i < sequenceLength; i++) {
+		if (i % 3 == 0) generator.peek(BrickGenerator::MAX_LOOKAHEAD);
+		check(generator.next() == expected[i], "next() returns the same sequence as an unpeeked generator");
+	}
+}
+
+int main() {
+	checkMode(BrickGenerator::MODE_UNIFORM);
+	checkMode(BrickGenerator::MODE_BAG);
+	if (failures > 0) {
+		printf("%d checks failed\n", failures);
+		return 1;
+	}
+	printf("all checks passed\n");
+	return 0;
+}
@@ -0,0 +1,115 @@
+#include <playground/gameData.h>
+#include <playground/gameUtils.h>
+#include <playground/brickGenerator.h>
+#include <chrono>
+#include <algorithm>
+#include <memory>
+#include <stdio.h>
+
+using namespace gameData;
+using namespace gameUtils;
+using namespace std::chrono;
+
+/*
+* benchmark of the field with dimensions set at runtime (Field, BrickDroppingField)
+* against the field with the game's dimensions as template parameters (GameField, GameBrickDroppingField)
+* both run the same seeded games: random movements and rotations, dropping, placing and collapsing filled rows
+*/
+
+//number of bricks per run and number of full-field reads per run
+constexpr int brickCountPerRun = 200000;
+constexpr int readCountPerRun = 200000;
+
+/*
+* play random games on a field
+* @param field the field (cleared at the start and whenever a game is over)
+* @param checksum int, a value depending on every placed brick will be added to (prevents the work from being optimized away)
+* @return nanoseconds per brick
+*/
+template<class F> static double runGames(std::shared_ptr<F> field, long long* checksum) {
+	BasicBrickDroppingField<F> brickDroppingField(field);
+	BrickGenerator generator;
+	generator.seed(1);
+	uint32_t random = 12345;
+	field->clear();
+
+	auto tStart = high_resolution_clock::now();
+	for (int i = 0; i < brickCountPerRun; i++) {
+		brickDroppingField.startBrick(generator.next());
+		//some random movements and rotations at the top of the field
+		for (int move = 0; move < 4; move++) {
+			random ^= random << 13;
+			random ^= random >> 17;
+			random ^= random << 5;
+			int direction = random % 4 + 1;
+			if (direction == BrickDroppingField::TYPE_ROTATE_LEFT || direction == BrickDroppingField::TYPE_ROTATE_RIGHT) {
+				int flag = brickDroppingField.canRotateBrick(direction);
+				if (flag) brickDroppingField.rotateBrick(direction, flag);
+			}
+			else if (brickDroppingField.canMoveBrick(direction)) brickDroppingField.moveBrick(direction);
+		}
+		while (brickDroppingField.canMoveBrick(BrickDroppingField::TYPE_MOVE_DOWN)) {
+			brickDroppingField.moveBrick(BrickDroppingField::TYPE_MOVE_DOWN);
+		}
+		if (!brickDroppingField.placeBrick()) {
+			field->clear();
+			continue;
+		}
+		//collapsing filled rows like GameInstance
+		int target = 0;
+		for (int y = 0; y < field->getHeight(); y++) {
+			if (field->isRowFull(y)) continue;
+			if (target != y) field->copyRow(y, target);
+			target++;
+		}
+		for (int y = target; y < field->getHeight(); y++) {
+			field->clearRow(y);
+		}
+		*checksum += target;
+	}
+	return duration_cast<nanoseconds>(high_resolution_clock::now() - tStart).count() / (double)brickCountPerRun;
+}
+
+/*
+* read every field of a field repeatedly
+* @param field the field
+* @param checksum int, the sum of every read value will be added to
+* @return nanoseconds per full-field read
+*/
+template<class F> static double runReads(std::shared_ptr<F> field, long long* checksum) {
+	long long sum = 0;
+	auto tStart = high_resolution_clock::now();
+	for (int i = 0; i < readCountPerRun; i++) {
+		for (int y = 0; y < field->getHeight(); y++) {
+			for (int x = 0; x < field->getWidth(); x++) {
+				sum += field->get(x, y);
+			}
+		}
+		//changing a field, so the reads can't be hoisted out of the loop
+		field->set(i % fieldX, 0, i % brickCount);
+	}
+	*checksum += sum;
+	return duration_cast<nanoseconds>(high_resolution_clock::now() - tStart).count() / (double)readCountPerRun;
+}
+
+int main(void) {
+	long long checksumDynamic = 0, checksumFixed = 0;
+	auto dynamicField = std::make_shared<Field>(fieldX, fieldY);
+	auto fixedField = std::make_shared<GameField>();
+
+	//warm-up and measurement (the fastest of 3 runs is reported)
+	double gamesDynamic = 1e9, gamesFixed = 1e9, readsDynamic = 1e9, readsFixed = 1e9;
+	for (int run = 0; run < 3; run++) {
+		gamesDynamic = std::min(gamesDynamic, runGames(dynamicField, &checksumDynamic));
+		gamesFixed = std::min(gamesFixed, runGames(fixedField, &checksumFixed));
+		readsDynamic = std::min(readsDynamic, runReads(dynamicField, &checksumDynamic));
+		readsFixed = std::min(readsFixed, runReads(fixedField, &checksumFixed));
+	}
+
+	printf("%dx%d field                 Field<runtime>   Field<%d, %d>\n", fieldX, fieldY, fieldX, fieldY);
+	printf("brick (move, drop, collapse) %10.1f ns   %10.1f ns\n", gamesDynamic, gamesFixed);
+	printf("full-field read              %10.1f ns   %10.1f ns\n", readsDynamic, readsFixed);
+	printf("size of the field object     %10d B    %10d B\n", (int)(sizeof(Field) + dynamicField->getStride() * fieldY), (int)sizeof(GameField));
+	//both fields played the same games
+	return checksumDynamic == checksumFixed ? 0 : 1;
+}
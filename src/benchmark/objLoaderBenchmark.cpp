@@ -0,0 +1,193 @@
+#include <vector>
+#include <glm/glm.hpp>
+#include <common/objloader.hpp>
+#include <chrono>
+#include <algorithm>
+#include <string>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+using namespace std::chrono;
+
+/*
+* benchmark of the OBJ loader (see common/objloader.cpp)
+* the previous implementation read every token with fscanf, loadOBJ maps the file and parses chunks of it in parallel,
+* the binary cache is mapped and copied without parsing
+* the mesh is a generated sphere with positions, uvs and normals (written like common exporters, 6 decimals)
+*/
+
+//rings and segments of the sphere (about 75 MB of OBJ)
+constexpr int rings = 600;
+constexpr int segments = 600;
+//paths of the generated files (in the working directory, removed at the end)
+static const char* objPath = "objLoaderBenchmark.obj";
+static const char* cachePath = "objLoaderBenchmark.objc";
+
+/*
+* the loader before the parallel one (only v/vt/vn triangles)
+* @param path path of the OBJ file
+* @param out_vertices, out_uvs, out_normals vectors, the attributes of every triangle corner will be appended to
+* @return whether the file could be read or not
+*/
+static bool loadOBJPrevious(const char* path, std::vector<glm::vec3>& out_vertices, std::vector<glm::vec2>& out_uvs, std::vector<glm::vec3>& out_normals) {
+	std::vector<unsigned int> vertexIndices, uvIndices, normalIndices;
+	std::vector<glm::vec3> temp_vertices;
+	std::vector<glm::vec2> temp_uvs;
+	std::vector<glm::vec3> temp_normals;
+	FILE* file = fopen(path, "r");
+	if (file == NULL) return false;
+	while (1) {
+		char lineHeader[128];
+		if (fscanf(file, "%s", lineHeader) == EOF) break;
+		if (strcmp(lineHeader, "v") == 0) {
+			glm::vec3 vertex;
+			fscanf(file, "%f %f %f\n", &vertex.x, &vertex.y, &vertex.z);
+			temp_vertices.push_back(vertex);
+		}
+		else if (strcmp(lineHeader, "vt") == 0) {
+			glm::vec2 uv;
+			fscanf(file, "%f %f\n", &uv.x, &uv.y);
+			uv.y = -uv.y;
+			temp_uvs.push_back(uv);
+		}
+		else if (strcmp(lineHeader, "vn") == 0) {
+			glm::vec3 normal;
+			fscanf(file, "%f %f %f\n", &normal.x, &normal.y, &normal.z);
+			temp_normals.push_back(normal);
+		}
+		else if (strcmp(lineHeader, "f") == 0) {
+			unsigned int v[3], t[3], n[3];
+			if (fscanf(file, "%d/%d/%d %d/%d/%d %d/%d/%d\n", &v[0], &t[0], &n[0], &v[1], &t[1], &n[1], &v[2], &t[2], &n[2]) != 9) {
+				fclose(file);
+				return false;
+			}
+			for (int i = 0; i < 3; i++) {
+				vertexIndices.push_back(v[i]);
+				uvIndices.push_back(t[i]);
+				normalIndices.push_back(n[i]);
+			}
+		}
+		else {
+			char buffer[1000];
+			fgets(buffer, 1000, file);
+		}
+	}
+	for (unsigned int i = 0; i < vertexIndices.size(); i++) {
+		out_vertices.push_back(temp_vertices[vertexIndices[i] - 1]);
+		out_uvs.push_back(temp_uvs[uvIndices[i] - 1]);
+		out_normals.push_back(temp_normals[normalIndices[i] - 1]);
+	}
+	fclose(file);
+	return true;
+}
+
+/*
+* write the sphere into the OBJ file
+* @return size of the file in bytes (0 if it couldn't be written)
+*/
+static long writeSphere() {
+	FILE* file = fopen(objPath, "w");
+	if (file == NULL) return 0;
+	fprintf(file, "# generated by objLoaderBenchmark\no sphere\n");
+	for (int r = 0; r <= rings; r++) {
+		for (int s = 0; s <= segments; s++) {
+			const float theta = 3.14159265f * r / rings, phi = 6.2831853f * s / segments;
+			const float x = sinf(theta) * cosf(phi), y = cosf(theta), z = sinf(theta) * sinf(phi);
+			fprintf(file, "v %.6f %.6f %.6f\nvt %.6f %.6f\nvn %.6f %.6f %.6f\n", x * 2, y * 2, z * 2, (float)s / segments, (float)r / rings, x, y, z);
+		}
+	}
+	fprintf(file, "s 1\n");
+	for (int r = 0; r < rings; r++) {
+		for (int s = 0; s < segments; s++) {
+			const int a = r * (segments + 1) + s + 1, b = a + segments + 1;
+			fprintf(file, "f %d/%d/%d %d/%d/%d %d/%d/%d\n", a, a, a, b, b, b, a + 1, a + 1, a + 1);
+			fprintf(file, "f %d/%d/%d %d/%d/%d %d/%d/%d\n", a + 1, a + 1, a + 1, b, b, b, b + 1, b + 1, b + 1);
+		}
+	}
+	const long size = ftell(file);
+	return fclose(file) == 0 ? size : 0;
+}
+
+/*
+* loaded triangle corners of an implementation
+*/
+struct Mesh {
+	std::vector<glm::vec3> vertices;
+	std::vector<glm::vec2> uvs;
+	std::vector<glm::vec3> normals;
+};
+
+/*
+* load the file with an implementation
+* @param implementation 0: previous loader, 1: parallel loader, 2: cache
+* @param mesh the loaded triangles will be applied to
+* @return milliseconds of the load
+*/
+static double load(const int implementation, Mesh* mesh) {
+	*mesh = Mesh();
+	auto tStart = high_resolution_clock::now();
+	bool loaded = false;
+	switch (implementation) {
+	case 0:
+		loaded = loadOBJPrevious(objPath, mesh->vertices, mesh->uvs, mesh->normals);
+		break;
+	case 1:
+		loaded = loadOBJ(objPath, mesh->vertices, mesh->uvs, mesh->normals);
+		break;
+	default:
+		loaded = loadOBJCache(cachePath, mesh->vertices, mesh->uvs, mesh->normals);
+		break;
+	}
+	const double milliseconds = duration_cast<microseconds>(high_resolution_clock::now() - tStart).count() / 1000.0;
+	return loaded ? milliseconds : -1;
+}
+
+/*
+* largest difference between the attributes of two meshes
+* @return the difference (infinite if the number of corners differs)
+*/
+static float getMaxDifference(const Mesh& a, const Mesh& b) {
+	if (a.vertices.size() != b.vertices.size() || a.uvs.size() != b.uvs.size() || a.normals.size() != b.normals.size()) return INFINITY;
+	float maxDifference = 0;
+	for (size_t i = 0; i < a.vertices.size(); i++) {
+		for (int j = 0; j < 3; j++) maxDifference = std::max(maxDifference, fabsf(a.vertices[i][j] - b.vertices[i][j]));
+		for (int j = 0; j < 2; j++) maxDifference = std::max(maxDifference, fabsf(a.uvs[i][j] - b.uvs[i][j]));
+		for (int j = 0; j < 3; j++) maxDifference = std::max(maxDifference, fabsf(a.normals[i][j] - b.normals[i][j]));
+	}
+	return maxDifference;
+}
+
+int main() {
+	const long size = writeSphere();
+	if (size == 0) {
+		fprintf(stderr, "Can't write %s\n", objPath);
+		return 1;
+	}
+	Mesh meshes[3];
+	if (load(1, &meshes[1]) < 0 || !writeOBJCache(cachePath, objPath, meshes[1].vertices, meshes[1].uvs, meshes[1].normals)) {
+		fprintf(stderr, "Can't write %s\n", cachePath);
+		return 1;
+	}
+
+	//fastest of 3 runs (the files are in the page cache after the first run)
+	const char* names[3] = { "previous", "parallel", "cache" };
+	double milliseconds[3] = { 1e18, 1e18, 1e18 };
+	for (int run = 0; run < 3; run++) {
+		for (int i = 0; i < 3; i++) {
+			milliseconds[i] = std::min(milliseconds[i], load(i, &meshes[i]));
+		}
+	}
+
+	//every implementation needs to load the same triangles (up to rounding of the float parser)
+	const float maxDifference = std::max(getMaxDifference(meshes[0], meshes[1]), getMaxDifference(meshes[0], meshes[2]));
+
+	printf("%.1f MB of OBJ, %zu triangles (fastest of 3 runs)\n", size / 1e6, meshes[0].vertices.size() / 3);
+	for (int i = 0; i < 3; i++) {
+		printf("%-9s %8.1f ms %8.1f MB/s (%.1fx)\n", names[i], milliseconds[i], size / 1e3 / milliseconds[i], milliseconds[0] / milliseconds[i]);
+	}
+	printf("max difference: %g\n", maxDifference);
+	remove(objPath);
+	remove(cachePath);
+	return maxDifference < 1e-6f ? 0 : 1;
+}
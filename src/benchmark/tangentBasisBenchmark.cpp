@@ -0,0 +1,111 @@
+#include <vector>
+#include <glm/glm.hpp>
+#include <common/tangentspace.hpp>
+#include "benchmarkMeshes.h"
+#include <algorithm>
+#include <thread>
+#include <math.h>
+#include <stdio.h>
+
+/*
+* benchmark of the tangent basis (see common/tangentspace.cpp)
+* the previous implementation computed one triangle at a time and appended the tangents to the output vectors,
+* computeTangentBasis processes four triangles at once with SSE into preallocated outputs and splits large meshes across threads
+* the mesh is a grid (see benchmarkMeshes.h) with mirrored uvs in every other row of quads
+*/
+
+//quads per side of the grid
+constexpr int quads = 500;
+
+/*
+* tangent basis of a mesh
+*/
+struct TangentBasis {
+	std::vector<glm::vec3> tangents, bitangents;
+};
+
+/*
+* the previous computeTangentBasis
+*/
+static void computeTangentBasisPrevious(Mesh& mesh, TangentBasis& basis) {
+	for (size_t i = 0; i < mesh.vertices.size(); i += 3) {
+		glm::vec3 deltaPos1 = mesh.vertices[i + 1] - mesh.vertices[i];
+		glm::vec3 deltaPos2 = mesh.vertices[i + 2] - mesh.vertices[i];
+		glm::vec2 deltaUV1 = mesh.uvs[i + 1] - mesh.uvs[i];
+		glm::vec2 deltaUV2 = mesh.uvs[i + 2] - mesh.uvs[i];
+		float r = 1.0f / (deltaUV1.x * deltaUV2.y - deltaUV1.y * deltaUV2.x);
+		glm::vec3 tangent = (deltaPos1 * deltaUV2.y - deltaPos2 * deltaUV1.y) * r;
+		glm::vec3 bitangent = (deltaPos2 * deltaUV1.x - deltaPos1 * deltaUV2.x) * r;
+		for (int j = 0; j < 3; j++) {
+			basis.tangents.push_back(tangent);
+			basis.bitangents.push_back(bitangent);
+		}
+	}
+	for (size_t i = 0; i < mesh.vertices.size(); i++) {
+		glm::vec3& n = mesh.normals[i];
+		glm::vec3& t = basis.tangents[i];
+		glm::vec3& b = basis.bitangents[i];
+		t = glm::normalize(t - n * glm::dot(n, t));
+		if (glm::dot(glm::cross(n, t), b) < 0.0f) {
+			t = t * -1.0f;
+		}
+	}
+}
+
+/*
+* compute the tangent basis with an implementation
+* @param implementation 0: previous implementation, 1: computeTangentBasis with vectors, 2: computeTangentBasis into preallocated outputs
+* @return milliseconds of the computation
+*/
+static double compute(const int implementation, Mesh& mesh, TangentBasis& basis) {
+	if (implementation < 2) {
+		basis = TangentBasis();
+	}
+	else {
+		basis.tangents.resize(mesh.vertices.size());
+		basis.bitangents.resize(mesh.vertices.size());
+	}
+	return measureMilliseconds([&]() {
+		switch (implementation) {
+		case 0:
+			computeTangentBasisPrevious(mesh, basis);
+			break;
+		case 1:
+			computeTangentBasis(mesh.vertices, mesh.uvs, mesh.normals, basis.tangents, basis.bitangents);
+			break;
+		default:
+			computeTangentBasis(&mesh.vertices[0], &mesh.uvs[0], &mesh.normals[0], mesh.vertices.size(), &basis.tangents[0], &basis.bitangents[0]);
+			break;
+		}
+	});
+}
+
+int main() {
+	Mesh mesh = createGrid(quads, 0, GRID_MIRRORED_UVS);
+	TangentBasis bases[3];
+	double milliseconds[3] = { 1e18, 1e18, 1e18 };
+	//fastest of 5 runs
+	for (int run = 0; run < 5; run++) {
+		for (int i = 0; i < 3; i++) {
+			milliseconds[i] = std::min(milliseconds[i], compute(i, mesh, bases[i]));
+		}
+	}
+
+	//every implementation needs to calculate the same tangents
+	float maxDifference = 0;
+	for (int j = 1; j < 3; j++) {
+		for (size_t i = 0; i < mesh.vertices.size(); i++) {
+			for (int k = 0; k < 3; k++) {
+				maxDifference = std::max(maxDifference, fabsf(bases[0].tangents[i][k] - bases[j].tangents[i][k]));
+				maxDifference = std::max(maxDifference, fabsf(bases[0].bitangents[i][k] - bases[j].bitangents[i][k]));
+			}
+		}
+	}
+
+	printf("%zu triangles, %u hardware threads (fastest of 5 runs)\n", mesh.vertices.size() / 3, std::thread::hardware_concurrency());
+	printf("previous:     %8.2f ms\n", milliseconds[0]);
+	printf("vectors:      %8.2f ms (%.2fx)\n", milliseconds[1], milliseconds[0] / milliseconds[1]);
+	printf("preallocated: %8.2f ms (%.2fx)\n", milliseconds[2], milliseconds[0] / milliseconds[2]);
+	printf("max difference: %g\n", maxDifference);
+	return maxDifference < 1e-6f ? 0 : 1;
+}
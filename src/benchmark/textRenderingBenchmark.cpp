@@ -0,0 +1,306 @@
+#include <GL/glew.h>
+#include <glfw3.h>
+#include <glm/glm.hpp>
+#include <common/text2D.hpp>
+#include <algorithm>
+#include <chrono>
+#include <new>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace std::chrono;
+
+/*
+* benchmark of drawing a HUD with text2D (see common/text2D.cpp)
+*  - previous: the printText2D before the retained texts (allocates the vertices of every text every frame)
+*  - print:    printText2D for every text every frame (tessellates and uploads every text, one draw call per text)
+*  - retained: the texts are created once, the changed text is set every frame and every text is drawn with one call
+*  - mixed:    half of the texts are retained, the other half is printed after drawTexts2D in the same frame
+* one text (a frame counter) changes every frame, the last frames are compared pixel by pixel
+* the font texture and the shaders of text2D are generated into the working directory and removed at the end
+*/
+
+//number of texts and frames
+constexpr int textCount = 32;
+constexpr int frameCount = 500;
+//size of the framebuffer (the screen space of the text shader)
+constexpr int width = 800;
+constexpr int height = 600;
+
+//heap allocations with operator new (counted to check the frames of the retained texts don't allocate)
+static uint64_t allocations = 0;
+
+void* operator new(size_t size) {
+	allocations++;
+	void* pointer = malloc(size > 0 ? size : 1);
+	if (pointer == nullptr) throw std::bad_alloc();
+	return pointer;
+}
+void operator delete(void* pointer) noexcept {
+	free(pointer);
+}
+void operator delete(void* pointer, size_t) noexcept {
+	free(pointer);
+}
+
+//the shaders of text2D: positions in pixels of an 800x600 screen, the font's alpha is blended
+static const char* vertexShader =
+	"#version 330 core\n"
+	"layout(location = 0) in vec2 vertexPosition_screenspace;\n"
+	"layout(location = 1) in vec2 vertexUV;\n"
+	"out vec2 UV;\n"
+	"void main(){\n"
+	"	vec2 vertexPosition_homoneneousspace = vertexPosition_screenspace - vec2(400,300);\n"
+	"	vertexPosition_homoneneousspace /= vec2(400,300);\n"
+	"	gl_Position = vec4(vertexPosition_homoneneousspace,0,1);\n"
+	"	UV = vertexUV;\n"
+	"}\n";
+static const char* fragmentShader =
+	"#version 330 core\n"
+	"in vec2 UV;\n"
+	"out vec4 color;\n"
+	"uniform sampler2D myTextureSampler;\n"
+	"void main(){\n"
+	"	color = texture( myTextureSampler, UV );\n"
+	"}\n";
+static const char* fontPath = "textRenderingBenchmark.dds";
+
+//objects of text2D (see initText2D)
+extern unsigned int Text2DTextureID;
+extern unsigned int Text2DVertexBufferID;
+extern unsigned int Text2DUVBufferID;
+extern unsigned int Text2DShaderID;
+extern unsigned int Text2DUniformID;
+
+/*
+* the printText2D before the retained texts
+* @param text the text
+* @param x, y position of the lower left corner in pixels
+* @param size size of a character in pixels
+*/
+static void printText2DPrevious(const char* text, int x, int y, int size) {
+	unsigned int length = strlen(text);
+	std::vector<glm::vec2> vertices;
+	std::vector<glm::vec2> UVs;
+	for (unsigned int i = 0; i < length; i++) {
+		glm::vec2 vertex_up_left = glm::vec2(x + i * size, y + size);
+		glm::vec2 vertex_up_right = glm::vec2(x + i * size + size, y + size);
+		glm::vec2 vertex_down_right = glm::vec2(x + i * size + size, y);
+		glm::vec2 vertex_down_left = glm::vec2(x + i * size, y);
+		vertices.push_back(vertex_up_left);
+		vertices.push_back(vertex_down_left);
+		vertices.push_back(vertex_up_right);
+		vertices.push_back(vertex_down_right);
+		vertices.push_back(vertex_up_right);
+		vertices.push_back(vertex_down_left);
+		char character = text[i];
+		float uv_x = (character % 16) / 16.0f;
+		float uv_y = (character / 16) / 16.0f;
+		glm::vec2 uv_up_left = glm::vec2(uv_x, uv_y);
+		glm::vec2 uv_up_right = glm::vec2(uv_x + 1.0f / 16.0f, uv_y);
+		glm::vec2 uv_down_right = glm::vec2(uv_x + 1.0f / 16.0f, (uv_y + 1.0f / 16.0f));
+		glm::vec2 uv_down_left = glm::vec2(uv_x, (uv_y + 1.0f / 16.0f));
+		UVs.push_back(uv_up_left);
+		UVs.push_back(uv_down_left);
+		UVs.push_back(uv_up_right);
+		UVs.push_back(uv_down_right);
+		UVs.push_back(uv_up_right);
+		UVs.push_back(uv_down_left);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, Text2DVertexBufferID);
+	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(glm::vec2), &vertices[0], GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, Text2DUVBufferID);
+	glBufferData(GL_ARRAY_BUFFER, UVs.size() * sizeof(glm::vec2), &UVs[0], GL_STATIC_DRAW);
+	glUseProgram(Text2DShaderID);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, Text2DTextureID);
+	glUniform1i(Text2DUniformID, 0);
+	glEnableVertexAttribArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, Text2DVertexBufferID);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, (void*)0);
+	glEnableVertexAttribArray(1);
+	glBindBuffer(GL_ARRAY_BUFFER, Text2DUVBufferID);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, (void*)0);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glDrawArrays(GL_TRIANGLES, 0, vertices.size());
+	glDisable(GL_BLEND);
+	glDisableVertexAttribArray(0);
+	glDisableVertexAttribArray(1);
+}
+
+/*
+* write a file of the working directory
+* @return whether the file was written
+*/
+static bool writeFile(const char* path, const void* data, const size_t size) {
+	FILE* file = fopen(path, "wb");
+	if (file == NULL) return false;
+	const bool complete = fwrite(data, 1, size, file) == size;
+	return fclose(file) == 0 && complete;
+}
+
+/*
+* write a 256x256 DXT5 font texture with every mipmap level (random blocks)
+* @return whether the file was written
+*/
+static bool writeFont() {
+	uint32_t levels = 0;
+	size_t dataSize = 0;
+	for (unsigned int s = 256; s > 0; s /= 2, levels++) dataSize += (size_t)((s + 3) / 4) * ((s + 3) / 4) * 16;
+	std::vector<unsigned char> file(128 + dataSize, 0);
+	memcpy(&file[0], "DDS ", 4);
+	const uint32_t size = 256, fourCC = 0x35545844;
+	memcpy(&file[4 + 8], &size, 4);
+	memcpy(&file[4 + 12], &size, 4);
+	memcpy(&file[4 + 24], &levels, 4);
+	memcpy(&file[4 + 80], &fourCC, 4);
+	uint32_t random = 12345;
+	for (size_t i = 128; i < file.size(); i++) {
+		random ^= random << 13;
+		random ^= random >> 17;
+		random ^= random << 5;
+		file[i] = (unsigned char)random;
+	}
+	return writeFile(fontPath, file.data(), file.size());
+}
+
+/*
+* the text of the HUD
+* @param index index of the text
+* @param frame frame number (changes the text 0)
+* @param text buffer of at least 64 characters
+*/
+static void getText(const int index, const int frame, char* text) {
+	if (index == 0) snprintf(text, 64, "frame %d", frame);
+	else snprintf(text, 64, "HUD line %02d: score 123456 lines 42", index);
+}
+
+/*
+* draw the frames with a mode, the frame buffer holds the last frame
+* @param mode 0: previous, 1: print, 2: retained, 3: mixed
+* @param milliseconds CPU time of the text calls of a frame (average)
+* @return heap allocations of the frames after the first one
+*/
+static uint64_t drawFrames(const int mode, double* milliseconds) {
+	//texts drawn by drawTexts2D (every text of 'retained', every second one of 'mixed' including the changing text 0)
+	auto isRetained = [mode](const int index) { return mode == 2 || (mode == 3 && index % 2 == 0); };
+	char text[64];
+	std::vector<int> ids(textCount, -1);
+	for (int i = 0; i < textCount; i++) {
+		if (!isRetained(i)) continue;
+		getText(i, 0, text);
+		ids[i] = createText2D(text, 10, height - 20 - 18 * i, 16);
+	}
+	uint64_t allocated = 0;
+	double total = 0;
+	for (int frame = 0; frame < frameCount; frame++) {
+		glClear(GL_COLOR_BUFFER_BIT);
+		const uint64_t allocationsBefore = allocations;
+		const auto start = high_resolution_clock::now();
+		if (isRetained(0)) {
+			getText(0, frame, text);
+			setText2D(ids[0], text, 10, height - 20, 16);
+			drawTexts2D();
+		}
+		//the printed texts of 'mixed' are drawn after drawTexts2D with the vertex array that was bound before
+		for (int i = 0; i < textCount; i++) {
+			if (isRetained(i)) continue;
+			getText(i, frame, text);
+			if (mode == 0) printText2DPrevious(text, 10, height - 20 - 18 * i, 16);
+			else printText2D(text, 10, height - 20 - 18 * i, 16);
+		}
+		total += duration<double, std::milli>(high_resolution_clock::now() - start).count();
+		if (frame > 0) allocated += allocations - allocationsBefore;
+		glFinish();
+	}
+	for (int id : ids) deleteText2D(id);
+	*milliseconds = total / frameCount;
+	return allocated;
+}
+
+int main() {
+	//hidden window, only it's context is used
+	if (!glfwInit()) {
+		fprintf(stderr, "Failed to initialize GLFW\n");
+		return -1;
+	}
+	glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	GLFWwindow* window = glfwCreateWindow(64, 64, "textRenderingBenchmark", NULL, NULL);
+	if (window == NULL) {
+		fprintf(stderr, "Failed to open GLFW window\n");
+		glfwTerminate();
+		return -1;
+	}
+	glfwMakeContextCurrent(window);
+	glewExperimental = true;
+	if (glewInit() != GLEW_OK) {
+		fprintf(stderr, "Failed to initialize GLEW\n");
+		glfwTerminate();
+		return -1;
+	}
+
+	//initText2D loads it's shaders and the font from the working directory
+	if (!writeFont() || !writeFile("TextVertexShader.vertexshader", vertexShader, strlen(vertexShader))
+		|| !writeFile("TextVertexShader.fragmentshader", fragmentShader, strlen(fragmentShader))) {
+		fprintf(stderr, "Can't write the font and the shaders\n");
+		return -1;
+	}
+
+	//offscreen framebuffer of the screen size
+	GLuint frameBuffer, color;
+	glGenRenderbuffers(1, &color);
+	glBindRenderbuffer(GL_RENDERBUFFER, color);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+	glGenFramebuffers(1, &frameBuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, frameBuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+	glViewport(0, 0, width, height);
+	glClearColor(0.0f, 0.0f, 0.4f, 1.0f);
+	//printText2D uses the bound vertex array, it's bound once (initText2D and drawTexts2D keep it bound)
+	GLuint vertexArray;
+	glGenVertexArrays(1, &vertexArray);
+	glBindVertexArray(vertexArray);
+	initText2D(fontPath);
+	//glewInit leaves GL_INVALID_ENUM in core profiles, only the errors of the modes are checked
+	while (glGetError() != GL_NO_ERROR) {}
+
+	const char* names[4] = { "previous", "print", "retained", "mixed" };
+	double milliseconds[4];
+	uint64_t allocated[4];
+	std::vector<unsigned char> pixels[4];
+	for (int mode = 0; mode < 4; mode++) {
+		allocated[mode] = drawFrames(mode, &milliseconds[mode]);
+		pixels[mode].resize(width * height * 4);
+		glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels[mode].data());
+	}
+	const GLenum error = glGetError();
+	const bool equal = pixels[0] == pixels[1] && pixels[0] == pixels[2] && pixels[0] == pixels[3];
+	size_t drawn = 0;
+	for (size_t i = 0; i < pixels[0].size(); i += 4) drawn += pixels[0][i] != 0 || pixels[0][i + 1] != 0 || pixels[0][i + 2] != 102;
+
+	printf("%d texts, %d frames, one text changes every frame, %zu pixels drawn\n", textCount, frameCount, drawn);
+	for (int i = 0; i < 4; i++) {
+		printf("%-9s %7.3f ms per frame (%.1fx), %.2f heap allocations per frame\n", names[i], milliseconds[i], milliseconds[0] / milliseconds[i],
+			(double)allocated[i] / (frameCount - 1));
+	}
+	printf("last frames equal: %s, GL error: 0x%x\n", equal ? "yes" : "no", error);
+
+	glDeleteVertexArrays(1, &vertexArray);
+	glDeleteFramebuffers(1, &frameBuffer);
+	glDeleteRenderbuffers(1, &color);
+	cleanupText2D();
+	remove(fontPath);
+	remove("TextVertexShader.vertexshader");
+	remove("TextVertexShader.fragmentshader");
+	glfwTerminate();
+	return equal && error == GL_NO_ERROR ? 0 : 1;
+}
@@ -0,0 +1,214 @@
+#include <GL/glew.h>
+#include <glfw3.h>
+#include <common/texture.hpp>
+#include <common/texturestreamer.hpp>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace std::chrono;
+
+/*
+* benchmark of loading textures while rendering: time the main thread spends per frame
+*  - synchronous: loadBMP_custom and loadDDS (one texture per frame)
+*  - streamed:    TextureStreamer, the files are decoded by the workers and uploaded under a budget per frame
+* the textures are generated BMP (24bpp) and DDS (DXT1 with mipmaps) files, the level 0 of every BMP and every level of
+* every DDS are compared between the loaders
+* usage: textureStreamingBenchmark [size] [texture count] [upload budget in MB]
+*/
+
+//time of the rest of a frame, the workers run meanwhile
+constexpr int frameMilliseconds = 4;
+
+/*
+* write a 24bpp BMP file with a gradient and noise
+* @param path file name
+* @param size width and height
+*/
+static void writeBMP(const std::string& path, const unsigned int size, uint32_t random) {
+	const unsigned int rowSize = (size * 3 + 3) & ~3u;
+	std::vector<unsigned char> file(54 + (size_t)rowSize * size, 0);
+	unsigned char* header = &file[0];
+	header[0] = 'B';
+	header[1] = 'M';
+	const uint32_t values[][2] = { { 0x02, (uint32_t)file.size() }, { 0x0A, 54 }, { 0x0E, 40 }, { 0x12, size }, { 0x16, size },
+		{ 0x1A, 1 | (24 << 16) }, { 0x22, (uint32_t)(file.size() - 54) } };
+	for (const auto& value : values) memcpy(header + value[0], &value[1], 4);
+	for (unsigned int y = 0; y < size; y++) {
+		unsigned char* row = &file[54 + (size_t)y * rowSize];
+		for (unsigned int x = 0; x < size * 3; x++) {
+			random ^= random << 13;
+			random ^= random >> 17;
+			random ^= random << 5;
+			row[x] = (unsigned char)((x + y) / 8 + random % 16);
+		}
+	}
+	FILE* f = fopen(path.c_str(), "wb");
+	fwrite(file.data(), 1, file.size(), f);
+	fclose(f);
+}
+
+/*
+* write a DXT1 DDS file with every mipmap level (random blocks)
+* @param path file name
+* @param size width and height (power of two)
+*/
+static void writeDDS(const std::string& path, const unsigned int size, uint32_t random) {
+	unsigned int levels = 1;
+	size_t dataSize = 0;
+	for (unsigned int s = size; ; s /= 2, levels++) {
+		dataSize += (size_t)((s + 3) / 4) * ((s + 3) / 4) * 8;
+		if (s == 1) break;
+	}
+	std::vector<unsigned char> file(128 + dataSize, 0);
+	memcpy(&file[0], "DDS ", 4);
+	unsigned char* header = &file[4];
+	const uint32_t linearSize = (size / 4) * (size / 4) * 8, fourCC = 0x31545844;
+	memcpy(header + 8, &size, 4);
+	memcpy(header + 12, &size, 4);
+	memcpy(header + 16, &linearSize, 4);
+	memcpy(header + 24, &levels, 4);
+	memcpy(header + 80, &fourCC, 4);
+	for (size_t i = 128; i < file.size(); i++) {
+		random ^= random << 13;
+		random ^= random >> 17;
+		random ^= random << 5;
+		file[i] = (unsigned char)random;
+	}
+	FILE* f = fopen(path.c_str(), "wb");
+	fwrite(file.data(), 1, file.size(), f);
+	fclose(f);
+}
+
+/*
+* read every level of a texture
+* @param texture texture name
+* @param dds whether the texture is compressed (every level is read) or BGR (level 0 is read, the mipmaps of the loaders differ)
+* @return the bytes of the levels
+*/
+static std::vector<unsigned char> readTexture(const GLuint texture, const bool dds) {
+	std::vector<unsigned char> pixels;
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	for (int level = 0; ; level++) {
+		GLint width = 0, height = 0, size = 0;
+		glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_WIDTH, &width);
+		glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_HEIGHT, &height);
+		if (width == 0 || height == 0 || (!dds && level > 0)) break;
+		const size_t offset = pixels.size();
+		if (dds) {
+			glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &size);
+			pixels.resize(offset + size);
+			glGetCompressedTexImage(GL_TEXTURE_2D, level, &pixels[offset]);
+		}
+		else {
+			pixels.resize(offset + (size_t)width * height * 3);
+			glGetTexImage(GL_TEXTURE_2D, level, GL_BGR, GL_UNSIGNED_BYTE, &pixels[offset]);
+		}
+		if (width == 1 && height == 1) break;
+	}
+	return pixels;
+}
+
+int main(int argc, char* argv[]) {
+	const unsigned int size = argc > 1 ? atoi(argv[1]) : 2048;
+	const int textureCount = argc > 2 ? atoi(argv[2]) : 8;
+	const size_t uploadBudget = (size_t)(argc > 3 ? atof(argv[3]) : 8.0) * (1 << 20);
+
+	//hidden window, only it's context is used
+	if (!glfwInit()) {
+		fprintf(stderr, "Failed to initialize GLFW\n");
+		return -1;
+	}
+	glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	GLFWwindow* window = glfwCreateWindow(64, 64, "textureStreamingBenchmark", NULL, NULL);
+	if (window == NULL) {
+		fprintf(stderr, "Failed to open GLFW window\n");
+		glfwTerminate();
+		return -1;
+	}
+	glfwMakeContextCurrent(window);
+	glewExperimental = true;
+	if (glewInit() != GLEW_OK) {
+		fprintf(stderr, "Failed to initialize GLEW\n");
+		glfwTerminate();
+		return -1;
+	}
+
+	//even textures are BMP files, odd ones DDS files
+	std::vector<std::string> paths;
+	for (int i = 0; i < textureCount; i++) {
+		paths.push_back("textureStreamingBenchmark" + std::to_string(i) + (i % 2 == 0 ? ".bmp" : ".dds"));
+		if (i % 2 == 0) writeBMP(paths[i], size, 1234 + i);
+		else writeDDS(paths[i], size, 1234 + i);
+	}
+
+	//synchronous loading, one texture per frame
+	std::vector<GLuint> synchronous;
+	double synchronousMax = 0, synchronousTotal = 0;
+	for (int i = 0; i < textureCount; i++) {
+		const auto start = steady_clock::now();
+		synchronous.push_back(i % 2 == 0 ? loadBMP_custom(paths[i].c_str()) : loadDDS(paths[i].c_str()));
+		const double ms = duration<double, std::milli>(steady_clock::now() - start).count();
+		synchronousMax = std::max(synchronousMax, ms);
+		synchronousTotal += ms;
+		glFinish();
+		std::this_thread::sleep_for(milliseconds(frameMilliseconds));
+	}
+
+	//streamed loading, every texture is queued in the first frame
+	TextureStreamer streamer;
+	streamer.start();
+	std::vector<GLuint> streamed;
+	double streamedMax = 0, streamedTotal = 0;
+	int frames = 0;
+	const auto streamStart = steady_clock::now();
+	do {
+		const auto start = steady_clock::now();
+		if (frames == 0) {
+			for (int i = 0; i < textureCount; i++) streamed.push_back(i % 2 == 0 ? streamer.loadBMP(paths[i].c_str()) : streamer.loadDDS(paths[i].c_str()));
+		}
+		streamer.update(uploadBudget);
+		const double ms = duration<double, std::milli>(steady_clock::now() - start).count();
+		streamedMax = std::max(streamedMax, ms);
+		streamedTotal += ms;
+		frames++;
+		glFinish();
+		std::this_thread::sleep_for(milliseconds(frameMilliseconds));
+	} while (streamer.pending() > 0);
+	const double streamWall = duration<double, std::milli>(steady_clock::now() - streamStart).count();
+
+	//comparison of the textures
+	int different = 0;
+	for (int i = 0; i < textureCount; i++) {
+		if (readTexture(synchronous[i], i % 2 == 1) != readTexture(streamed[i], i % 2 == 1)) {
+			printf("texture %d differs\n", i);
+			different++;
+		}
+	}
+	const bool persistent = streamer.isPersistent();
+	streamer.stop();
+
+	printf("%d textures of %ux%u, %u hardware threads, staging buffer %s\n", textureCount, size, size,
+		std::thread::hardware_concurrency(), persistent ? "persistently mapped" : "unavailable (uploads from memory)");
+	printf("synchronous: main thread max %8.2f ms per frame, total %8.2f ms\n", synchronousMax, synchronousTotal);
+	printf("streamed:    main thread max %8.2f ms per frame, total %8.2f ms (%d frames, %.2f ms until every texture was uploaded)\n",
+		streamedMax, streamedTotal, frames, streamWall);
+	printf("different textures: %d\n", different);
+
+	glDeleteTextures((GLsizei)synchronous.size(), synchronous.data());
+	glDeleteTextures((GLsizei)streamed.size(), streamed.data());
+	for (const std::string& path : paths) remove(path.c_str());
+	glfwTerminate();
+	return different == 0 ? 0 : 1;
+}
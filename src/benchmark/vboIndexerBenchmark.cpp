@@ -0,0 +1,151 @@
+#include <vector>
+#include <map>
+#include <glm/glm.hpp>
+#include <common/vboindexer.hpp>
+#include "benchmarkMeshes.h"
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+
+bool is_near(float v1, float v2);
+
+/*
+* benchmark of the vertex indexer (see common/vboindexer.cpp)
+* the previous implementation merged identical vertices with a std::map (indexVBO)
+* and similar vertices with a linear search of every merged vertex (indexVBO_TBN, quadratic time),
+* both are hashed now and the indices can be 32 bit
+* the meshes are grids of createGrid (see benchmarkMeshes.h), the corners of the similar meshes are moved by less than the epsilon of is_near
+*/
+
+//quads per side of the grid of the identical vertices, of the similar vertices and of the linear search (quadratic, so smaller)
+constexpr int identicalQuads = 500;
+constexpr int similarQuads = 500;
+constexpr int linearQuads = 100;
+
+struct PackedVertex {
+	glm::vec3 position;
+	glm::vec2 uv;
+	glm::vec3 normal;
+	bool operator<(const PackedVertex that) const {
+		return memcmp((void*)this, (void*)&that, sizeof(PackedVertex)) > 0;
+	};
+};
+
+/*
+* the previous indexVBO (std::map of the identical vertices)
+*/
+static void indexVBOPrevious(Mesh& in, IndexedMesh& out) {
+	std::map<PackedVertex, unsigned int> vertexToOutIndex;
+	for (size_t i = 0; i < in.vertices.size(); i++) {
+		PackedVertex packed = { in.vertices[i], in.uvs[i], in.normals[i] };
+		auto it = vertexToOutIndex.find(packed);
+		if (it != vertexToOutIndex.end()) {
+			out.indices.push_back(it->second);
+		}
+		else {
+			out.mesh.vertices.push_back(in.vertices[i]);
+			out.mesh.uvs.push_back(in.uvs[i]);
+			out.mesh.normals.push_back(in.normals[i]);
+			out.indices.push_back((unsigned int)out.mesh.vertices.size() - 1);
+			vertexToOutIndex[packed] = (unsigned int)out.mesh.vertices.size() - 1;
+		}
+	}
+}
+
+/*
+* the previous indexVBO_TBN (linear search of the similar vertices)
+*/
+static void indexVBO_TBNPrevious(Mesh& in, IndexedMesh& out) {
+	for (size_t i = 0; i < in.vertices.size(); i++) {
+		bool found = false;
+		for (size_t j = 0; j < out.mesh.vertices.size() && !found; j++) {
+			if (is_near(in.vertices[i].x, out.mesh.vertices[j].x) && is_near(in.vertices[i].y, out.mesh.vertices[j].y) && is_near(in.vertices[i].z, out.mesh.vertices[j].z)
+				&& is_near(in.uvs[i].x, out.mesh.uvs[j].x) && is_near(in.uvs[i].y, out.mesh.uvs[j].y)
+				&& is_near(in.normals[i].x, out.mesh.normals[j].x) && is_near(in.normals[i].y, out.mesh.normals[j].y) && is_near(in.normals[i].z, out.mesh.normals[j].z)) {
+				out.indices.push_back((unsigned int)j);
+				out.mesh.tangents[j] += in.tangents[i];
+				out.mesh.bitangents[j] += in.bitangents[i];
+				found = true;
+			}
+		}
+		if (!found) {
+			out.mesh.vertices.push_back(in.vertices[i]);
+			out.mesh.uvs.push_back(in.uvs[i]);
+			out.mesh.normals.push_back(in.normals[i]);
+			out.mesh.tangents.push_back(in.tangents[i]);
+			out.mesh.bitangents.push_back(in.bitangents[i]);
+			out.indices.push_back((unsigned int)out.mesh.vertices.size() - 1);
+		}
+	}
+}
+
+/*
+* index a mesh
+* @param implementation 0: previous indexVBO, 1: indexVBO, 2: previous indexVBO_TBN, 3: indexVBO_TBN
+* @param in the mesh
+* @param out the indexed mesh will be applied to
+* @return milliseconds of the indexing
+*/
+static double index(const int implementation, Mesh& in, IndexedMesh& out) {
+	out = IndexedMesh();
+	return measureMilliseconds([&]() {
+		switch (implementation) {
+		case 0:
+			indexVBOPrevious(in, out);
+			break;
+		case 1:
+			indexVBO(in.vertices, in.uvs, in.normals, out.indices, out.mesh.vertices, out.mesh.uvs, out.mesh.normals);
+			break;
+		case 2:
+			indexVBO_TBNPrevious(in, out);
+			break;
+		default:
+			indexVBO_TBN(in.vertices, in.uvs, in.normals, in.tangents, in.bitangents,
+				out.indices, out.mesh.vertices, out.mesh.uvs, out.mesh.normals, out.mesh.tangents, out.mesh.bitangents);
+			break;
+		}
+	});
+}
+
+/*
+* check whether two indexed meshes are identical
+*/
+static bool isIdentical(const IndexedMesh& a, const IndexedMesh& b) {
+	auto same = [](const auto& x, const auto& y) {
+		return x.size() == y.size() && (x.empty() || memcmp(&x[0], &y[0], x.size() * sizeof(x[0])) == 0);
+	};
+	return same(a.indices, b.indices) && same(a.mesh.vertices, b.mesh.vertices) && same(a.mesh.uvs, b.mesh.uvs) && same(a.mesh.normals, b.mesh.normals)
+		&& same(a.mesh.tangents, b.mesh.tangents) && same(a.mesh.bitangents, b.mesh.bitangents);
+}
+
+/*
+* run two implementations on a mesh and print the fastest of 3 runs
+* @return whether both implementations indexed the mesh identically
+*/
+static bool compare(const char* name, const int previous, const int hashed, Mesh& mesh) {
+	IndexedMesh outputs[2];
+	double milliseconds[2] = { 1e18, 1e18 };
+	for (int run = 0; run < 3; run++) {
+		milliseconds[0] = std::min(milliseconds[0], index(previous, mesh, outputs[0]));
+		milliseconds[1] = std::min(milliseconds[1], index(hashed, mesh, outputs[1]));
+	}
+	const bool identical = isIdentical(outputs[0], outputs[1]);
+	printf("%-14s %8zu corners %8zu vertices: previous %9.1f ms, hashed %7.1f ms (%.1fx)%s\n", name, mesh.vertices.size(), outputs[1].mesh.vertices.size(),
+		milliseconds[0], milliseconds[1], milliseconds[0] / milliseconds[1], identical ? "" : " DIFFERENT");
+	return identical;
+}
+
+int main() {
+	Mesh identical = createGrid(identicalQuads, 0);
+	Mesh similar = createGrid(similarQuads, 0.004f);
+	Mesh linear = createGrid(linearQuads, 0.004f);
+	bool identicalResults = compare("indexVBO", 0, 1, identical);
+	identicalResults = compare("indexVBO_TBN", 2, 3, linear) && identicalResults;
+
+	//the linear search would take hours on the large mesh
+	IndexedMesh output;
+	double milliseconds = 1e18;
+	for (int run = 0; run < 3; run++) milliseconds = std::min(milliseconds, index(3, similar, output));
+	printf("%-14s %8zu corners %8zu vertices: hashed %7.1f ms\n", "indexVBO_TBN", similar.vertices.size(), output.mesh.vertices.size(), milliseconds);
+	return identicalResults ? 0 : 1;
+}
@@ -0,0 +1,80 @@
+#include <vector>
+#include <glm/glm.hpp>
+#include <common/vboindexer.hpp>
+#include <common/vertexcache.hpp>
+#include "benchmarkMeshes.h"
+#include <algorithm>
+#include <array>
+#include <stdio.h>
+
+/*
+* report of the vertex cache optimisation (see common/vertexcache.cpp)
+* a grid (see benchmarkMeshes.h) is indexed by indexVBO in the order of it's rows and with shuffled triangles,
+* the cache statistics are reported for FIFO caches of 16 and 32 vertices before and after optimizeVertexCache,
+* optimizeVertexFetch needs to keep the triangles
+*/
+
+//quads per side of the grid
+constexpr int quads = 300;
+
+/*
+* create the indexed triangles of the grid
+* @param shuffled whether the triangles are shuffled or in the order of the rows
+* @return the mesh
+*/
+static IndexedMesh createIndexedGrid(const bool shuffled) {
+	Mesh triangles = createGrid(quads, 0, shuffled ? GRID_SHUFFLED : 0);
+	IndexedMesh mesh;
+	indexVBO(triangles.vertices, triangles.uvs, triangles.normals, mesh.indices, mesh.mesh.vertices, mesh.mesh.uvs, mesh.mesh.normals);
+	return mesh;
+}
+
+/*
+* get the triangles of a mesh by their positions (sorted, starting with their smallest corner)
+* @param mesh the mesh
+* @return the triangles
+*/
+static std::vector<std::array<float, 9>> getTriangles(const IndexedMesh& mesh) {
+	std::vector<std::array<float, 9>> triangles;
+	for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+		const std::vector<glm::vec3>& vertices = mesh.mesh.vertices;
+		std::array<glm::vec3, 3> corners = { { vertices[mesh.indices[i]], vertices[mesh.indices[i + 1]], vertices[mesh.indices[i + 2]] } };
+		auto less = [](const glm::vec3& a, const glm::vec3& b) { return a.x < b.x || (a.x == b.x && (a.y < b.y || (a.y == b.y && a.z < b.z))); };
+		std::rotate(corners.begin(), std::min_element(corners.begin(), corners.end(), less), corners.end());
+		triangles.push_back({ { corners[0].x, corners[0].y, corners[0].z, corners[1].x, corners[1].y, corners[1].z, corners[2].x, corners[2].y, corners[2].z } });
+	}
+	std::sort(triangles.begin(), triangles.end());
+	return triangles;
+}
+
+/*
+* print the cache statistics of a mesh
+*/
+static void printStatistics(const char* name, const IndexedMesh& mesh) {
+	printf("  %-10s", name);
+	for (unsigned int cacheSize : { 16u, 32u }) {
+		VertexCacheStatistics statistics = analyzeVertexCache(mesh.indices, mesh.mesh.vertices.size(), cacheSize);
+		printf("  cache %2u: ACMR %.3f ATVR %.3f", cacheSize, statistics.acmr, statistics.atvr);
+	}
+	printf("\n");
+}
+
+int main() {
+	bool keptTriangles = true;
+	for (bool shuffled : { false, true }) {
+		IndexedMesh mesh = createIndexedGrid(shuffled);
+		const std::vector<std::array<float, 9>> triangles = getTriangles(mesh);
+		printf("%s grid, %zu triangles, %zu vertices\n", shuffled ? "shuffled" : "row order", mesh.indices.size() / 3, mesh.mesh.vertices.size());
+		printStatistics("input", mesh);
+
+		const double milliseconds = measureMilliseconds([&]() {
+			optimizeVertexCache(mesh.indices, mesh.mesh.vertices.size());
+			optimizeVertexFetch(mesh.indices, mesh.mesh.vertices, mesh.mesh.uvs, mesh.mesh.normals);
+		});
+		printStatistics("optimized", mesh);
+		printf("  optimized in %.1f ms\n", milliseconds);
+		keptTriangles = keptTriangles && getTriangles(mesh) == triangles;
+	}
+	printf("triangles %s\n", keptTriangles ? "kept" : "CHANGED");
+	return keptTriangles ? 0 : 1;
+}
@@ -0,0 +1,105 @@
+#include <playground/gameData.h>
+#include <playground/fieldVertices.h>
+#include <chrono>
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+
+using namespace gameData;
+using namespace std::chrono;
+
+/*
+* benchmark of the vertex transformation of the animations (see playground.cpp -> applyTransformToRow)
+* the previous implementation transformed every vertex of every field separately (one call per field),
+* transformFieldRow transforms the vertices of a whole row from their corners in structure-of-arrays layout
+* one frame transforms every row of the main field like the end animation (the collapse animation transforms a subset of the rows)
+*/
+
+//number of frames per run
+constexpr int frameCountPerRun = 200000;
+
+//vertex and shape buffers of both implementations
+static float vertices[2][3 * 6 * (fieldX * fieldY + 16)], shapes[2][4 * 6 * (fieldX * fieldY + 16)];
+
+/*
+* transformation of a single field (the implementation before transformFieldRow)
+* @param x, y the field's coordinates
+* @param t the transformation
+* @param vertices, shapes buffers, the field's vertices and shape values will be applied to
+*/
+static void transformSingleField(const int x, const int y, const FieldTransform& t, float* vertices, float* shapes) {
+	float px = x + spacing;
+	float py = y + spacing;
+	for (int i = 0; i < 6; i++) {
+		float x1 = vertex_buffer_single[3 * i] * (1 - spacing * 2);
+		float y1 = vertex_buffer_single[3 * i + 1] * (1 - spacing * 2);
+		float x2 = x1 * t.a + y1 * t.b + t.c;
+		float y2 = x1 * t.d + y1 * t.e + t.f;
+		vertices[18 * getMainFieldIndex(x, y) + 3 * i] = px + x2;
+		vertices[18 * getMainFieldIndex(x, y) + 3 * i + 1] = py + y2;
+		vertices[18 * getMainFieldIndex(x, y) + 3 * i + 2] = vertex_buffer_single[3 * i + 2];
+		shapes[24 * getMainFieldIndex(x, y) + 4 * i] = vertex_buffer_single[3 * i];
+		shapes[24 * getMainFieldIndex(x, y) + 4 * i + 1] = vertex_buffer_single[3 * i + 1];
+		shapes[24 * getMainFieldIndex(x, y) + 4 * i + 2] = fabsf(t.a) * (1 - spacing * 2);
+		shapes[24 * getMainFieldIndex(x, y) + 4 * i + 3] = fabsf(t.e) * (1 - spacing * 2);
+	}
+}
+
+/*
+* transformation of a frame (the folding of the end animation, see updateAnimationEnd, with a different translation per row)
+* @param frame the frame's index
+* @param y the row's y-coordinate
+* @return the row's transformation
+*/
+static FieldTransform getFrameTransform(const int frame, const int y) {
+	const float folding = (frame % 100) / 100.0f;
+	return FieldTransform{ folding, 0, (1 - spacing * 2) * (1.0f - folding) / 2.0f, 0, 1, -0.1f * y };
+}
+
+/*
+* run the frames of an implementation
+* @param batched whether transformFieldRow or transformSingleField is used
+* @param checksum float, a vertex of every frame will be added to (prevents the frames from being optimized away)
+* @return nanoseconds per frame
+*/
+static double runFrames(const bool batched, float* checksum) {
+	float* v = vertices[batched];
+	float* s = shapes[batched];
+	auto tStart = high_resolution_clock::now();
+	for (int frame = 0; frame < frameCountPerRun; frame++) {
+		for (int y = 0; y < fieldY; y++) {
+			const FieldTransform transform = getFrameTransform(frame, y);
+			if (batched) {
+				transformFieldRow(fieldX, y, transform, &v[18 * getMainFieldIndex(0, y)], &s[24 * getMainFieldIndex(0, y)]);
+			}
+			else {
+				for (int x = 0; x < fieldX; x++) {
+					transformSingleField(x, y, transform, v, s);
+				}
+			}
+		}
+		*checksum += v[frame % (sizeof(vertices[0]) / sizeof(float))];
+	}
+	return duration_cast<nanoseconds>(high_resolution_clock::now() - tStart).count() * 1.0 / frameCountPerRun;
+}
+
+int main() {
+	//fastest of 3 runs
+	double perField = 1e18, batched = 1e18;
+	float checksums[2] = { 0, 0 };
+	for (int run = 0; run < 3; run++) {
+		perField = std::min(perField, runFrames(false, &checksums[0]));
+		batched = std::min(batched, runFrames(true, &checksums[1]));
+	}
+
+	//both implementations need to calculate the same vertices (up to rounding)
+	float maxDifference = 0;
+	for (size_t i = 0; i < sizeof(vertices[0]) / sizeof(float); i++) maxDifference = std::max(maxDifference, fabsf(vertices[0][i] - vertices[1][i]));
+	for (size_t i = 0; i < sizeof(shapes[0]) / sizeof(float); i++) maxDifference = std::max(maxDifference, fabsf(shapes[0][i] - shapes[1][i]));
+
+	printf("%d fields, %d frames per run (fastest of 3 runs)\n", fieldX * fieldY, frameCountPerRun);
+	printf("per field:  %8.1f ns per frame\n", perField);
+	printf("batched:    %8.1f ns per frame (%.2fx)\n", batched, perField / batched);
+	printf("max difference: %g (checksums %g, %g)\n", maxDifference, checksums[0], checksums[1]);
+	return maxDifference < 1e-5f ? 0 : 1;
+}
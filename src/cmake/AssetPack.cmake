@@ -0,0 +1,24 @@
+# Packing of assets into a single file (see common/assetpack.hpp)
+#
+# add_asset_pack(<target> <pack> <asset files...>)
+#   adds a target that writes <pack> (relative to the build directory) with the assetpack builder, the pack is rebuilt when
+#   an asset changes. OBJ files are transcoded into binary caches of their triangles, the other files are stored as they are.
+#   The assets are found by their file names (without directories) at runtime.
+#
+# the builder is the target 'assetpack' (common/assetpackbuilder.cpp), it needs to be defined before the packs
+
+function(add_asset_pack target pack)
+	set(inputs "")
+	foreach(asset ${ARGN})
+		get_filename_component(path "${asset}" ABSOLUTE)
+		list(APPEND inputs "${path}")
+	endforeach()
+	add_custom_command(
+		OUTPUT "${CMAKE_CURRENT_BINARY_DIR}/${pack}"
+		COMMAND assetpack "${CMAKE_CURRENT_BINARY_DIR}/${pack}" ${inputs}
+		DEPENDS assetpack ${inputs}
+		COMMENT "Packing assets into ${pack}"
+		VERBATIM
+	)
+	add_custom_target(${target} ALL DEPENDS "${CMAKE_CURRENT_BINARY_DIR}/${pack}")
+endfunction()
@@ -0,0 +1,57 @@
+# Embedding of shader sources into a generated header
+#
+# embed_shaders(<header> <shader files...>)
+#   adds a custom command that writes <header> (relative to the build directory) with every shader as constexpr string literal:
+#     namespace embeddedShaders { constexpr const char SimpleVertexShader_vertexshader[] = R"..."; ... }
+#   and a table of every shader by it's file name (embeddedShaders::shaders, see embeddedShaders::find)
+#   the header is regenerated when a shader changes, it needs to be listed in the sources of the targets including it
+#
+# the header is written by this file in script mode: cmake -DOUTPUT=<header> -DINPUTS=<file|file...> -P EmbedShaders.cmake
+
+if(CMAKE_SCRIPT_MODE_FILE)
+	string(REPLACE "|" ";" INPUTS "${INPUTS}")
+	set(content "// generated by EmbedShaders.cmake from the shader files, don't edit\n")
+	set(content "${content}#ifndef EMBEDDED_SHADERS_H\n#define EMBEDDED_SHADERS_H\n\n#include <string.h>\n\nnamespace embeddedShaders {\n\n")
+	set(table "")
+	foreach(input ${INPUTS})
+		get_filename_component(name "${input}" NAME)
+		string(MAKE_C_IDENTIFIER "${name}" identifier)
+		file(READ "${input}" source)
+		if(source MATCHES "\\)glsl\"")
+			message(FATAL_ERROR "${input} contains the delimiter of the raw string literal")
+		endif()
+		set(content "${content}\t//${name}\n\tconstexpr const char ${identifier}[] = R\"glsl(${source})glsl\";\n\n")
+		set(table "${table}\t\t{ \"${name}\", ${identifier} },\n")
+	endforeach()
+	set(content "${content}\t//an embedded shader file\n\tstruct Shader {\n\t\tconst char* name;\n\t\tconst char* source;\n\t};\n\n")
+	set(content "${content}\t//every embedded shader\n\tconstexpr Shader shaders[] = {\n${table}\t};\n\n")
+	set(content "${content}\t/*\n\t* find an embedded shader by it's file name\n\t* @param name the shader's file name (without directories)\n\t* @return the shader's source (nullptr if no shader with the name is embedded)\n\t*/\n")
+	set(content "${content}\tinline const char* find(const char* name) {\n\t\tfor (const Shader& shader : shaders) {\n\t\t\tif (strcmp(shader.name, name) == 0) return shader.source;\n\t\t}\n\t\treturn nullptr;\n\t}\n\n}\n\n#endif\n")
+	# only writing a changed header (the includes aren't recompiled otherwise)
+	set(existing "")
+	if(EXISTS "${OUTPUT}")
+		file(READ "${OUTPUT}" existing)
+	endif()
+	if(NOT existing STREQUAL content)
+		file(WRITE "${OUTPUT}" "${content}")
+	endif()
+	return()
+endif()
+
+set(EMBED_SHADERS_SCRIPT "${CMAKE_CURRENT_LIST_FILE}")
+
+function(embed_shaders header)
+	set(inputs "")
+	foreach(shader ${ARGN})
+		get_filename_component(path "${shader}" ABSOLUTE)
+		list(APPEND inputs "${path}")
+	endforeach()
+	string(REPLACE ";" "|" inputList "${inputs}")
+	add_custom_command(
+		OUTPUT "${CMAKE_CURRENT_BINARY_DIR}/${header}"
+		COMMAND ${CMAKE_COMMAND} "-DOUTPUT=${CMAKE_CURRENT_BINARY_DIR}/${header}" "-DINPUTS=${inputList}" -P "${EMBED_SHADERS_SCRIPT}"
+		DEPENDS ${inputs} "${EMBED_SHADERS_SCRIPT}"
+		COMMENT "Embedding shaders into ${header}"
+		VERBATIM
+	)
+endfunction()
@@ -0,0 +1,114 @@
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+#include "assetpack.hpp"
+
+AssetPack::AssetPack() : m_entries(NULL), m_names(NULL), m_count(0) {
+}
+
+bool AssetPack::open(const char * path) {
+	close();
+	if (!m_file.open(path)) return false;
+
+	const unsigned char * data = (const unsigned char *)m_file.data();
+	const size_t size = m_file.size();
+	const AssetPackHeader * header = (const AssetPackHeader *)data;
+	if (size < sizeof(AssetPackHeader) || header->magic != ASSET_PACK_MAGIC || header->version != ASSET_PACK_VERSION
+		|| (size - sizeof(AssetPackHeader)) / sizeof(AssetPackEntry) < header->entryCount) {
+		m_file.close();
+		return false;
+	}
+	const AssetPackEntry * entries = (const AssetPackEntry *)(header + 1);
+	const char * names = (const char *)(entries + header->entryCount);
+	if ((size_t)(data + size - (const unsigned char *)names) < header->namesSize || (header->namesSize > 0 && names[header->namesSize - 1] != '\0')) {
+		m_file.close();
+		return false;
+	}
+	// every blob is in the file and the names are sorted (find is a binary search)
+	for (uint32_t i = 0; i < header->entryCount; i++) {
+		const AssetPackEntry & entry = entries[i];
+		if (entry.nameOffset >= header->namesSize || entry.offset > size || entry.size >= size - entry.offset
+			|| (i > 0 && strcmp(names + entries[i - 1].nameOffset, names + entry.nameOffset) >= 0)) {
+			m_file.close();
+			return false;
+		}
+	}
+
+	m_entries = entries;
+	m_names = names;
+	m_count = header->entryCount;
+	return true;
+}
+
+void AssetPack::close() {
+	m_file.close();
+	m_entries = NULL;
+	m_names = NULL;
+	m_count = 0;
+}
+
+AssetSpan AssetPack::find(const char * name) const {
+	AssetSpan span = { NULL, 0, 0 };
+	const AssetPackEntry * entry = std::lower_bound(m_entries, m_entries + m_count, name, [this](const AssetPackEntry & e, const char * n) {
+		return strcmp(m_names + e.nameOffset, n) < 0;
+	});
+	if (entry != m_entries + m_count && strcmp(m_names + entry->nameOffset, name) == 0) {
+		span.data = (const unsigned char *)m_file.data() + entry->offset;
+		span.size = (size_t)entry->size;
+		span.flags = entry->flags;
+	}
+	return span;
+}
+
+bool writeAssetPack(const char * path, std::vector<AssetPackInput> & assets) {
+	std::sort(assets.begin(), assets.end(), [](const AssetPackInput & a, const AssetPackInput & b) { return a.name < b.name; });
+	for (size_t i = 1; i < assets.size(); i++) {
+		if (assets[i - 1].name == assets[i].name) {
+			fprintf(stderr, "%s is in the pack twice\n", assets[i].name.c_str());
+			return false;
+		}
+	}
+
+	// the index and the names, then the aligned blobs
+	std::vector<AssetPackEntry> entries(assets.size());
+	std::string names;
+	for (size_t i = 0; i < assets.size(); i++) {
+		entries[i].nameOffset = (uint32_t)names.size();
+		entries[i].flags = assets[i].flags;
+		names.append(assets[i].name.c_str(), assets[i].name.size() + 1);
+	}
+	AssetPackHeader header = { ASSET_PACK_MAGIC, ASSET_PACK_VERSION, (uint32_t)assets.size(), (uint32_t)names.size() };
+	uint64_t offset = sizeof(header) + entries.size() * sizeof(AssetPackEntry) + names.size();
+	for (size_t i = 0; i < assets.size(); i++) {
+		offset = (offset + ASSET_PACK_ALIGNMENT - 1) & ~(uint64_t)(ASSET_PACK_ALIGNMENT - 1);
+		entries[i].offset = offset;
+		entries[i].size = assets[i].data.size();
+		offset += assets[i].data.size() + 1;
+	}
+
+	// writing a temporary file first, so a running game never maps a partial pack
+	std::string temporaryPath = std::string(path) + ".tmp";
+	FILE * file = fopen(temporaryPath.c_str(), "wb");
+	if (file == NULL) return false;
+	bool complete = fwrite(&header, sizeof(header), 1, file) == 1
+		&& (entries.empty() || fwrite(&entries[0], sizeof(AssetPackEntry), entries.size(), file) == entries.size())
+		&& fwrite(names.data(), 1, names.size(), file) == names.size();
+	uint64_t position = sizeof(header) + entries.size() * sizeof(AssetPackEntry) + names.size();
+	static const unsigned char zeros[ASSET_PACK_ALIGNMENT] = { 0 };
+	for (size_t i = 0; i < assets.size() && complete; i++) {
+		size_t padding = (size_t)(entries[i].offset - position);
+		const std::vector<unsigned char> & data = assets[i].data;
+		complete = fwrite(zeros, 1, padding, file) == padding
+			&& (data.empty() || fwrite(&data[0], 1, data.size(), file) == data.size())
+			&& fwrite(zeros, 1, 1, file) == 1;
+		position = entries[i].offset + data.size() + 1;
+	}
+	complete = fclose(file) == 0 && complete;
+	remove(path);
+	if (!complete || rename(temporaryPath.c_str(), path) != 0) {
+		remove(temporaryPath.c_str());
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,86 @@
+#ifndef ASSETPACK_HPP
+#define ASSETPACK_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "mappedfile.hpp"
+
+// Pack of assets (shaders, textures, fonts, meshes) in a single file, written by assetpackbuilder
+// (see add_asset_pack in cmake/AssetPack.cmake). The pack is mapped once, the assets are used in place:
+// shader sources with LoadShadersFromSource, images with loadBMP_memory and loadDDS_memory, meshes with loadOBJFromMemory.
+//
+// Layout: AssetPackHeader, the index (AssetPackEntry sorted by name), the names (NUL-terminated), the blobs.
+// Every blob starts at a multiple of ASSET_PACK_ALIGNMENT and is followed by a NUL byte (so text is a C string).
+
+// identification of a pack ("APAK") and version of it's layout
+static const uint32_t ASSET_PACK_MAGIC = 0x4b415041;
+static const uint32_t ASSET_PACK_VERSION = 1;
+static const size_t ASSET_PACK_ALIGNMENT = 64;
+
+// Flags of an asset
+enum {
+	// an OBJ file stored as binary cache of it's triangles (see encodeOBJCache, loadOBJFromMemory reads both)
+	ASSET_TRANSCODED_OBJ = 1
+};
+
+struct AssetPackHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t entryCount;
+	// size of the names (after the index)
+	uint32_t namesSize;
+};
+
+struct AssetPackEntry {
+	// position of the blob in the pack and it's size (without the NUL byte)
+	uint64_t offset;
+	uint64_t size;
+	// position of the name in the names
+	uint32_t nameOffset;
+	uint32_t flags;
+};
+
+// An asset in the mapped pack (data is NULL if the asset isn't in the pack)
+struct AssetSpan {
+	const void * data;
+	size_t size;
+	uint32_t flags;
+};
+
+class AssetPack {
+public:
+	AssetPack();
+	AssetPack(const AssetPack&) = delete;
+	AssetPack& operator=(const AssetPack&) = delete;
+
+	// Maps a pack and validates it's index, returns false if it can't be opened or isn't a pack
+	bool open(const char * path);
+	void close();
+	bool isOpen() const { return m_entries != NULL; }
+
+	// Finds an asset by it's name (binary search), the span is valid until the pack is closed
+	AssetSpan find(const char * name) const;
+	size_t count() const { return m_count; }
+	const char * name(size_t index) const { return m_names + m_entries[index].nameOffset; }
+
+private:
+	MappedFile m_file;
+	const AssetPackEntry * m_entries;
+	const char * m_names;
+	size_t m_count;
+};
+
+// An asset to be written into a pack
+struct AssetPackInput {
+	std::string name;
+	std::vector<unsigned char> data;
+	uint32_t flags;
+};
+
+// Writes a pack of the assets (sorted by name), returns false if a name is used twice or the file can't be written
+bool writeAssetPack(const char * path, std::vector<AssetPackInput> & assets);
+
+#endif
@@ -0,0 +1,77 @@
+#include <vector>
+#include <string>
+#include <stdio.h>
+#include <string.h>
+
+#include <glm/glm.hpp>
+
+#include "assetpack.hpp"
+#include "objloader.hpp"
+
+// Builder of asset packs (see assetpack.hpp and add_asset_pack in cmake/AssetPack.cmake)
+// usage: assetpack <pack> [--raw] <file>[=<name>]...
+// the name of an asset is it's file name without directories (or the name after '='),
+// OBJ files are stored as binary cache of their triangles (transcoded) unless --raw is given
+
+// Reads a whole file, returns false if it can't be read
+static bool ReadFile(const char * path, std::vector<unsigned char> & data) {
+	FILE * file = fopen(path, "rb");
+	if (file == NULL) return false;
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	data.resize(size > 0 ? size : 0);
+	bool complete = size >= 0 && (data.empty() || fread(&data[0], 1, data.size(), file) == data.size());
+	fclose(file);
+	return complete;
+}
+
+static bool EndsWith(const std::string & text, const char * suffix) {
+	size_t length = strlen(suffix);
+	return text.size() >= length && text.compare(text.size() - length, length, suffix) == 0;
+}
+
+int main(int argc, char * argv[]) {
+	if (argc < 2) {
+		fprintf(stderr, "usage: %s <pack> [--raw] <file>[=<name>]...\n", argv[0]);
+		return -1;
+	}
+	bool transcode = true;
+	std::vector<AssetPackInput> assets;
+	for (int i = 2; i < argc; i++) {
+		if (strcmp(argv[i], "--raw") == 0) {
+			transcode = false;
+			continue;
+		}
+		std::string path = argv[i];
+		AssetPackInput asset;
+		size_t separator = path.find('=');
+		if (separator != std::string::npos) {
+			asset.name = path.substr(separator + 1);
+			path = path.substr(0, separator);
+		} else {
+			size_t directory = path.find_last_of("/\\");
+			asset.name = directory == std::string::npos ? path : path.substr(directory + 1);
+		}
+		asset.flags = 0;
+
+		if (transcode && EndsWith(path, ".obj")) {
+			// the triangles are parsed once by the build instead of every start
+			std::vector<glm::vec3> vertices, normals;
+			std::vector<glm::vec2> uvs;
+			if (!loadOBJ(path.c_str(), vertices, uvs, normals) || !encodeOBJCache(vertices, uvs, normals, asset.data)) return -1;
+			asset.flags = ASSET_TRANSCODED_OBJ;
+		} else if (!ReadFile(path.c_str(), asset.data)) {
+			fprintf(stderr, "Can't read %s\n", path.c_str());
+			return -1;
+		}
+		assets.push_back(asset);
+	}
+
+	if (!writeAssetPack(argv[1], assets)) {
+		fprintf(stderr, "Can't write %s\n", argv[1]);
+		return -1;
+	}
+	printf("%d assets written to %s\n", (int)assets.size(), argv[1]);
+	return 0;
+}
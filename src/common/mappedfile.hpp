@@ -0,0 +1,33 @@
+#ifndef MAPPEDFILE_HPP
+#define MAPPEDFILE_HPP
+
+#include <stddef.h>
+
+// Read-only memory mapping of a whole file (mmap on POSIX, MapViewOfFile on Windows).
+// The contents are used in place, nothing is read or parsed when the file is opened.
+class MappedFile {
+public:
+	MappedFile();
+	~MappedFile();
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// Maps the file, returns false if it can't be opened (an already mapped file is closed first)
+	bool open(const char * path);
+	// Unmaps the file
+	void close();
+
+	const void * data() const { return m_data; }
+	size_t size() const { return m_size; }
+	bool isOpen() const { return m_data != NULL; }
+
+private:
+	void * m_data;
+	size_t m_size;
+#ifdef _WIN32
+	void * m_file;
+	void * m_mapping;
+#endif
+};
+
+#endif
@@ -1,112 +1,477 @@
 #include <vector>
 #include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
 #include <string>
 #include <cstring>
+#include <thread>
+#include <algorithm>
+#include <sys/stat.h>
 
 #include <glm/glm.hpp>
 
+#include "mappedfile.hpp"
 #include "objloader.hpp"
 
-// Very, VERY simple OBJ loader.
-// Here is a short list of features a real function would provide : 
-// - Binary files. Reading a model should be just a few memcpy's away, not parsing a file at runtime. In short : OBJ is not very great.
-// - Animations & bones (includes bones weights)
-// - Multiple UVs
-// - All attributes should be optional, not "forced"
-// - More stable. Change a line in the OBJ file and it crashes.
-// - More secure. Change another line and you can inject code.
-// - Loading from memory, stream, etc
+// OBJ loader for large meshes: the file is mapped and split into chunks of whole lines, which are parsed in parallel.
+// Supported : v, vt, vn and f with any number of corners (v, v/vt, v//vn or v/vt/vn, negative indices are relative).
+// Everything else (comments, objects, groups, materials, ...) is skipped.
+// The triangles can be cached in a binary file, which is mapped and copied instead of parsing the OBJ file again.
 
-bool loadOBJ(
-	const char * path, 
-	std::vector<glm::vec3> & out_vertices, 
-	std::vector<glm::vec2> & out_uvs,
-	std::vector<glm::vec3> & out_normals
-){
-	printf("Loading OBJ file %s...\n", path);
+// Minimum size of a chunk (smaller files are parsed by a single thread)
+static const size_t MIN_CHUNK_SIZE = 1 << 20;
 
-	std::vector<unsigned int> vertexIndices, uvIndices, normalIndices;
-	std::vector<glm::vec3> temp_vertices; 
-	std::vector<glm::vec2> temp_uvs;
-	std::vector<glm::vec3> temp_normals;
+// Index of a missing attribute of a corner
+static const int32_t MISSING_INDEX = INT32_MIN;
 
+// Attribute indices of a triangle corner (0-based), relative indices are counted from the first attribute of the chunk
+// (negative indices refer to a previous chunk)
+struct OBJCorner {
+	int32_t vertex, uv, normal;
+	// bits of the relative indices (RELATIVE_VERTEX, RELATIVE_UV, RELATIVE_NORMAL)
+	uint8_t relative;
+};
+enum { RELATIVE_VERTEX = 1, RELATIVE_UV = 2, RELATIVE_NORMAL = 4 };
 
-	FILE * file = fopen(path, "r");
-	if( file == NULL ){
-		printf("Impossible to open the file ! Are you in the right path ? See Tutorial 1 for details\n");
-		getchar();
-		return false;
+// Attributes and triangle corners of a chunk
+struct OBJChunk {
+	const char * begin;
+	const char * end;
+	std::vector<glm::vec3> vertices;
+	std::vector<glm::vec2> uvs;
+	std::vector<glm::vec3> normals;
+	std::vector<OBJCorner> corners;
+	// number of attributes before the chunk and the first triangle corner of the chunk (set by the merge)
+	size_t vertexBase, uvBase, normalBase, cornerBase;
+	// line of the first error (0 if the chunk was parsed)
+	size_t errorLine;
+};
+
+// Header of a cache file, followed by the vertices (3 floats), uvs (2 floats) and normals (3 floats) of the triangles
+struct OBJCacheHeader {
+	uint32_t magic;
+	uint32_t version;
+	// size and modification time of the OBJ file the cache was written for
+	uint64_t sourceSize;
+	int64_t sourceTime;
+	uint64_t vertexCount;
+};
+// identification of a cache file ("OBJC") and version of it's layout
+static const uint32_t OBJ_CACHE_MAGIC = 0x434a424f;
+static const uint32_t OBJ_CACHE_VERSION = 1;
+
+static inline bool isBlank(char c) {
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+static inline const char * skipBlanks(const char * p, const char * end) {
+	while (p < end && isBlank(*p)) p++;
+	return p;
+}
+
+static inline const char * skipLine(const char * p, const char * end) {
+	const char * lineEnd = (const char *)memchr(p, '\n', end - p);
+	return lineEnd != NULL ? lineEnd + 1 : end;
+}
+
+// Parses a float (sign, digits, fraction and exponent), uses strtof for anything else (inf, nan, hex, long mantissas).
+// Returns the position after the number, or NULL if there's no number.
+static const char * parseFloat(const char * p, const char * end, float * value) {
+	static const double POWERS_OF_10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+		1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+	const char * start = p;
+	bool negative = false;
+	if (p < end && (*p == '-' || *p == '+')) negative = *p++ == '-';
+
+	uint64_t mantissa = 0;
+	int digits = 0, exponent = 0;
+	for (; p < end && (unsigned)(*p - '0') < 10; p++, digits++) mantissa = mantissa * 10 + (*p - '0');
+	if (p < end && *p == '.') {
+		p++;
+		for (; p < end && (unsigned)(*p - '0') < 10; p++, digits++, exponent--) mantissa = mantissa * 10 + (*p - '0');
+	}
+	if (digits > 0 && p < end && (*p == 'e' || *p == 'E')) {
+		const char * e = p + 1;
+		bool negativeExponent = false;
+		if (e < end && (*e == '-' || *e == '+')) negativeExponent = *e++ == '-';
+		int value = 0;
+		const char * exponentStart = e;
+		for (; e < end && (unsigned)(*e - '0') < 10 && value < 10000; e++) value = value * 10 + (*e - '0');
+		if (e > exponentStart) {
+			exponent += negativeExponent ? -value : value;
+			p = e;
+		}
 	}
 
-	while( 1 ){
+	// the fast path is exact for mantissas of up to 19 digits and exponents the table contains
+	if (digits <= 0 || digits > 19 || exponent < -22 || exponent > 22 || (p < end && !isBlank(*p) && *p != '\n' && *p != '/')) {
+		// copying the token, the mapped file isn't terminated
+		char buffer[64];
+		size_t length = 0;
+		while (start + length < end && length < sizeof(buffer) - 1 && !isBlank(start[length]) && start[length] != '\n') length++;
+		memcpy(buffer, start, length);
+		buffer[length] = 0;
+		char * parsed;
+		*value = strtof(buffer, &parsed);
+		return parsed == buffer ? NULL : start + (parsed - buffer);
+	}
+	double result = (double)mantissa;
+	result = exponent < 0 ? result / POWERS_OF_10[-exponent] : result * POWERS_OF_10[exponent];
+	*value = (float)(negative ? -result : result);
+	return p;
+}
 
-		char lineHeader[128];
-		// read the first word of the line
-		int res = fscanf(file, "%s", lineHeader);
-		if (res == EOF)
-			break; // EOF = End Of File. Quit the loop.
+// Parses an index of a corner (a negative index is relative to the 'count' attributes of the chunk read so far),
+// returns the position after the index or NULL if there's no valid index
+static const char * parseIndex(const char * p, const char * end, size_t count, int32_t * index, uint8_t * relative, uint8_t relativeBit) {
+	bool negative = false;
+	if (p < end && *p == '-') {
+		negative = true;
+		p++;
+	}
+	const char * digitsStart = p;
+	int64_t value = 0;
+	for (; p < end && (unsigned)(*p - '0') < 10 && value <= INT32_MAX; p++) value = value * 10 + (*p - '0');
+	if (p == digitsStart || value == 0 || value > INT32_MAX) return NULL;
+	if (negative) {
+		*index = (int32_t)((int64_t)count - value);
+		*relative |= relativeBit;
+	}
+	else {
+		*index = (int32_t)(value - 1);
+	}
+	return p;
+}
 
-		// else : parse lineHeader
-		
-		if ( strcmp( lineHeader, "v" ) == 0 ){
+// Parses the lines of a chunk
+static void parseChunk(OBJChunk * chunk) {
+	const char * p = chunk->begin;
+	const char * end = chunk->end;
+	std::vector<OBJCorner> polygon;
+	size_t line = 0;
+	chunk->errorLine = 0;
+	for (; p < end; p = skipLine(p, end)) {
+		line++;
+		p = skipBlanks(p, end);
+		if (end - p < 2) continue;
+		if (p[0] == 'v' && isBlank(p[1])) {
 			glm::vec3 vertex;
-			fscanf(file, "%f %f %f\n", &vertex.x, &vertex.y, &vertex.z );
-			temp_vertices.push_back(vertex);
-		}else if ( strcmp( lineHeader, "vt" ) == 0 ){
-			glm::vec2 uv;
-			fscanf(file, "%f %f\n", &uv.x, &uv.y );
+			const char * q = p + 1;
+			for (int i = 0; i < 3 && q != NULL; i++) q = parseFloat(skipBlanks(q, end), end, &vertex[i]);
+			if (q == NULL) break;
+			chunk->vertices.push_back(vertex);
+		}
+		else if (p[0] == 'v' && p[1] == 't' && p + 2 < end && isBlank(p[2])) {
+			// the second coordinate is optional
+			glm::vec2 uv(0.0f);
+			const char * q = parseFloat(skipBlanks(p + 2, end), end, &uv.x);
+			if (q == NULL) break;
+			q = skipBlanks(q, end);
+			if (q < end && *q != '\n' && *q != '#' && parseFloat(q, end, &uv.y) == NULL) break;
 			uv.y = -uv.y; // Invert V coordinate since we will only use DDS texture, which are inverted. Remove if you want to use TGA or BMP loaders.
-			temp_uvs.push_back(uv);
-		}else if ( strcmp( lineHeader, "vn" ) == 0 ){
+			chunk->uvs.push_back(uv);
+		}
+		else if (p[0] == 'v' && p[1] == 'n' && p + 2 < end && isBlank(p[2])) {
 			glm::vec3 normal;
-			fscanf(file, "%f %f %f\n", &normal.x, &normal.y, &normal.z );
-			temp_normals.push_back(normal);
-		}else if ( strcmp( lineHeader, "f" ) == 0 ){
-			std::string vertex1, vertex2, vertex3;
-			unsigned int vertexIndex[3], uvIndex[3], normalIndex[3];
-			int matches = fscanf(file, "%d/%d/%d %d/%d/%d %d/%d/%d\n", &vertexIndex[0], &uvIndex[0], &normalIndex[0], &vertexIndex[1], &uvIndex[1], &normalIndex[1], &vertexIndex[2], &uvIndex[2], &normalIndex[2] );
-			if (matches != 9){
-				printf("File can't be read by our simple parser :-( Try exporting with other options\n");
-				fclose(file);
-				return false;
+			const char * q = p + 2;
+			for (int i = 0; i < 3 && q != NULL; i++) q = parseFloat(skipBlanks(q, end), end, &normal[i]);
+			if (q == NULL) break;
+			chunk->normals.push_back(normal);
+		}
+		else if (p[0] == 'f' && isBlank(p[1])) {
+			// corners of the polygon (v, v/vt, v//vn or v/vt/vn)
+			polygon.clear();
+			const char * q = skipBlanks(p + 1, end);
+			while (q != NULL && q < end && *q != '\n' && *q != '#') {
+				OBJCorner corner = { MISSING_INDEX, MISSING_INDEX, MISSING_INDEX, 0 };
+				q = parseIndex(q, end, chunk->vertices.size(), &corner.vertex, &corner.relative, RELATIVE_VERTEX);
+				if (q != NULL && q < end && *q == '/') {
+					q++;
+					if (q < end && *q != '/') q = parseIndex(q, end, chunk->uvs.size(), &corner.uv, &corner.relative, RELATIVE_UV);
+					if (q != NULL && q < end && *q == '/') q = parseIndex(q + 1, end, chunk->normals.size(), &corner.normal, &corner.relative, RELATIVE_NORMAL);
+				}
+				if (q == NULL || (q < end && !isBlank(*q) && *q != '\n')) {
+					q = NULL;
+					break;
+				}
+				polygon.push_back(corner);
+				q = skipBlanks(q, end);
+			}
+			if (q == NULL || polygon.size() < 3) break;
+			// fan of triangles
+			for (size_t i = 2; i < polygon.size(); i++) {
+				chunk->corners.push_back(polygon[0]);
+				chunk->corners.push_back(polygon[i - 1]);
+				chunk->corners.push_back(polygon[i]);
 			}
-			vertexIndices.push_back(vertexIndex[0]);
-			vertexIndices.push_back(vertexIndex[1]);
-			vertexIndices.push_back(vertexIndex[2]);
-			uvIndices    .push_back(uvIndex[0]);
-			uvIndices    .push_back(uvIndex[1]);
-			uvIndices    .push_back(uvIndex[2]);
-			normalIndices.push_back(normalIndex[0]);
-			normalIndices.push_back(normalIndex[1]);
-			normalIndices.push_back(normalIndex[2]);
-		}else{
-			// Probably a comment, eat up the rest of the line
-			char stupidBuffer[1000];
-			fgets(stupidBuffer, 1000, file);
 		}
+	}
+	if (p < end) chunk->errorLine = line;
+}
 
+// Resolves an index of a chunk (SIZE_MAX if the attribute is missing), returns false if it's out of range
+static inline bool resolveIndex(int32_t index, bool relative, size_t base, size_t count, size_t * resolved) {
+	if (index == MISSING_INDEX && !relative) {
+		*resolved = SIZE_MAX;
+		return true;
 	}
+	int64_t value = relative ? (int64_t)base + index : index;
+	if (value < 0 || value >= (int64_t)count) return false;
+	*resolved = (size_t)value;
+	return true;
+}
 
-	// For each vertex of each triangle
-	for( unsigned int i=0; i<vertexIndices.size(); i++ ){
-
-		// Get the indices of its attributes
-		unsigned int vertexIndex = vertexIndices[i];
-		unsigned int uvIndex = uvIndices[i];
-		unsigned int normalIndex = normalIndices[i];
-		
-		// Get the attributes thanks to the index
-		glm::vec3 vertex = temp_vertices[ vertexIndex-1 ];
-		glm::vec2 uv = temp_uvs[ uvIndex-1 ];
-		glm::vec3 normal = temp_normals[ normalIndex-1 ];
-		
-		// Put the attributes in buffers
-		out_vertices.push_back(vertex);
-		out_uvs     .push_back(uv);
-		out_normals .push_back(normal);
-	
+// Writes the triangle corners of a chunk into the output, returns false if an index is out of range
+static bool resolveChunk(const OBJChunk * chunk,
+	const std::vector<glm::vec3> & vertices, const std::vector<glm::vec2> & uvs, const std::vector<glm::vec3> & normals,
+	std::vector<glm::vec3> & out_vertices, std::vector<glm::vec2> & out_uvs, std::vector<glm::vec3> & out_normals) {
+	for (size_t i = 0; i < chunk->corners.size(); i++) {
+		const OBJCorner & corner = chunk->corners[i];
+		size_t vertex, uv, normal;
+		if (!resolveIndex(corner.vertex, (corner.relative & RELATIVE_VERTEX) != 0, chunk->vertexBase, vertices.size(), &vertex) || vertex == SIZE_MAX
+			|| !resolveIndex(corner.uv, (corner.relative & RELATIVE_UV) != 0, chunk->uvBase, uvs.size(), &uv)
+			|| !resolveIndex(corner.normal, (corner.relative & RELATIVE_NORMAL) != 0, chunk->normalBase, normals.size(), &normal)) return false;
+		size_t output = chunk->cornerBase + i;
+		out_vertices[output] = vertices[vertex];
+		out_uvs[output] = uv != SIZE_MAX ? uvs[uv] : glm::vec2(0.0f);
+		out_normals[output] = normal != SIZE_MAX ? normals[normal] : glm::vec3(0.0f);
+	}
+	return true;
+}
+
+// Size and modification time of a file, returns false if it doesn't exist
+static bool getFileStamp(const char * path, uint64_t * size, int64_t * time) {
+	struct stat st;
+	if (stat(path, &st) != 0) return false;
+	*size = (uint64_t)st.st_size;
+	*time = (int64_t)st.st_mtime;
+	return true;
+}
+
+// Validates the layout of a cache in memory, returns the header or NULL
+static const OBJCacheHeader * getOBJCache(const void * data, size_t size) {
+	const OBJCacheHeader * header = (const OBJCacheHeader *)data;
+	if (size < sizeof(OBJCacheHeader) || header->magic != OBJ_CACHE_MAGIC || header->version != OBJ_CACHE_VERSION
+		|| size != sizeof(OBJCacheHeader) + header->vertexCount * 8 * sizeof(float)) {
+		return NULL;
+	}
+	return header;
+}
+
+// Maps a cache file and validates it's layout, returns the header or NULL
+static const OBJCacheHeader * openOBJCache(MappedFile & file, const char * cache_path) {
+	if (!file.open(cache_path)) return NULL;
+	const OBJCacheHeader * header = getOBJCache(file.data(), file.size());
+	if (header == NULL) file.close();
+	return header;
+}
+
+// Appends the triangles of a mapped cache
+static void readOBJCache(const OBJCacheHeader * header,
+	std::vector<glm::vec3> & out_vertices, std::vector<glm::vec2> & out_uvs, std::vector<glm::vec3> & out_normals) {
+	size_t count = (size_t)header->vertexCount;
+	const float * data = (const float *)(header + 1);
+	out_vertices.insert(out_vertices.end(), (const glm::vec3 *)data, (const glm::vec3 *)data + count);
+	out_uvs.insert(out_uvs.end(), (const glm::vec2 *)(data + 3 * count), (const glm::vec2 *)(data + 3 * count) + count);
+	out_normals.insert(out_normals.end(), (const glm::vec3 *)(data + 5 * count), (const glm::vec3 *)(data + 5 * count) + count);
+}
+
+bool loadOBJCache(
+	const char * cache_path,
+	std::vector<glm::vec3> & out_vertices,
+	std::vector<glm::vec2> & out_uvs,
+	std::vector<glm::vec3> & out_normals
+){
+	MappedFile file;
+	const OBJCacheHeader * header = openOBJCache(file, cache_path);
+	if (header == NULL) return false;
+	readOBJCache(header, out_vertices, out_uvs, out_normals);
+	return true;
+}
+
+bool writeOBJCache(
+	const char * cache_path,
+	const char * path,
+	const std::vector<glm::vec3> & vertices,
+	const std::vector<glm::vec2> & uvs,
+	const std::vector<glm::vec3> & normals
+){
+	static_assert(sizeof(glm::vec3) == 3 * sizeof(float) && sizeof(glm::vec2) == 2 * sizeof(float), "the cache stores tightly packed floats");
+	if (uvs.size() != vertices.size() || normals.size() != vertices.size()) return false;
+	OBJCacheHeader header = { OBJ_CACHE_MAGIC, OBJ_CACHE_VERSION, 0, 0, vertices.size() };
+	if (!getFileStamp(path, &header.sourceSize, &header.sourceTime)) return false;
+
+	// writing a temporary file first, so a concurrent load never maps a partial cache
+	std::string temporaryPath = std::string(cache_path) + ".tmp";
+	FILE * file = fopen(temporaryPath.c_str(), "wb");
+	if (file == NULL) return false;
+	size_t count = vertices.size();
+	bool complete = fwrite(&header, sizeof(header), 1, file) == 1;
+	if (count > 0) {
+		complete = complete && fwrite(&vertices[0], sizeof(glm::vec3), count, file) == count
+			&& fwrite(&uvs[0], sizeof(glm::vec2), count, file) == count
+			&& fwrite(&normals[0], sizeof(glm::vec3), count, file) == count;
+	}
+	complete = fclose(file) == 0 && complete;
+	remove(cache_path);
+	if (!complete || rename(temporaryPath.c_str(), cache_path) != 0) {
+		remove(temporaryPath.c_str());
+		return false;
+	}
+	return true;
+}
+
+// Parses the triangles of an OBJ file in memory and appends them, 'name' is used in the messages
+static bool parseOBJ(
+	const char * data,
+	size_t size,
+	const char * name,
+	std::vector<glm::vec3> & out_vertices,
+	std::vector<glm::vec2> & out_uvs,
+	std::vector<glm::vec3> & out_normals
+){
+	// chunks of whole lines, one per thread
+	const char * end = data + size;
+	size_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+	size_t chunkCount = std::max<size_t>(1, std::min(threadCount, size / MIN_CHUNK_SIZE));
+	std::vector<OBJChunk> chunks(chunkCount);
+	const char * chunkBegin = data;
+	for (size_t i = 0; i < chunkCount; i++) {
+		const char * chunkEnd = i + 1 == chunkCount ? end : std::max(chunkBegin, data + size * (i + 1) / chunkCount);
+		if (chunkEnd < end) chunkEnd = skipLine(chunkEnd, end);
+		chunks[i].begin = chunkBegin;
+		chunks[i].end = chunkEnd;
+		chunkBegin = chunkEnd;
+	}
+
+	std::vector<std::thread> threads;
+	for (size_t i = 1; i < chunkCount; i++) threads.push_back(std::thread(parseChunk, &chunks[i]));
+	parseChunk(&chunks[0]);
+	for (std::thread & thread : threads) thread.join();
+	threads.clear();
+
+	// merging the attributes in the order of the chunks
+	size_t vertexCount = 0, uvCount = 0, normalCount = 0, cornerCount = 0;
+	for (OBJChunk & chunk : chunks) {
+		if (chunk.errorLine != 0) {
+			size_t line = chunk.errorLine;
+			for (const OBJChunk * previous = &chunks[0]; previous < &chunk; previous++) line += std::count(previous->begin, previous->end, '\n');
+			fprintf(stderr, "%s, line %zu: file can't be read by our simple parser :-( Try exporting with other options\n", name, line);
+			return false;
+		}
+		chunk.vertexBase = vertexCount;
+		chunk.uvBase = uvCount;
+		chunk.normalBase = normalCount;
+		chunk.cornerBase = cornerCount;
+		vertexCount += chunk.vertices.size();
+		uvCount += chunk.uvs.size();
+		normalCount += chunk.normals.size();
+		cornerCount += chunk.corners.size();
+	}
+	std::vector<glm::vec3> vertices, normals;
+	std::vector<glm::vec2> uvs;
+	vertices.reserve(vertexCount);
+	uvs.reserve(uvCount);
+	normals.reserve(normalCount);
+	for (OBJChunk & chunk : chunks) {
+		vertices.insert(vertices.end(), chunk.vertices.begin(), chunk.vertices.end());
+		uvs.insert(uvs.end(), chunk.uvs.begin(), chunk.uvs.end());
+		normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+	}
+
+	// For each vertex of each triangle, the attributes thanks to the indices (in parallel, every chunk has it's range of the output)
+	size_t outputBase = out_vertices.size();
+	out_vertices.resize(outputBase + cornerCount);
+	out_uvs.resize(outputBase + cornerCount);
+	out_normals.resize(outputBase + cornerCount);
+	for (OBJChunk & chunk : chunks) chunk.cornerBase += outputBase;
+	std::vector<char> resolved(chunkCount, 0);
+	auto resolve = [&](size_t i) {
+		resolved[i] = resolveChunk(&chunks[i], vertices, uvs, normals, out_vertices, out_uvs, out_normals);
+	};
+	for (size_t i = 1; i < chunkCount; i++) threads.push_back(std::thread(resolve, i));
+	resolve(0);
+	for (std::thread & thread : threads) thread.join();
+	if (std::count(resolved.begin(), resolved.end(), 0) > 0) {
+		fprintf(stderr, "%s: a face refers to an attribute that doesn't exist\n", name);
+		out_vertices.resize(outputBase);
+		out_uvs.resize(outputBase);
+		out_normals.resize(outputBase);
+		return false;
+	}
+	return true;
+}
+
+bool loadOBJ(
+	const char * path, 
+	std::vector<glm::vec3> & out_vertices, 
+	std::vector<glm::vec2> & out_uvs,
+	std::vector<glm::vec3> & out_normals,
+	const char * cache_path
+){
+	printf("Loading OBJ file %s...\n", path);
+
+	// the cache is used if it was written for the same size and modification time of the file
+	uint64_t sourceSize = 0;
+	int64_t sourceTime = 0;
+	if (cache_path != NULL && getFileStamp(path, &sourceSize, &sourceTime)) {
+		MappedFile cache;
+		const OBJCacheHeader * header = openOBJCache(cache, cache_path);
+		if (header != NULL && header->sourceSize == sourceSize && header->sourceTime == sourceTime) {
+			readOBJCache(header, out_vertices, out_uvs, out_normals);
+			return true;
+		}
+	}
+
+	MappedFile file;
+	if (!file.open(path)) {
+		fprintf(stderr, "Impossible to open %s ! Are you in the right path ? See Tutorial 1 for details\n", path);
+		return false;
+	}
+	bool empty = out_vertices.empty();
+	if (!parseOBJ((const char *)file.data(), file.size(), path, out_vertices, out_uvs, out_normals)) return false;
+
+	if (cache_path != NULL && empty && !writeOBJCache(cache_path, path, out_vertices, out_uvs, out_normals)) {
+		fprintf(stderr, "Can't write the cache %s\n", cache_path);
+	}
+	return true;
+}
+
+bool loadOBJFromMemory(
+	const void * data,
+	size_t size,
+	const char * name,
+	std::vector<glm::vec3> & out_vertices,
+	std::vector<glm::vec2> & out_uvs,
+	std::vector<glm::vec3> & out_normals
+){
+	// a pre-transcoded mesh is a cache, copied instead of parsed
+	const OBJCacheHeader * header = getOBJCache(data, size);
+	if (header != NULL) {
+		readOBJCache(header, out_vertices, out_uvs, out_normals);
+		return true;
+	}
+	return parseOBJ((const char *)data, size, name, out_vertices, out_uvs, out_normals);
+}
+
+bool encodeOBJCache(
+	const std::vector<glm::vec3> & vertices,
+	const std::vector<glm::vec2> & uvs,
+	const std::vector<glm::vec3> & normals,
+	std::vector<unsigned char> & out_cache
+){
+	if (uvs.size() != vertices.size() || normals.size() != vertices.size()) return false;
+	// the cache isn't compared with a file
+	OBJCacheHeader header = { OBJ_CACHE_MAGIC, OBJ_CACHE_VERSION, 0, 0, vertices.size() };
+	size_t count = vertices.size();
+	out_cache.resize(sizeof(header) + count * 8 * sizeof(float));
+	unsigned char * data = &out_cache[0];
+	memcpy(data, &header, sizeof(header));
+	if (count > 0) {
+		memcpy(data + sizeof(header), &vertices[0], count * sizeof(glm::vec3));
+		memcpy(data + sizeof(header) + count * sizeof(glm::vec3), &uvs[0], count * sizeof(glm::vec2));
+		memcpy(data + sizeof(header) + count * (sizeof(glm::vec3) + sizeof(glm::vec2)), &normals[0], count * sizeof(glm::vec3));
 	}
-	fclose(file);
 	return true;
 }
 
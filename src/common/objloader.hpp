@@ -1,13 +1,53 @@
 #ifndef OBJLOADER_H
 #define OBJLOADER_H
 
+// Loads the triangles of an OBJ file (polygons are split into fans, missing uvs and normals are zero).
+// With a cache path the triangles are read from the binary cache if it was written for the same file,
+// otherwise the file is parsed and the cache is written.
 bool loadOBJ(
 	const char * path, 
 	std::vector<glm::vec3> & out_vertices, 
 	std::vector<glm::vec2> & out_uvs, 
+	std::vector<glm::vec3> & out_normals,
+	const char * cache_path = NULL
+);
+
+// Reads the triangles of a binary cache (.objc), written by loadOBJ or writeOBJCache
+bool loadOBJCache(
+	const char * cache_path,
+	std::vector<glm::vec3> & out_vertices,
+	std::vector<glm::vec2> & out_uvs,
 	std::vector<glm::vec3> & out_normals
 );
 
+// Writes the triangles of an OBJ file into a binary cache
+bool writeOBJCache(
+	const char * cache_path,
+	const char * path,
+	const std::vector<glm::vec3> & vertices,
+	const std::vector<glm::vec2> & uvs,
+	const std::vector<glm::vec3> & normals
+);
+
+// Loads the triangles of an OBJ file or of a binary cache in memory (e.g. an asset of an AssetPack),
+// 'name' is used in the messages
+bool loadOBJFromMemory(
+	const void * data,
+	size_t size,
+	const char * name,
+	std::vector<glm::vec3> & out_vertices,
+	std::vector<glm::vec2> & out_uvs,
+	std::vector<glm::vec3> & out_normals
+);
+
+// Encodes triangles as a binary cache in memory (that isn't tied to a file, see loadOBJFromMemory)
+bool encodeOBJCache(
+	const std::vector<glm::vec3> & vertices,
+	const std::vector<glm::vec2> & uvs,
+	const std::vector<glm::vec3> & normals,
+	std::vector<unsigned char> & out_cache
+);
+
 
 
 bool loadAssImp(
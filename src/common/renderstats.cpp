@@ -0,0 +1,119 @@
+#include <assert.h>
+#include <string.h>
+
+#include "renderstats.hpp"
+
+RenderStats::RenderStats() : m_enabled(false), m_set(0), m_openSection(SECTION_COUNT), m_frames(0), m_dropped(0) {
+	memset(m_queries, 0, sizeof(m_queries));
+	memset(m_issued, 0, sizeof(m_issued));
+	memset(m_setFrames, 0, sizeof(m_setFrames));
+	memset(&m_current, 0, sizeof(m_current));
+	memset(&m_last, 0, sizeof(m_last));
+	memset(&m_total, 0, sizeof(m_total));
+	memset(m_lastGpu, 0, sizeof(m_lastGpu));
+	memset(m_totalGpu, 0, sizeof(m_totalGpu));
+	memset(m_maxGpu, 0, sizeof(m_maxGpu));
+	memset(m_gpuSamples, 0, sizeof(m_gpuSamples));
+}
+
+RenderStats::~RenderStats() {
+	// the queries can't be deleted without a context, disable() needs to be called before the context is destroyed
+}
+
+bool RenderStats::enable() {
+	if (m_enabled) return true;
+	// GL_TIME_ELAPSED is core since OpenGL 3.3 (Mesa's llvmpipe supports it as well)
+	if (!GLEW_VERSION_3_3 && !GLEW_ARB_timer_query) {
+		fprintf(stderr, "Timer queries aren't supported, render stats are disabled\n");
+		return false;
+	}
+	glGenQueries(2 * SECTION_COUNT, &m_queries[0][0]);
+	memset(m_issued, 0, sizeof(m_issued));
+	memset(m_setFrames, 0, sizeof(m_setFrames));
+	m_frames = 0;
+	m_enabled = true;
+	return true;
+}
+
+void RenderStats::disable() {
+	if (!m_enabled) return;
+	glDeleteQueries(2 * SECTION_COUNT, &m_queries[0][0]);
+	m_enabled = false;
+}
+
+void RenderStats::readQueries(int set) {
+	for (int section = 0; section < SECTION_COUNT; section++) {
+		if (!m_issued[set][section]) continue;
+		m_issued[set][section] = false;
+		// the first frame includes the driver's setup (llvmpipe even reports an invalid time for the first query)
+		if (m_setFrames[set] == 0) continue;
+		GLint available = 0;
+		glGetQueryObjectiv(m_queries[set][section], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available) {
+			// waiting for the result would stall the pipeline, the query is reused by this frame
+			m_dropped++;
+			continue;
+		}
+		GLuint64 nanoseconds = 0;
+		glGetQueryObjectui64v(m_queries[set][section], GL_QUERY_RESULT, &nanoseconds);
+		double milliseconds = nanoseconds / 1e6;
+		m_lastGpu[section] = milliseconds;
+		m_totalGpu[section] += milliseconds;
+		if (milliseconds > m_maxGpu[section]) m_maxGpu[section] = milliseconds;
+		m_gpuSamples[section]++;
+	}
+}
+
+void RenderStats::beginFrame() {
+	memset(&m_current, 0, sizeof(m_current));
+	if (!m_enabled) return;
+	// the set of this frame was used two frames ago, it's results are most likely available
+	m_set ^= 1;
+	readQueries(m_set);
+	m_setFrames[m_set] = m_frames;
+}
+
+void RenderStats::endFrame() {
+	if (!m_enabled) return;
+	m_last = m_current;
+	m_total.glCalls += m_current.glCalls;
+	m_total.bytesUploaded += m_current.bytesUploaded;
+	m_total.vertices += m_current.vertices;
+	m_total.drawCalls += m_current.drawCalls;
+	m_total.stateChanges += m_current.stateChanges;
+	m_frames++;
+}
+
+void RenderStats::beginSection(Section section) {
+	// GL_TIME_ELAPSED queries can't be nested
+	assert(m_openSection == SECTION_COUNT);
+	if (m_openSection != SECTION_COUNT) return;
+	m_openSection = section;
+	if (!m_enabled) return;
+	glBeginQuery(GL_TIME_ELAPSED, m_queries[m_set][section]);
+	m_issued[m_set][section] = true;
+}
+
+void RenderStats::endSection(Section section) {
+	assert(m_openSection == section);
+	// a section that wasn't begun has no active query (ending it would be a GL error)
+	if (m_openSection != section) return;
+	m_openSection = SECTION_COUNT;
+	if (!m_enabled) return;
+	glEndQuery(GL_TIME_ELAPSED);
+}
+
+void RenderStats::printSummary(FILE * file) const {
+	if (m_frames == 0) return;
+	static const char * const names[SECTION_COUNT] = { "upload", "draw" };
+	double frames = (double)m_frames;
+	fprintf(file, "render stats: %llu frames\n", (unsigned long long)m_frames);
+	fprintf(file, "  per frame: %.1f GL calls, %.1f state changes, %.1f draw calls, %.1f vertices, %.1f bytes uploaded\n",
+		m_total.glCalls / frames, m_total.stateChanges / frames, m_total.drawCalls / frames, m_total.vertices / frames, m_total.bytesUploaded / frames);
+	for (int section = 0; section < SECTION_COUNT; section++) {
+		if (m_gpuSamples[section] == 0) continue;
+		fprintf(file, "  gpu %-6s %.3f ms average, %.3f ms maximum (%llu frames)\n", names[section],
+			m_totalGpu[section] / m_gpuSamples[section], m_maxGpu[section], (unsigned long long)m_gpuSamples[section]);
+	}
+	if (m_dropped > 0) fprintf(file, "  %llu query results weren't available in time\n", (unsigned long long)m_dropped);
+}
@@ -0,0 +1,88 @@
+#ifndef RENDERSTATS_HPP
+#define RENDERSTATS_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <GL/glew.h>
+
+// Per-frame render statistics: GPU time of the timed sections (GL_TIME_ELAPSED queries) and counters of the
+// GL calls, uploaded bytes, drawn vertices and state changes of a frame.
+// The queries of a frame are read two frames later, so reading them never waits for the GPU
+// (results that still aren't available are dropped). Nothing is queried or reported while the stats are disabled.
+class RenderStats {
+public:
+	// Timed sections of a frame (every section may be timed once per frame)
+	enum Section { SECTION_UPLOAD = 0, SECTION_DRAW = 1, SECTION_COUNT = 2 };
+
+	// Counters of a frame (the GPU times arrive later, see lastGpuMilliseconds)
+	struct Frame {
+		uint32_t glCalls;
+		uint64_t bytesUploaded;
+		uint64_t vertices;
+		uint32_t drawCalls;
+		uint32_t stateChanges;
+	};
+
+	RenderStats();
+	~RenderStats();
+	RenderStats(const RenderStats&) = delete;
+	RenderStats& operator=(const RenderStats&) = delete;
+
+	// Creates the queries (needs a current context), returns false if timer queries aren't supported
+	bool enable();
+	// Deletes the queries
+	void disable();
+	bool isEnabled() const { return m_enabled; }
+
+	// Starts counting a new frame and reads the queries of the frame before the previous one
+	void beginFrame();
+	// Finishes the counters of the current frame
+	void endFrame();
+
+	// Times the GL commands between begin and end (sections can't be nested, end needs the section of the last begin)
+	void beginSection(Section section);
+	void endSection(Section section);
+
+	// Counters of the current frame (a state change, upload and draw count as one GL call each)
+	void countCalls(uint32_t count) { m_current.glCalls += count; }
+	void countStateChanges(uint32_t count) { m_current.glCalls += count; m_current.stateChanges += count; }
+	void countUpload(size_t bytes) { m_current.glCalls++; m_current.bytesUploaded += bytes; }
+	void countDraw(uint32_t vertices) { m_current.glCalls++; m_current.drawCalls++; m_current.vertices += vertices; }
+	// Calls a GL function that changes state and counts it, e.g. changeState(glBindBuffer, GL_ARRAY_BUFFER, buffer)
+	template<typename Function, typename... Args> void changeState(Function function, Args... args) {
+		function(args...);
+		countStateChanges(1);
+	}
+
+	// Counters of the last finished frame
+	const Frame & lastFrame() const { return m_last; }
+	// GPU time of every section in milliseconds, of the latest frame whose query of the section was read
+	const double * lastGpuMilliseconds() const { return m_lastGpu; }
+	// Number of finished frames
+	uint64_t frameCount() const { return m_frames; }
+	// Prints the averages (and the maximum GPU times) of every frame since the stats were enabled
+	void printSummary(FILE * file) const;
+
+private:
+	bool m_enabled;
+	// two sets of queries (the frames use them alternately) and the sections that were timed with them
+	GLuint m_queries[2][SECTION_COUNT];
+	bool m_issued[2][SECTION_COUNT];
+	// index of the frame that used the set last
+	uint64_t m_setFrames[2];
+	int m_set;
+	// section that was begun but not ended yet (SECTION_COUNT if there is none)
+	Section m_openSection;
+
+	Frame m_current, m_last, m_total;
+	double m_lastGpu[SECTION_COUNT], m_totalGpu[SECTION_COUNT];
+	double m_maxGpu[SECTION_COUNT];
+	uint64_t m_gpuSamples[SECTION_COUNT];
+	uint64_t m_frames, m_dropped;
+
+	// reads the results of a set of queries (skipped if a result isn't available yet)
+	void readQueries(int set);
+};
+
+#endif
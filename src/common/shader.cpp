@@ -8,103 +8,215 @@ using namespace std;
 
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#endif
 
 #include <GL/glew.h>
 
 #include "shader.hpp"
 
-GLuint LoadShaders(const char * vertex_file_path,const char * fragment_file_path){
+// Directory of the program binary cache (NULL disables the cache)
+static const char * ShaderCacheDirectory = "shadercache";
+
+// Header of a cached program binary, followed by 'Length' bytes of the binary
+struct ProgramBinaryHeader {
+	uint32_t Magic;
+	uint32_t Format;
+	uint64_t Key;
+	uint32_t Length;
+	uint32_t Reserved;
+};
+// identification of a cache file ("GLPB")
+static const uint32_t PROGRAM_BINARY_MAGIC = 0x42504c47;
+
+void SetShaderCacheDirectory(const char * directory){
+	ShaderCacheDirectory = directory;
+}
 
-	// Create the shaders
-	GLuint VertexShaderID = glCreateShader(GL_VERTEX_SHADER);
-	GLuint FragmentShaderID = glCreateShader(GL_FRAGMENT_SHADER);
-
-	// Read the Vertex Shader code from the file
-	std::string VertexShaderCode;
-	std::ifstream VertexShaderStream(vertex_file_path, std::ios::in);
-	if(VertexShaderStream.is_open()){
-		std::string Line = "";
-		while(getline(VertexShaderStream, Line))
-			VertexShaderCode += "\n" + Line;
-		VertexShaderStream.close();
-	}else{
-		printf("Impossible to open %s. Are you in the right directory ? Don't forget to read the FAQ !\n", vertex_file_path);
-		getchar();
-		return 0;
-	}
+// 64 bit FNV-1a hash of a string (continued from 'Hash', including the terminating zero as separator)
+static uint64_t HashString(uint64_t Hash, const char * String){
+	if (String == NULL) String = "";
+	do {
+		Hash ^= (unsigned char)*String;
+		Hash *= 0x100000001b3ull;
+	} while (*String++);
+	return Hash;
+}
 
-	// Read the Fragment Shader code from the file
-	std::string FragmentShaderCode;
-	std::ifstream FragmentShaderStream(fragment_file_path, std::ios::in);
-	if(FragmentShaderStream.is_open()){
-		std::string Line = "";
-		while(getline(FragmentShaderStream, Line))
-			FragmentShaderCode += "\n" + Line;
-		FragmentShaderStream.close();
-	}
+// Key of a program: the sources and the driver (a binary is only valid for the driver that created it)
+static uint64_t GetProgramKey(const char * VertexSource, const char * FragmentSource){
+	uint64_t Key = 0xcbf29ce484222325ull;
+	Key = HashString(Key, VertexSource);
+	Key = HashString(Key, FragmentSource);
+	Key = HashString(Key, (const char *)glGetString(GL_VENDOR));
+	Key = HashString(Key, (const char *)glGetString(GL_RENDERER));
+	Key = HashString(Key, (const char *)glGetString(GL_VERSION));
+	return Key;
+}
 
-	GLint Result = GL_FALSE;
-	int InfoLogLength;
+// Program binaries are supported if the driver provides at least one binary format
+static bool IsProgramBinarySupported(){
+	if (ShaderCacheDirectory == NULL || !(GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary)) return false;
+	GLint Formats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &Formats);
+	return Formats > 0;
+}
 
+static std::string GetProgramCachePath(uint64_t Key){
+	char Name[32];
+	snprintf(Name, sizeof(Name), "/%016llx.glprogram", (unsigned long long)Key);
+	return std::string(ShaderCacheDirectory) + Name;
+}
 
-	// Compile Vertex Shader
-	printf("Compiling shader : %s\n", vertex_file_path);
-	char const * VertexSourcePointer = VertexShaderCode.c_str();
-	glShaderSource(VertexShaderID, 1, &VertexSourcePointer , NULL);
-	glCompileShader(VertexShaderID);
+// Creates a program from the cached binary, returns 0 if there's no valid binary for the key
+static GLuint LoadProgramBinary(uint64_t Key){
+	FILE * File = fopen(GetProgramCachePath(Key).c_str(), "rb");
+	if (File == NULL) return 0;
+	ProgramBinaryHeader Header;
+	std::vector<char> Binary;
+	bool Valid = fread(&Header, sizeof(Header), 1, File) == 1 && Header.Magic == PROGRAM_BINARY_MAGIC && Header.Key == Key;
+	if (Valid) {
+		Binary.resize(Header.Length);
+		Valid = Header.Length > 0 && fread(&Binary[0], 1, Header.Length, File) == Header.Length;
+	}
+	fclose(File);
+	if (!Valid) return 0;
 
-	// Check Vertex Shader
-	glGetShaderiv(VertexShaderID, GL_COMPILE_STATUS, &Result);
-	glGetShaderiv(VertexShaderID, GL_INFO_LOG_LENGTH, &InfoLogLength);
-	if ( InfoLogLength > 0 ){
-		std::vector<char> VertexShaderErrorMessage(InfoLogLength+1);
-		glGetShaderInfoLog(VertexShaderID, InfoLogLength, NULL, &VertexShaderErrorMessage[0]);
-		printf("%s\n", &VertexShaderErrorMessage[0]);
+	// the driver may reject the binary (e.g. after an update without a version change), the program is compiled again then
+	GLuint ProgramID = glCreateProgram();
+	glProgramBinary(ProgramID, Header.Format, &Binary[0], Header.Length);
+	GLint Result = GL_FALSE;
+	glGetProgramiv(ProgramID, GL_LINK_STATUS, &Result);
+	if (Result != GL_TRUE) {
+		glDeleteProgram(ProgramID);
+		return 0;
 	}
+	return ProgramID;
+}
 
+// Writes the binary of a linked program to the cache
+static void SaveProgramBinary(GLuint ProgramID, uint64_t Key){
+	GLint Length = 0;
+	glGetProgramiv(ProgramID, GL_PROGRAM_BINARY_LENGTH, &Length);
+	if (Length <= 0) return;
+	std::vector<char> Binary(Length);
+	ProgramBinaryHeader Header = { PROGRAM_BINARY_MAGIC, 0, Key, 0, 0 };
+	GLenum Format = 0;
+	GLsizei Written = 0;
+	glGetProgramBinary(ProgramID, Length, &Written, &Format, &Binary[0]);
+	if (Written <= 0) return;
+	Header.Format = Format;
+	Header.Length = (uint32_t)Written;
+
+#ifdef _WIN32
+	_mkdir(ShaderCacheDirectory);
+#else
+	mkdir(ShaderCacheDirectory, 0755);
+#endif
+	// writing a temporary file first, so a concurrent start never reads a partial binary
+	std::string Path = GetProgramCachePath(Key), TemporaryPath = Path + ".tmp";
+	FILE * File = fopen(TemporaryPath.c_str(), "wb");
+	if (File == NULL) return;
+	bool Complete = fwrite(&Header, sizeof(Header), 1, File) == 1 && fwrite(&Binary[0], 1, Header.Length, File) == Header.Length;
+	Complete = fclose(File) == 0 && Complete;
+	remove(Path.c_str());
+	if (!Complete || rename(TemporaryPath.c_str(), Path.c_str()) != 0) remove(TemporaryPath.c_str());
+}
 
+// Reads a whole shader file at once, returns false if it can't be opened
+static bool ReadShaderFile(const char * file_path, std::string & Code){
+	std::ifstream Stream(file_path, std::ios::in | std::ios::binary);
+	if(!Stream.is_open()){
+		fprintf(stderr, "Impossible to open %s. Are you in the right directory ? Don't forget to read the FAQ !\n", file_path);
+		return false;
+	}
+	Stream.seekg(0, std::ios::end);
+	Code.resize((size_t)Stream.tellg());
+	Stream.seekg(0, std::ios::beg);
+	if (!Code.empty()) Stream.read(&Code[0], Code.size());
+	return true;
+}
 
-	// Compile Fragment Shader
-	printf("Compiling shader : %s\n", fragment_file_path);
-	char const * FragmentSourcePointer = FragmentShaderCode.c_str();
-	glShaderSource(FragmentShaderID, 1, &FragmentSourcePointer , NULL);
-	glCompileShader(FragmentShaderID);
+// Compiles a shader, prints it's info log, returns 0 if the shader doesn't compile
+static GLuint CompileShader(GLenum Type, const char * Source, const char * Name){
+	GLuint ShaderID = glCreateShader(Type);
+	glShaderSource(ShaderID, 1, &Source , NULL);
+	glCompileShader(ShaderID);
 
-	// Check Fragment Shader
-	glGetShaderiv(FragmentShaderID, GL_COMPILE_STATUS, &Result);
-	glGetShaderiv(FragmentShaderID, GL_INFO_LOG_LENGTH, &InfoLogLength);
-	if ( InfoLogLength > 0 ){
-		std::vector<char> FragmentShaderErrorMessage(InfoLogLength+1);
-		glGetShaderInfoLog(FragmentShaderID, InfoLogLength, NULL, &FragmentShaderErrorMessage[0]);
-		printf("%s\n", &FragmentShaderErrorMessage[0]);
+	GLint Result = GL_FALSE;
+	int InfoLogLength;
+	glGetShaderiv(ShaderID, GL_COMPILE_STATUS, &Result);
+	glGetShaderiv(ShaderID, GL_INFO_LOG_LENGTH, &InfoLogLength);
+	if ( InfoLogLength > 1 ){
+		std::vector<char> ShaderErrorMessage(InfoLogLength+1);
+		glGetShaderInfoLog(ShaderID, InfoLogLength, NULL, &ShaderErrorMessage[0]);
+		fprintf(stderr, "%s:\n%s\n", Name, &ShaderErrorMessage[0]);
 	}
+	if (Result != GL_TRUE) {
+		glDeleteShader(ShaderID);
+		return 0;
+	}
+	return ShaderID;
+}
 
+GLuint LoadShadersFromSource(const char * VertexSource, const char * FragmentSource, const char * VertexName, const char * FragmentName){
+	const bool Cached = IsProgramBinarySupported();
+	uint64_t Key = 0;
+	if (Cached) {
+		Key = GetProgramKey(VertexSource, FragmentSource);
+		GLuint ProgramID = LoadProgramBinary(Key);
+		if (ProgramID != 0) return ProgramID;
+	}
 
+	// Compile the shaders
+	GLuint VertexShaderID = CompileShader(GL_VERTEX_SHADER, VertexSource, VertexName);
+	GLuint FragmentShaderID = CompileShader(GL_FRAGMENT_SHADER, FragmentSource, FragmentName);
+	if (VertexShaderID == 0 || FragmentShaderID == 0) {
+		glDeleteShader(VertexShaderID);
+		glDeleteShader(FragmentShaderID);
+		return 0;
+	}
 
 	// Link the program
-	printf("Linking program\n");
 	GLuint ProgramID = glCreateProgram();
+	if (Cached) glProgramParameteri(ProgramID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 	glAttachShader(ProgramID, VertexShaderID);
 	glAttachShader(ProgramID, FragmentShaderID);
 	glLinkProgram(ProgramID);
 
 	// Check the program
+	GLint Result = GL_FALSE;
+	int InfoLogLength;
 	glGetProgramiv(ProgramID, GL_LINK_STATUS, &Result);
 	glGetProgramiv(ProgramID, GL_INFO_LOG_LENGTH, &InfoLogLength);
-	if ( InfoLogLength > 0 ){
+	if ( InfoLogLength > 1 ){
 		std::vector<char> ProgramErrorMessage(InfoLogLength+1);
 		glGetProgramInfoLog(ProgramID, InfoLogLength, NULL, &ProgramErrorMessage[0]);
-		printf("%s\n", &ProgramErrorMessage[0]);
+		fprintf(stderr, "%s, %s:\n%s\n", VertexName, FragmentName, &ProgramErrorMessage[0]);
 	}
 
-	
 	glDetachShader(ProgramID, VertexShaderID);
 	glDetachShader(ProgramID, FragmentShaderID);
-	
+
 	glDeleteShader(VertexShaderID);
 	glDeleteShader(FragmentShaderID);
 
+	if (Result != GL_TRUE) {
+		glDeleteProgram(ProgramID);
+		return 0;
+	}
+	if (Cached) SaveProgramBinary(ProgramID, Key);
 	return ProgramID;
 }
 
+GLuint LoadShaders(const char * vertex_file_path,const char * fragment_file_path){
+
+	// Read the shader code from the files
+	std::string VertexShaderCode, FragmentShaderCode;
+	if (!ReadShaderFile(vertex_file_path, VertexShaderCode) || !ReadShaderFile(fragment_file_path, FragmentShaderCode)) return 0;
 
+	return LoadShadersFromSource(VertexShaderCode.c_str(), FragmentShaderCode.c_str(), vertex_file_path, fragment_file_path);
+}
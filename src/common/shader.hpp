@@ -1,6 +1,16 @@
 #ifndef SHADER_HPP
 #define SHADER_HPP
 
+// Compiles and links the shaders of the files, returns 0 if a file can't be read or the program doesn't link.
+// Linked programs are stored in the program binary cache (if the driver supports program binaries), the next call
+// with the same sources on the same driver loads the binary instead of compiling.
 GLuint LoadShaders(const char * vertex_file_path,const char * fragment_file_path);
 
+// Compiles and links the shaders of the sources (e.g. embedded by embed_shaders, see cmake/EmbedShaders.cmake) like LoadShaders,
+// the names are only used in the messages of compile errors
+GLuint LoadShadersFromSource(const char * vertex_source, const char * fragment_source, const char * vertex_name = "vertex shader", const char * fragment_name = "fragment shader");
+
+// Sets the directory of the program binary cache ("shadercache" by default, NULL disables the cache)
+void SetShaderCacheDirectory(const char * directory);
+
 #endif
@@ -0,0 +1,185 @@
+#include <stdio.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "shaderreloader.hpp"
+#include "shader.hpp"
+
+// GL_KHR_parallel_shader_compile (not part of GLEW 1.13)
+typedef void (APIENTRY * MaxShaderCompilerThreadsProc)(GLuint count);
+
+// Directory and name of a file path
+static void SplitPath(const std::string & path, std::string * directory, std::string * name) {
+	size_t separator = path.find_last_of("/\\");
+	*directory = separator == std::string::npos ? "." : path.substr(0, separator);
+	*name = separator == std::string::npos ? path : path.substr(separator + 1);
+}
+
+ShaderReloader::ShaderReloader() : m_context(NULL), m_running(false), m_notify(-1) {
+}
+
+ShaderReloader::~ShaderReloader() {
+	// the programs and the context can't be deleted without the window's context, stop() needs to be called before
+	m_running = false;
+	if (m_thread.joinable()) m_thread.join();
+#ifdef __linux__
+	if (m_notify >= 0) close(m_notify);
+#endif
+}
+
+int ShaderReloader::watch(const char * vertex_file_path, const char * fragment_file_path) {
+	Slot slot;
+	slot.vertexPath = vertex_file_path;
+	slot.fragmentPath = fragment_file_path;
+	slot.program = 0;
+	slot.fence = NULL;
+	m_slots.push_back(slot);
+	return (int)m_slots.size() - 1;
+}
+
+bool ShaderReloader::start(GLFWwindow * window) {
+#ifdef __linux__
+	if (m_running) return true;
+	m_notify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (m_notify < 0) {
+		perror("inotify_init1");
+		return false;
+	}
+	// watching the directories (editors often replace a file instead of writing it)
+	for (const Slot & slot : m_slots) {
+		const std::string * paths[2] = { &slot.vertexPath, &slot.fragmentPath };
+		for (const std::string * path : paths) {
+			std::string directory, name;
+			SplitPath(*path, &directory, &name);
+			if (inotify_add_watch(m_notify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0) {
+				fprintf(stderr, "Can't watch %s, shaders aren't reloaded\n", directory.c_str());
+				close(m_notify);
+				m_notify = -1;
+				return false;
+			}
+		}
+	}
+
+	// hidden context sharing the window's objects (created with the window's hints)
+	glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+	m_context = glfwCreateWindow(1, 1, "shader reloader", NULL, window);
+	glfwWindowHint(GLFW_VISIBLE, GL_TRUE);
+	if (m_context == NULL) {
+		fprintf(stderr, "Failed to create the shared context, shaders aren't reloaded\n");
+		close(m_notify);
+		m_notify = -1;
+		return false;
+	}
+
+	m_running = true;
+	m_thread = std::thread(&ShaderReloader::run, this);
+	return true;
+#else
+	(void)window;
+	return false;
+#endif
+}
+
+void ShaderReloader::stop() {
+	if (m_thread.joinable()) {
+		m_running = false;
+		m_thread.join();
+	}
+#ifdef __linux__
+	if (m_notify >= 0) close(m_notify);
+	m_notify = -1;
+#endif
+	// the objects are shared, they are deleted with the caller's context
+	for (Slot & slot : m_slots) {
+		if (slot.program != 0) glDeleteProgram(slot.program);
+		if (slot.fence != NULL) glDeleteSync(slot.fence);
+		slot.program = 0;
+		slot.fence = NULL;
+	}
+	if (m_context != NULL) glfwDestroyWindow(m_context);
+	m_context = NULL;
+}
+
+bool ShaderReloader::take(int slot, GLuint * program) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	Slot & s = m_slots[slot];
+	if (s.program == 0) return false;
+	// the program is used as soon as the shared context finished it's commands (checked without waiting)
+	if (glClientWaitSync(s.fence, 0, 0) == GL_TIMEOUT_EXPIRED) return false;
+	glDeleteSync(s.fence);
+	*program = s.program;
+	s.program = 0;
+	s.fence = NULL;
+	return true;
+}
+
+void ShaderReloader::run() {
+#ifdef __linux__
+	glfwMakeContextCurrent(m_context);
+	// letting the driver compile with multiple threads (if supported)
+	if (glfwExtensionSupported("GL_KHR_parallel_shader_compile")) {
+		MaxShaderCompilerThreadsProc maxShaderCompilerThreads = (MaxShaderCompilerThreadsProc)glfwGetProcAddress("glMaxShaderCompilerThreadsKHR");
+		if (maxShaderCompilerThreads != NULL) maxShaderCompilerThreads(0xFFFFFFFF);
+	}
+
+	std::vector<bool> changed(m_slots.size(), false);
+	bool pending = false;
+	alignas(struct inotify_event) char buffer[4096];
+	while (m_running) {
+		// polling with a timeout to notice stop(), a pending change is compiled after 50 ms without further events
+		pollfd descriptor = { m_notify, POLLIN, 0 };
+		int ready = poll(&descriptor, 1, pending ? 50 : 100);
+		if (ready <= 0) {
+			if (pending) reload(changed);
+			pending = false;
+			changed.assign(m_slots.size(), false);
+			continue;
+		}
+		ssize_t length;
+		while ((length = read(m_notify, buffer, sizeof(buffer))) > 0) {
+			for (char * position = buffer; position < buffer + length;) {
+				const inotify_event * event = (const inotify_event *)position;
+				position += sizeof(inotify_event) + event->len;
+				if (event->len == 0) continue;
+				for (size_t i = 0; i < m_slots.size(); i++) {
+					const std::string * paths[2] = { &m_slots[i].vertexPath, &m_slots[i].fragmentPath };
+					for (const std::string * path : paths) {
+						std::string directory, name;
+						SplitPath(*path, &directory, &name);
+						if (name == event->name) {
+							changed[i] = true;
+							pending = true;
+						}
+					}
+				}
+			}
+		}
+	}
+	glfwMakeContextCurrent(NULL);
+#endif
+}
+
+void ShaderReloader::reload(const std::vector<bool> & changed) {
+	for (size_t i = 0; i < m_slots.size(); i++) {
+		if (!changed[i]) continue;
+		printf("Reloading %s, %s\n", m_slots[i].vertexPath.c_str(), m_slots[i].fragmentPath.c_str());
+		GLuint program = LoadShaders(m_slots[i].vertexPath.c_str(), m_slots[i].fragmentPath.c_str());
+		// the previous program is kept if the new one doesn't compile (the errors are printed by LoadShaders)
+		if (program == 0) continue;
+		GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		glFlush();
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		Slot & slot = m_slots[i];
+		// a program that wasn't taken yet is replaced
+		if (slot.program != 0) glDeleteProgram(slot.program);
+		if (slot.fence != NULL) glDeleteSync(slot.fence);
+		slot.program = program;
+		slot.fence = fence;
+	}
+}
@@ -0,0 +1,55 @@
+#ifndef SHADERRELOADER_HPP
+#define SHADERRELOADER_HPP
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <GL/glew.h>
+#include <glfw3.h>
+
+// Hot reload of shader programs: a watcher thread waits for changes of the shader files (inotify, linux only),
+// compiles and links the changed programs in a hidden context that shares it's objects with the window's context,
+// and hands the new programs to the main thread. Compiling never blocks the main thread, a program that doesn't
+// compile keeps the previous program (the info log is printed by LoadShadersFromSource).
+class ShaderReloader {
+public:
+	ShaderReloader();
+	~ShaderReloader();
+	ShaderReloader(const ShaderReloader&) = delete;
+	ShaderReloader& operator=(const ShaderReloader&) = delete;
+
+	// Watches the files of a program (before start), returns the program's slot
+	int watch(const char * vertex_file_path, const char * fragment_file_path);
+	// Creates the shared context (on the main thread, the window's hints need to be set) and starts the watcher,
+	// returns false if watching files isn't supported
+	bool start(GLFWwindow * window);
+	// Stops the watcher and destroys the shared context (programs that weren't taken are deleted)
+	void stop();
+
+	// Takes the newest program of a slot if it's ready to be used by the main thread (call it between frames),
+	// the caller owns the program (and deletes the previous one)
+	bool take(int slot, GLuint * program);
+
+private:
+	struct Slot {
+		std::string vertexPath, fragmentPath;
+		// the newest linked program, not taken yet (0 if there's none) and the fence of it's commands
+		GLuint program;
+		GLsync fence;
+	};
+	std::vector<Slot> m_slots;
+	std::mutex m_mutex;
+	GLFWwindow * m_context;
+	std::thread m_thread;
+	std::atomic<bool> m_running;
+	int m_notify;
+
+	// the watcher thread
+	void run();
+	// compiles the programs of the slots whose files changed
+	void reload(const std::vector<bool> & changed);
+};
+
+#endif
@@ -1,73 +1,276 @@
 #include <vector>
+#include <thread>
+#include <algorithm>
+#include <math.h>
 #include <glm/glm.hpp>
 
 #include "tangentspace.hpp"
 
-void computeTangentBasis(
-	// inputs
-	std::vector<glm::vec3> & vertices,
-	std::vector<glm::vec2> & uvs,
-	std::vector<glm::vec3> & normals,
-	// outputs
-	std::vector<glm::vec3> & tangents,
-	std::vector<glm::vec3> & bitangents
-){
+// Four triangles (and four vertices) are processed at once with SSE if it's available (always on x86-64), scalar otherwise
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define TANGENTS_SSE
+#endif
 
-	for (unsigned int i=0; i<vertices.size(); i+=3 ){
+// Minimum number of triangles (or vertices) per thread, smaller meshes are processed by the calling thread
+static const size_t MIN_ITEMS_PER_THREAD = 1 << 15;
+
+static size_t GetThreadCount(size_t count){
+	size_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+	return std::max<size_t>(1, std::min(threadCount, count / MIN_ITEMS_PER_THREAD));
+}
+
+// Runs function(thread, begin, end) on 'threadCount' ranges of [0, count), the first range on the calling thread
+template<class Function> static void ParallelFor(size_t count, size_t threadCount, const Function & function){
+	std::vector<std::thread> threads;
+	for (size_t i = 1; i < threadCount; i++) {
+		threads.push_back(std::thread(function, i, count * i / threadCount, count * (i + 1) / threadCount));
+	}
+	function((size_t)0, (size_t)0, count / threadCount);
+	for (size_t i = 0; i < threads.size(); i++) threads[i].join();
+}
 
-		// Shortcuts for vertices
-		glm::vec3 & v0 = vertices[i+0];
-		glm::vec3 & v1 = vertices[i+1];
-		glm::vec3 & v2 = vertices[i+2];
+// Four values of four triangles or vertices (an SSE register, or an array without SSE)
+#ifdef TANGENTS_SSE
+typedef __m128 Lanes;
+static inline Lanes Set(float a, float b, float c, float d){ return _mm_setr_ps(a, b, c, d); }
+static inline Lanes Add(Lanes a, Lanes b){ return _mm_add_ps(a, b); }
+static inline Lanes Sub(Lanes a, Lanes b){ return _mm_sub_ps(a, b); }
+static inline Lanes Mul(Lanes a, Lanes b){ return _mm_mul_ps(a, b); }
+// 1 / a (exact, like glm)
+static inline Lanes Inverse(Lanes a){ return _mm_div_ps(_mm_set1_ps(1.0f), a); }
+static inline Lanes Sqrt(Lanes a){ return _mm_sqrt_ps(a); }
+// a with the sign flipped where s < 0
+static inline Lanes FlipWhereNegative(Lanes a, Lanes s){ return _mm_xor_ps(a, _mm_and_ps(_mm_cmplt_ps(s, _mm_setzero_ps()), _mm_set1_ps(-0.0f))); }
+static inline float Get(Lanes a, int lane){ alignas(16) float values[4]; _mm_store_ps(values, a); return values[lane]; }
+static inline void Store(Lanes a, float * values){ _mm_store_ps(values, a); }
+#else
+struct Lanes { float v[4]; };
+static inline Lanes Set(float a, float b, float c, float d){ Lanes r = { { a, b, c, d } }; return r; }
+#define TANGENTS_LANEWISE(name, expression) \
+	static inline Lanes name(Lanes a, Lanes b){ Lanes r; for (int i = 0; i < 4; i++) r.v[i] = expression; return r; }
+TANGENTS_LANEWISE(Add, a.v[i] + b.v[i])
+TANGENTS_LANEWISE(Sub, a.v[i] - b.v[i])
+TANGENTS_LANEWISE(Mul, a.v[i] * b.v[i])
+TANGENTS_LANEWISE(FlipWhereNegative, b.v[i] < 0.0f ? -a.v[i] : a.v[i])
+#undef TANGENTS_LANEWISE
+static inline Lanes Inverse(Lanes a){ Lanes r; for (int i = 0; i < 4; i++) r.v[i] = 1.0f / a.v[i]; return r; }
+static inline Lanes Sqrt(Lanes a){ Lanes r; for (int i = 0; i < 4; i++) r.v[i] = sqrtf(a.v[i]); return r; }
+static inline float Get(Lanes a, int lane){ return a.v[lane]; }
+static inline void Store(Lanes a, float * values){ for (int i = 0; i < 4; i++) values[i] = a.v[i]; }
+#endif
 
-		// Shortcuts for UVs
-		glm::vec2 & uv0 = uvs[i+0];
-		glm::vec2 & uv1 = uvs[i+1];
-		glm::vec2 & uv2 = uvs[i+2];
+// Three components of four vectors
+struct Vec3Lanes {
+	Lanes x, y, z;
+};
 
-		// Edges of the triangle : postion delta
-		glm::vec3 deltaPos1 = v1-v0;
-		glm::vec3 deltaPos2 = v2-v0;
+static inline Vec3Lanes Gather(const glm::vec3 * values, const size_t index[4]){
+	Vec3Lanes r;
+	r.x = Set(values[index[0]].x, values[index[1]].x, values[index[2]].x, values[index[3]].x);
+	r.y = Set(values[index[0]].y, values[index[1]].y, values[index[2]].y, values[index[3]].y);
+	r.z = Set(values[index[0]].z, values[index[1]].z, values[index[2]].z, values[index[3]].z);
+	return r;
+}
 
-		// UV delta
-		glm::vec2 deltaUV1 = uv1-uv0;
-		glm::vec2 deltaUV2 = uv2-uv0;
+static inline glm::vec3 GetVector(const Vec3Lanes & v, int lane){
+	return glm::vec3(Get(v.x, lane), Get(v.y, lane), Get(v.z, lane));
+}
 
-		float r = 1.0f / (deltaUV1.x * deltaUV2.y - deltaUV1.y * deltaUV2.x);
-		glm::vec3 tangent = (deltaPos1 * deltaUV2.y   - deltaPos2 * deltaUV1.y)*r;
-		glm::vec3 bitangent = (deltaPos2 * deltaUV1.x   - deltaPos1 * deltaUV2.x)*r;
+// Stores the vectors of the first 'count' lanes
+static inline void Scatter(const Vec3Lanes & v, glm::vec3 * values, const size_t index[4], size_t count){
+	alignas(16) float x[4], y[4], z[4];
+	Store(v.x, x);
+	Store(v.y, y);
+	Store(v.z, z);
+	for (size_t lane = 0; lane < count; lane++) values[index[lane]] = glm::vec3(x[lane], y[lane], z[lane]);
+}
 
-		// Set the same tangent for all three vertices of the triangle.
-		// They will be merged later, in vboindexer.cpp
-		tangents.push_back(tangent);
-		tangents.push_back(tangent);
-		tangents.push_back(tangent);
+// Tangents and bitangents of four triangles, corners[corner][lane] are the vertices of the triangles
+static inline void ComputeTriangleBatch(
+	const glm::vec3 * vertices, const glm::vec2 * uvs, const size_t corners[3][4], Vec3Lanes & tangent, Vec3Lanes & bitangent
+){
+	const Vec3Lanes v0 = Gather(vertices, corners[0]), v1 = Gather(vertices, corners[1]), v2 = Gather(vertices, corners[2]);
+	const glm::vec2 * uv0[4] = { &uvs[corners[0][0]], &uvs[corners[0][1]], &uvs[corners[0][2]], &uvs[corners[0][3]] };
+	const glm::vec2 * uv1[4] = { &uvs[corners[1][0]], &uvs[corners[1][1]], &uvs[corners[1][2]], &uvs[corners[1][3]] };
+	const glm::vec2 * uv2[4] = { &uvs[corners[2][0]], &uvs[corners[2][1]], &uvs[corners[2][2]], &uvs[corners[2][3]] };
 
-		// Same thing for binormals
-		bitangents.push_back(bitangent);
-		bitangents.push_back(bitangent);
-		bitangents.push_back(bitangent);
+	// UV delta
+	const Lanes deltaUV1x = Sub(Set(uv1[0]->x, uv1[1]->x, uv1[2]->x, uv1[3]->x), Set(uv0[0]->x, uv0[1]->x, uv0[2]->x, uv0[3]->x));
+	const Lanes deltaUV1y = Sub(Set(uv1[0]->y, uv1[1]->y, uv1[2]->y, uv1[3]->y), Set(uv0[0]->y, uv0[1]->y, uv0[2]->y, uv0[3]->y));
+	const Lanes deltaUV2x = Sub(Set(uv2[0]->x, uv2[1]->x, uv2[2]->x, uv2[3]->x), Set(uv0[0]->x, uv0[1]->x, uv0[2]->x, uv0[3]->x));
+	const Lanes deltaUV2y = Sub(Set(uv2[0]->y, uv2[1]->y, uv2[2]->y, uv2[3]->y), Set(uv0[0]->y, uv0[1]->y, uv0[2]->y, uv0[3]->y));
+	const Lanes r = Inverse(Sub(Mul(deltaUV1x, deltaUV2y), Mul(deltaUV1y, deltaUV2x)));
 
+	// Edges of the triangle : postion delta
+	const Lanes * p0 = &v0.x, * p1 = &v1.x, * p2 = &v2.x;
+	Lanes * t = &tangent.x, * b = &bitangent.x;
+	for (int k = 0; k < 3; k++) {
+		const Lanes deltaPos1 = Sub(p1[k], p0[k]);
+		const Lanes deltaPos2 = Sub(p2[k], p0[k]);
+		t[k] = Mul(Sub(Mul(deltaPos1, deltaUV2y), Mul(deltaPos2, deltaUV1y)), r);
+		b[k] = Mul(Sub(Mul(deltaPos2, deltaUV1x), Mul(deltaPos1, deltaUV2x)), r);
 	}
+}
 
-	// See "Going Further"
-	for (unsigned int i=0; i<vertices.size(); i+=1 )
-	{
-		glm::vec3 & n = normals[i];
-		glm::vec3 & t = tangents[i];
-		glm::vec3 & b = bitangents[i];
-		
-		// Gram-Schmidt orthogonalize
-		t = glm::normalize(t - n * glm::dot(n, t));
-		
-		// Calculate handedness
-		if (glm::dot(glm::cross(n, t), b) < 0.0f){
-			t = t * -1.0f;
-		}
+// Gram-Schmidt orthogonalizes and normalizes four tangents and flips them to the bitangent's handedness (See "Going Further"),
+// the operations are the ones of glm (normalize multiplies with the exact inverse square root)
+static inline Vec3Lanes OrthogonalizeBatch(const Vec3Lanes & n, const Vec3Lanes & tangent, const Vec3Lanes & b){
+	// t - n * dot(n, t)
+	const Lanes nt = Add(Add(Mul(n.x, tangent.x), Mul(n.y, tangent.y)), Mul(n.z, tangent.z));
+	Vec3Lanes t = { Sub(tangent.x, Mul(n.x, nt)), Sub(tangent.y, Mul(n.y, nt)), Sub(tangent.z, Mul(n.z, nt)) };
+	const Lanes inverseLength = Inverse(Sqrt(Add(Add(Mul(t.x, t.x), Mul(t.y, t.y)), Mul(t.z, t.z))));
+	t.x = Mul(t.x, inverseLength);
+	t.y = Mul(t.y, inverseLength);
+	t.z = Mul(t.z, inverseLength);
+	// Calculate handedness: the sign of dot(cross(n, t), b) is applied to t
+	const Lanes cx = Sub(Mul(n.y, t.z), Mul(t.y, n.z));
+	const Lanes cy = Sub(Mul(n.z, t.x), Mul(t.z, n.x));
+	const Lanes cz = Sub(Mul(n.x, t.y), Mul(t.x, n.y));
+	const Lanes handedness = Add(Add(Mul(cx, b.x), Mul(cy, b.y)), Mul(cz, b.z));
+	t.x = FlipWhereNegative(t.x, handedness);
+	t.y = FlipWhereNegative(t.y, handedness);
+	t.z = FlipWhereNegative(t.z, handedness);
+	return t;
+}
 
+// Orthogonalizes the tangents of the vertices [begin, end)
+static void OrthogonalizeTangents(const glm::vec3 * normals, glm::vec3 * tangents, const glm::vec3 * bitangents, size_t begin, size_t end){
+	for (size_t first = begin; first < end; first += 4) {
+		// a missing vertex repeats the last one
+		size_t count = std::min<size_t>(4, end - first);
+		size_t index[4];
+		for (size_t lane = 0; lane < 4; lane++) index[lane] = first + std::min<size_t>(lane, count - 1);
+		Scatter(OrthogonalizeBatch(Gather(normals, index), Gather(tangents, index), Gather(bitangents, index)), tangents, index, count);
 	}
+}
 
+void computeTangentBasis(
+	const glm::vec3 * vertices,
+	const glm::vec2 * uvs,
+	const glm::vec3 * normals,
+	size_t vertex_count,
+	glm::vec3 * tangents,
+	glm::vec3 * bitangents
+){
+	// the threads process separate triangles, so they write separate vertices
+	const size_t triangleCount = vertex_count / 3;
+	ParallelFor(triangleCount, GetThreadCount(triangleCount), [=](size_t, size_t begin, size_t end){
+		for (size_t triangle = begin; triangle < end; triangle += 4) {
+			// a missing triangle repeats the last one
+			size_t count = std::min<size_t>(4, end - triangle);
+			size_t corners[3][4];
+			for (size_t lane = 0; lane < 4; lane++) {
+				size_t first = 3 * (triangle + std::min<size_t>(lane, count - 1));
+				corners[0][lane] = first;
+				corners[1][lane] = first + 1;
+				corners[2][lane] = first + 2;
+			}
+			Vec3Lanes tangent, bitangent;
+			ComputeTriangleBatch(vertices, uvs, corners, tangent, bitangent);
+			// Set the same tangent for all three vertices of the triangle (They will be merged later, in vboindexer.cpp),
+			// the tangents of every corner are orthogonalized to the corner's normal right away
+			for (int corner = 0; corner < 3; corner++) {
+				Scatter(OrthogonalizeBatch(Gather(normals, corners[corner]), tangent, bitangent), tangents, corners[corner], count);
+				Scatter(bitangent, bitangents, corners[corner], count);
+			}
+		}
+	});
+}
 
+void computeTangentBasis(
+	// inputs
+	std::vector<glm::vec3> & vertices,
+	std::vector<glm::vec2> & uvs,
+	std::vector<glm::vec3> & normals,
+	// outputs
+	std::vector<glm::vec3> & tangents,
+	std::vector<glm::vec3> & bitangents
+){
+	tangents.resize(vertices.size());
+	bitangents.resize(vertices.size());
+	if (vertices.empty()) return;
+	computeTangentBasis(&vertices[0], &uvs[0], &normals[0], vertices.size(), &tangents[0], &bitangents[0]);
 }
 
+template<class Index> static void ComputeTangentBasisIndexed(
+	const std::vector<Index> & indices,
+	const std::vector<glm::vec3> & vertices,
+	const std::vector<glm::vec2> & uvs,
+	const std::vector<glm::vec3> & normals,
+	std::vector<glm::vec3> & tangents,
+	std::vector<glm::vec3> & bitangents
+){
+	const size_t vertexCount = vertices.size();
+	const size_t triangleCount = indices.size() / 3;
+	tangents.assign(vertexCount, glm::vec3(0.0f));
+	bitangents.assign(vertexCount, glm::vec3(0.0f));
+	if (vertexCount == 0) return;
 
+	// the triangles of a vertex may be processed by different threads, so every thread sums into it's own vertices
+	// (the first thread into the outputs), the sums are added afterwards
+	const size_t threadCount = GetThreadCount(triangleCount);
+	std::vector<std::vector<glm::vec3> > partialTangents(threadCount), partialBitangents(threadCount);
+	const Index * triangleIndices = triangleCount > 0 ? &indices[0] : NULL;
+	ParallelFor(triangleCount, threadCount, [&](size_t thread, size_t begin, size_t end){
+		glm::vec3 * sumTangents = &tangents[0];
+		glm::vec3 * sumBitangents = &bitangents[0];
+		if (thread > 0) {
+			partialTangents[thread].assign(vertexCount, glm::vec3(0.0f));
+			partialBitangents[thread].assign(vertexCount, glm::vec3(0.0f));
+			sumTangents = &partialTangents[thread][0];
+			sumBitangents = &partialBitangents[thread][0];
+		}
+		for (size_t triangle = begin; triangle < end; triangle += 4) {
+			size_t count = std::min<size_t>(4, end - triangle);
+			size_t corners[3][4];
+			for (size_t lane = 0; lane < 4; lane++) {
+				for (int corner = 0; corner < 3; corner++) {
+					corners[corner][lane] = triangleIndices[3 * (triangle + std::min<size_t>(lane, count - 1)) + corner];
+				}
+			}
+			Vec3Lanes tangent, bitangent;
+			ComputeTriangleBatch(&vertices[0], &uvs[0], corners, tangent, bitangent);
+			for (size_t lane = 0; lane < count; lane++) {
+				const glm::vec3 laneTangent = GetVector(tangent, (int)lane), laneBitangent = GetVector(bitangent, (int)lane);
+				for (int corner = 0; corner < 3; corner++) {
+					sumTangents[corners[corner][lane]] += laneTangent;
+					sumBitangents[corners[corner][lane]] += laneBitangent;
+				}
+			}
+		}
+	});
+
+	// adding the sums of the other threads (in the order of the threads) and orthogonalizing, split by vertices
+	ParallelFor(vertexCount, GetThreadCount(vertexCount), [&](size_t, size_t begin, size_t end){
+		for (size_t thread = 1; thread < threadCount; thread++) {
+			for (size_t v = begin; v < end; v++) {
+				tangents[v] += partialTangents[thread][v];
+				bitangents[v] += partialBitangents[thread][v];
+			}
+		}
+		OrthogonalizeTangents(&normals[0], &tangents[0], &bitangents[0], begin, end);
+	});
+}
+
+void computeTangentBasis(
+	const std::vector<unsigned short> & indices,
+	const std::vector<glm::vec3> & vertices,
+	const std::vector<glm::vec2> & uvs,
+	const std::vector<glm::vec3> & normals,
+	std::vector<glm::vec3> & tangents,
+	std::vector<glm::vec3> & bitangents
+){
+	ComputeTangentBasisIndexed(indices, vertices, uvs, normals, tangents, bitangents);
+}
+
+void computeTangentBasis(
+	const std::vector<unsigned int> & indices,
+	const std::vector<glm::vec3> & vertices,
+	const std::vector<glm::vec2> & uvs,
+	const std::vector<glm::vec3> & normals,
+	std::vector<glm::vec3> & tangents,
+	std::vector<glm::vec3> & bitangents
+){
+	ComputeTangentBasisIndexed(indices, vertices, uvs, normals, tangents, bitangents);
+}
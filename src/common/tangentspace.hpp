@@ -1,6 +1,8 @@
 #ifndef TANGENTSPACE_HPP
 #define TANGENTSPACE_HPP
 
+// Tangents and bitangents of triangles of three consecutive vertices (the outputs are resized to the vertices),
+// the tangents of a triangle's vertices are the same (see indexVBO_TBN)
 void computeTangentBasis(
 	// inputs
 	std::vector<glm::vec3> & vertices,
@@ -11,5 +13,41 @@ void computeTangentBasis(
 	std::vector<glm::vec3> & bitangents
 );
 
+// Same with preallocated outputs of 'vertex_count' elements
+// (the triangles are processed four at once with SSE, large meshes are split across threads)
+void computeTangentBasis(
+	// inputs
+	const glm::vec3 * vertices,
+	const glm::vec2 * uvs,
+	const glm::vec3 * normals,
+	size_t vertex_count,
+	// outputs
+	glm::vec3 * tangents,
+	glm::vec3 * bitangents
+);
+
+// Tangents and bitangents of indexed triangles: every vertex gets the sum of it's triangles' tangents and bitangents
+// (the tangent orthogonalized and normalized)
+void computeTangentBasis(
+	// inputs
+	const std::vector<unsigned short> & indices,
+	const std::vector<glm::vec3> & vertices,
+	const std::vector<glm::vec2> & uvs,
+	const std::vector<glm::vec3> & normals,
+	// outputs
+	std::vector<glm::vec3> & tangents,
+	std::vector<glm::vec3> & bitangents
+);
+void computeTangentBasis(
+	// inputs
+	const std::vector<unsigned int> & indices,
+	const std::vector<glm::vec3> & vertices,
+	const std::vector<glm::vec2> & uvs,
+	const std::vector<glm::vec3> & normals,
+	// outputs
+	std::vector<glm::vec3> & tangents,
+	std::vector<glm::vec3> & bitangents
+);
+
 
 #endif
\ No newline at end of file
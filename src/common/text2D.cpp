@@ -1,5 +1,7 @@
 #include <vector>
+#include <string>
 #include <cstring>
+#include <algorithm>
 
 #include <GL/glew.h>
 
@@ -18,6 +20,28 @@ unsigned int Text2DUVBufferID;
 unsigned int Text2DShaderID;
 unsigned int Text2DUniformID;
 
+// Retained texts: every text has a region of glyphs in a shared buffer, drawn in one call by drawTexts2D.
+// The unused glyphs of the buffer are degenerate (zero area), so the regions don't need to be contiguous.
+struct Text2DVertex {
+	glm::vec2 position;
+	glm::vec2 uv;
+};
+struct Text2DText {
+	std::string text;
+	int x, y, size;
+	// region of the text in the glyph buffer (capacity 0 if the text is free)
+	unsigned int first, capacity;
+};
+static const unsigned int TEXT2D_MAX_GLYPHS = 4096;
+static const Text2DVertex TEXT2D_DEGENERATE = { glm::vec2(0.0f), glm::vec2(0.0f) };
+// glyphs written per glBufferSubData (tessellated on the stack)
+static const unsigned int TEXT2D_UPLOAD_GLYPHS = 64;
+unsigned int Text2DGlyphBufferID;
+unsigned int Text2DVertexArrayID;
+std::vector<Text2DText> Text2DTexts;
+// glyphs up to the end of the last region (drawn by drawTexts2D)
+unsigned int Text2DGlyphCount = 0;
+
 void initText2D(const char * texturePath){
 
 	// Initialize texture
@@ -33,15 +57,191 @@ void initText2D(const char * texturePath){
 	// Initialize uniforms' IDs
 	Text2DUniformID = glGetUniformLocation( Text2DShaderID, "myTextureSampler" );
 
+	// Initialize the glyph buffer of the retained texts (zeros are degenerate glyphs) and it's attributes,
+	// the vertex array of the caller stays bound (printText2D draws with it)
+	GLint boundVertexArray = 0;
+	glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &boundVertexArray);
+	glGenVertexArrays(1, &Text2DVertexArrayID);
+	glBindVertexArray(Text2DVertexArrayID);
+	glGenBuffers(1, &Text2DGlyphBufferID);
+	glBindBuffer(GL_ARRAY_BUFFER, Text2DGlyphBufferID);
+	std::vector<Text2DVertex> zeros(TEXT2D_MAX_GLYPHS * 6, TEXT2D_DEGENERATE);
+	glBufferData(GL_ARRAY_BUFFER, zeros.size() * sizeof(Text2DVertex), &zeros[0], GL_DYNAMIC_DRAW);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Text2DVertex), (void*)0 );
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Text2DVertex), (void*)sizeof(glm::vec2) );
+	glBindVertexArray(boundVertexArray);
+	Text2DTexts.clear();
+	Text2DGlyphCount = 0;
+
+}
+
+// The 6 vertices of a character (two triangles), like printText2D
+static void TessellateGlyph(char character, int x, int y, int size, Text2DVertex * vertices){
+	glm::vec2 vertex_up_left    = glm::vec2( x     , y+size );
+	glm::vec2 vertex_up_right   = glm::vec2( x+size, y+size );
+	glm::vec2 vertex_down_right = glm::vec2( x+size, y      );
+	glm::vec2 vertex_down_left  = glm::vec2( x     , y      );
+
+	float uv_x = (character%16)/16.0f;
+	float uv_y = (character/16)/16.0f;
+	glm::vec2 uv_up_left    = glm::vec2( uv_x           , uv_y );
+	glm::vec2 uv_up_right   = glm::vec2( uv_x+1.0f/16.0f, uv_y );
+	glm::vec2 uv_down_right = glm::vec2( uv_x+1.0f/16.0f, (uv_y + 1.0f/16.0f) );
+	glm::vec2 uv_down_left  = glm::vec2( uv_x           , (uv_y + 1.0f/16.0f) );
+
+	vertices[0].position = vertex_up_left;    vertices[0].uv = uv_up_left;
+	vertices[1].position = vertex_down_left;  vertices[1].uv = uv_down_left;
+	vertices[2].position = vertex_up_right;   vertices[2].uv = uv_up_right;
+	vertices[3].position = vertex_down_right; vertices[3].uv = uv_down_right;
+	vertices[4].position = vertex_up_right;   vertices[4].uv = uv_up_right;
+	vertices[5].position = vertex_down_left;  vertices[5].uv = uv_down_left;
+}
+
+// Writes the glyphs of a text into it's region, the rest of the region is degenerate
+static void UploadText(const Text2DText & text){
+	Text2DVertex vertices[TEXT2D_UPLOAD_GLYPHS * 6];
+	glBindBuffer(GL_ARRAY_BUFFER, Text2DGlyphBufferID);
+	for (unsigned int first = 0; first < text.capacity; first += TEXT2D_UPLOAD_GLYPHS){
+		unsigned int count = std::min(TEXT2D_UPLOAD_GLYPHS, text.capacity - first);
+		for (unsigned int i = 0; i < count; i++){
+			unsigned int glyph = first + i;
+			if (glyph < text.text.size()) TessellateGlyph(text.text[glyph], text.x + glyph*text.size, text.y, text.size, &vertices[6*i]);
+			else for (int j = 0; j < 6; j++) vertices[6*i+j] = TEXT2D_DEGENERATE;
+		}
+		glBufferSubData(GL_ARRAY_BUFFER, (text.first + first) * 6 * sizeof(Text2DVertex), count * 6 * sizeof(Text2DVertex), vertices);
+	}
+}
+
+// Finds a free region of 'capacity' glyphs (first fit), returns false if the buffer is full
+static bool AllocateGlyphs(unsigned int capacity, unsigned int * first){
+	// a region starts at 0 or after another region
+	for (size_t candidate = 0; candidate <= Text2DTexts.size(); candidate++){
+		unsigned int begin = candidate == 0 ? 0 : Text2DTexts[candidate-1].first + Text2DTexts[candidate-1].capacity;
+		if (candidate > 0 && Text2DTexts[candidate-1].capacity == 0) continue;
+		if (begin + capacity > TEXT2D_MAX_GLYPHS) continue;
+		bool overlaps = false;
+		for (const Text2DText & text : Text2DTexts){
+			overlaps = overlaps || (text.capacity > 0 && text.first < begin + capacity && begin < text.first + text.capacity);
+		}
+		if (!overlaps){
+			*first = begin;
+			return true;
+		}
+	}
+	return false;
+}
+
+// Whether an id belongs to a text that was created and isn't deleted
+static bool IsText2D(int id){
+	return id >= 0 && (size_t)id < Text2DTexts.size() && Text2DTexts[id].capacity > 0;
+}
+
+static void UpdateGlyphCount(){
+	Text2DGlyphCount = 0;
+	for (const Text2DText & text : Text2DTexts){
+		if (text.capacity > 0) Text2DGlyphCount = std::max(Text2DGlyphCount, text.first + text.capacity);
+	}
+}
+
+int createText2D(const char * text, int x, int y, int size){
+	// a free text is reused
+	size_t index = 0;
+	while (index < Text2DTexts.size() && Text2DTexts[index].capacity > 0) index++;
+	if (index == Text2DTexts.size()) Text2DTexts.push_back(Text2DText());
+	Text2DText & retained = Text2DTexts[index];
+	retained.text.clear();
+	retained.capacity = 0;
+	// the region has room for 16 more characters, so short changes of the text don't need a new region
+	unsigned int capacity = (unsigned int)strlen(text) + 16;
+	if (!AllocateGlyphs(capacity, &retained.first)) return -1;
+	retained.text = text;
+	retained.x = x;
+	retained.y = y;
+	retained.size = size;
+	retained.capacity = capacity;
+	UploadText(retained);
+	UpdateGlyphCount();
+	return (int)index;
+}
+
+bool setText2D(int id, const char * text, int x, int y, int size){
+	if (!IsText2D(id)) return false;
+	Text2DText & retained = Text2DTexts[id];
+	// unchanged texts aren't tessellated again
+	if (retained.x == x && retained.y == y && retained.size == size && retained.text == text) return true;
+	unsigned int length = (unsigned int)strlen(text);
+	if (length > retained.capacity){
+		// the text moves to a larger region, the previous one becomes degenerate
+		std::string previous;
+		previous.swap(retained.text);
+		UploadText(retained);
+		unsigned int capacity = retained.capacity;
+		retained.capacity = 0;
+		if (!AllocateGlyphs(length + 16, &retained.first)){
+			retained.capacity = capacity;
+			previous.swap(retained.text);
+			UploadText(retained);
+			return false;
+		}
+		retained.capacity = length + 16;
+		UpdateGlyphCount();
+	}
+	retained.text = text;
+	retained.x = x;
+	retained.y = y;
+	retained.size = size;
+	UploadText(retained);
+	return true;
+}
+
+void deleteText2D(int id){
+	if (!IsText2D(id)) return;
+	Text2DText & retained = Text2DTexts[id];
+	retained.text.clear();
+	UploadText(retained);
+	retained.capacity = 0;
+	UpdateGlyphCount();
+}
+
+void drawTexts2D(){
+	if (Text2DGlyphCount == 0) return;
+
+	// Bind shader
+	glUseProgram(Text2DShaderID);
+
+	// Bind texture
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, Text2DTextureID);
+	// Set our "myTextureSampler" sampler to use Texture Unit 0
+	glUniform1i(Text2DUniformID, 0);
+
+	// The vertex array of the caller is bound again afterwards (printText2D draws with it)
+	GLint boundVertexArray = 0;
+	glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &boundVertexArray);
+	glBindVertexArray(Text2DVertexArrayID);
+
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	// Every retained text in one draw call
+	glDrawArrays(GL_TRIANGLES, 0, Text2DGlyphCount * 6 );
+
+	glDisable(GL_BLEND);
+
+	glBindVertexArray(boundVertexArray);
 }
 
 void printText2D(const char * text, int x, int y, int size){
 
 	unsigned int length = strlen(text);
 
-	// Fill buffers
-	std::vector<glm::vec2> vertices;
-	std::vector<glm::vec2> UVs;
+	// Fill buffers (kept between the calls, so they are allocated only for longer texts)
+	static std::vector<glm::vec2> vertices;
+	static std::vector<glm::vec2> UVs;
+	vertices.clear();
+	UVs.clear();
 	for ( unsigned int i=0 ; i<length ; i++ ){
 		
 		glm::vec2 vertex_up_left    = glm::vec2( x+i*size     , y+size );
@@ -115,6 +315,10 @@ void cleanupText2D(){
 	// Delete buffers
 	glDeleteBuffers(1, &Text2DVertexBufferID);
 	glDeleteBuffers(1, &Text2DUVBufferID);
+	glDeleteBuffers(1, &Text2DGlyphBufferID);
+	glDeleteVertexArrays(1, &Text2DVertexArrayID);
+	Text2DTexts.clear();
+	Text2DGlyphCount = 0;
 
 	// Delete texture
 	glDeleteTextures(1, &Text2DTextureID);
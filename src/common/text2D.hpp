@@ -5,4 +5,17 @@ void initText2D(const char * texturePath);
 void printText2D(const char * text, int x, int y, int size);
 void cleanupText2D();
 
+// Retained texts for text that is drawn every frame (e.g. a HUD): a text is tessellated once into a shared glyph buffer
+// and only again when it changes, drawTexts2D draws every retained text in one call without allocating memory.
+
+// Creates a retained text, returns it's id (-1 if the glyph buffer is full)
+int createText2D(const char * text, int x, int y, int size);
+// Changes a retained text (unchanged texts cost a comparison), returns false if the glyph buffer is full (the text is kept)
+// or if the id isn't a retained text (e.g. -1 of a failed createText2D)
+bool setText2D(int id, const char * text, int x, int y, int size);
+// Deletes a retained text, it's id may be returned by createText2D again (ids that aren't retained texts are ignored)
+void deleteText2D(int id);
+// Draws every retained text (the bound vertex array is kept)
+void drawTexts2D();
+
 #endif
\ No newline at end of file
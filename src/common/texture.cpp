@@ -6,44 +6,61 @@
 
 #include <glfw3.h>
 
+#include "texture.hpp"
+
+
+// Reads a whole file into a new buffer (freed with delete []), returns NULL if it can't be opened
+static unsigned char * ReadFile(const char * imagepath, size_t * size){
+	FILE * file = fopen(imagepath,"rb");
+	if (!file){
+		printf("%s could not be opened. Are you in the right directory ? Don't forget to read the FAQ !\n", imagepath);
+		getchar();
+		return NULL;
+	}
+	fseek(file, 0, SEEK_END);
+	long length = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	unsigned char * data = new unsigned char [length > 0 ? length : 1];
+	*size = length > 0 ? fread(data, 1, length, file) : 0;
+	fclose(file);
+	return data;
+}
 
 GLuint loadBMP_custom(const char * imagepath){
 
 	printf("Reading image %s\n", imagepath);
 
+	// Read the whole file, the image is loaded from memory
+	size_t size;
+	unsigned char * file = ReadFile(imagepath, &size);
+	if (file == NULL) return 0;
+	GLuint textureID = loadBMP_memory(file, size);
+	delete [] file;
+	return textureID;
+}
+
+GLuint loadBMP_memory(const void * file, size_t size){
+
 	// Data read from the header of the BMP file
-	unsigned char header[54];
+	const unsigned char * header = (const unsigned char *)file;
 	unsigned int dataPos;
 	unsigned int imageSize;
 	unsigned int width, height;
-	// Actual RGB data
-	unsigned char * data;
 
-	// Open the file
-	FILE * file = fopen(imagepath,"rb");
-	if (!file){
-		printf("%s could not be opened. Are you in the right directory ? Don't forget to read the FAQ !\n", imagepath);
-		getchar();
-		return 0;
-	}
-
-	// Read the header, i.e. the 54 first bytes
-
-	// If less than 54 bytes are read, problem
-	if ( fread(header, 1, 54, file)!=54 ){ 
+	// The header is the 54 first bytes
+	// If less than 54 bytes are there, problem
+	if ( size < 54 ){ 
 		printf("Not a correct BMP file\n");
-		fclose(file);
 		return 0;
 	}
 	// A BMP files always begins with "BM"
 	if ( header[0]!='B' || header[1]!='M' ){
 		printf("Not a correct BMP file\n");
-		fclose(file);
 		return 0;
 	}
 	// Make sure this is a 24bpp file
-	if ( *(int*)&(header[0x1E])!=0  )         {printf("Not a correct BMP file\n");    fclose(file); return 0;}
-	if ( *(int*)&(header[0x1C])!=24 )         {printf("Not a correct BMP file\n");    fclose(file); return 0;}
+	if ( *(int*)&(header[0x1E])!=0  )         {printf("Not a correct BMP file\n");    return 0;}
+	if ( *(int*)&(header[0x1C])!=24 )         {printf("Not a correct BMP file\n");    return 0;}
 
 	// Read the information about the image
 	dataPos    = *(int*)&(header[0x0A]);
@@ -55,14 +72,12 @@ GLuint loadBMP_custom(const char * imagepath){
 	if (imageSize==0)    imageSize=width*height*3; // 3 : one byte for each Red, Green and Blue component
 	if (dataPos==0)      dataPos=54; // The BMP header is done that way
 
-	// Create a buffer
-	data = new unsigned char [imageSize];
-
-	// Read the actual data from the file into the buffer
-	fread(data,1,imageSize,file);
-
-	// Everything is in memory now, the file can be closed.
-	fclose (file);
+	// The actual RGB data, rows padded to 4 bytes (the default GL_UNPACK_ALIGNMENT)
+	if ( dataPos > size || (size_t)((width*3+3)&~3u)*height > size - dataPos ){
+		printf("Not a correct BMP file\n");
+		return 0;
+	}
+	const unsigned char * data = header + dataPos;
 
 	// Create one OpenGL texture
 	GLuint textureID;
@@ -74,9 +89,6 @@ GLuint loadBMP_custom(const char * imagepath){
 	// Give the image to OpenGL
 	glTexImage2D(GL_TEXTURE_2D, 0,GL_RGB, width, height, 0, GL_BGR, GL_UNSIGNED_BYTE, data);
 
-	// OpenGL has now copied the data. Free our own version
-	delete [] data;
-
 	// Poor filtering, or ...
 	//glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 	//glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST); 
@@ -126,45 +138,36 @@ GLuint loadBMP_custom(const char * imagepath){
 
 GLuint loadDDS(const char * imagepath){
 
-	unsigned char header[124];
+	// Read the whole file, the image is loaded from memory
+	size_t size;
+	unsigned char * file = ReadFile(imagepath, &size);
+	if (file == NULL) return 0;
+	GLuint textureID = loadDDS_memory(file, size);
+	delete [] file;
+	return textureID;
+}
 
-	FILE *fp; 
- 
-	/* try to open the file */ 
-	fp = fopen(imagepath, "rb"); 
-	if (fp == NULL){
-		printf("%s could not be opened. Are you in the right directory ? Don't forget to read the FAQ !\n", imagepath); getchar(); 
-		return 0;
-	}
+GLuint loadDDS_memory(const void * file, size_t size){
+
+	const unsigned char * data = (const unsigned char *)file;
    
 	/* verify the type of file */ 
-	char filecode[4]; 
-	fread(filecode, 1, 4, fp); 
-	if (strncmp(filecode, "DDS ", 4) != 0) { 
-		fclose(fp); 
+	if (size < 128 || strncmp((const char *)data, "DDS ", 4) != 0) { 
 		return 0; 
 	}
 	
 	/* get the surface desc */ 
-	fread(&header, 124, 1, fp); 
+	const unsigned char * header = data + 4;
 
 	unsigned int height      = *(unsigned int*)&(header[8 ]);
 	unsigned int width	     = *(unsigned int*)&(header[12]);
-	unsigned int linearSize	 = *(unsigned int*)&(header[16]);
 	unsigned int mipMapCount = *(unsigned int*)&(header[24]);
 	unsigned int fourCC      = *(unsigned int*)&(header[80]);
 
- 
-	unsigned char * buffer;
-	unsigned int bufsize;
-	/* how big is it going to be including all mipmaps? */ 
-	bufsize = mipMapCount > 1 ? linearSize * 2 : linearSize; 
-	buffer = (unsigned char*)malloc(bufsize * sizeof(unsigned char)); 
-	fread(buffer, 1, bufsize, fp); 
-	/* close the file pointer */ 
-	fclose(fp);
-
-	unsigned int components  = (fourCC == FOURCC_DXT1) ? 3 : 4; 
+	/* the mipmaps follow the header */ 
+	const unsigned char * buffer = data + 128;
+	size_t bufsize = size - 128;
+
 	unsigned int format;
 	switch(fourCC) 
 	{ 
@@ -178,7 +181,6 @@ GLuint loadDDS(const char * imagepath){
 		format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; 
 		break; 
 	default: 
-		free(buffer); 
 		return 0; 
 	}
 
@@ -191,12 +193,14 @@ GLuint loadDDS(const char * imagepath){
 	glPixelStorei(GL_UNPACK_ALIGNMENT,1);	
 	
 	unsigned int blockSize = (format == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT) ? 8 : 16; 
-	unsigned int offset = 0;
+	size_t offset = 0;
 
 	/* load the mipmaps */ 
 	for (unsigned int level = 0; level < mipMapCount && (width || height); ++level) 
 	{ 
 		unsigned int size = ((width+3)/4)*((height+3)/4)*blockSize; 
+		// a truncated file ends the mipmaps
+		if (offset + size > bufsize) break;
 		glCompressedTexImage2D(GL_TEXTURE_2D, level, format, width, height,  
 			0, size, buffer + offset); 
 	 
@@ -210,8 +214,6 @@ GLuint loadDDS(const char * imagepath){
 
 	} 
 
-	free(buffer); 
-
 	return textureID;
 
 
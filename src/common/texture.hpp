@@ -2,8 +2,12 @@
 #define TEXTURE_HPP
 
 // Load a .BMP file using our custom loader
+// (both loaders block until the texture is uploaded, see TextureStreamer in texturestreamer.hpp to load in the background)
 GLuint loadBMP_custom(const char * imagepath);
 
+// Load a .BMP file in memory (e.g. an asset of an AssetPack)
+GLuint loadBMP_memory(const void * file, size_t size);
+
 //// Since GLFW 3, glfwLoadTexture2D() has been removed. You have to use another texture loading library, 
 //// or do it yourself (just like loadBMP_custom and loadDDS)
 //// Load a .TGA file using GLFW's own loader
@@ -12,5 +16,8 @@ GLuint loadBMP_custom(const char * imagepath);
 // Load a .DDS file using GLFW's own loader
 GLuint loadDDS(const char * imagepath);
 
+// Load a .DDS file in memory (e.g. an asset of an AssetPack)
+GLuint loadDDS_memory(const void * file, size_t size);
+
 
 #endif
\ No newline at end of file
@@ -0,0 +1,383 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+
+#include "texturestreamer.hpp"
+#include "mappedfile.hpp"
+
+#define FOURCC_DXT1 0x31545844 // Equivalent to "DXT1" in ASCII
+#define FOURCC_DXT3 0x33545844 // Equivalent to "DXT3" in ASCII
+#define FOURCC_DXT5 0x35545844 // Equivalent to "DXT5" in ASCII
+
+// Alignment of the regions of the staging buffer
+static const size_t STAGING_ALIGNMENT = 64;
+
+static uint32_t ReadU32(const unsigned char * data) {
+	uint32_t value;
+	memcpy(&value, data, sizeof(value));
+	return value;
+}
+
+// Size of the next mipmap level (Non-Power-Of-Two textures are rounded down)
+static unsigned int NextLevelSize(unsigned int size) {
+	return size > 1 ? size / 2 : 1;
+}
+
+// Checks the header of a 24bpp BMP file (see loadBMP_custom) and computes the size of it's mipmaps
+static bool ParseBMP(const unsigned char * data, size_t size, GLenum * format, std::vector<TextureStreamer::Level> * levels) {
+	// A BMP files always begins with "BM", the header is 54 bytes
+	if (size < 54 || data[0] != 'B' || data[1] != 'M') return false;
+	// Make sure this is a 24bpp file
+	if (ReadU32(data + 0x1E) != 0 || (ReadU32(data + 0x1C) & 0xFFFF) != 24) return false;
+	unsigned int width = ReadU32(data + 0x12);
+	unsigned int height = ReadU32(data + 0x16);
+	uint32_t dataPos = ReadU32(data + 0x0A);
+	if (dataPos == 0) dataPos = 54;
+	// the rows of a BMP are padded to 4 bytes
+	size_t rowSize = ((size_t)width * 3 + 3) & ~(size_t)3;
+	if (width == 0 || height == 0 || width > 0x8000 || height > 0x8000 || dataPos > size || rowSize * height > size - dataPos) return false;
+
+	*format = GL_BGRA;
+	levels->clear();
+	size_t offset = 0;
+	while (true) {
+		TextureStreamer::Level level = { width, height, offset, (size_t)width * height * 4 };
+		levels->push_back(level);
+		offset += level.size;
+		if (width == 1 && height == 1) break;
+		width = NextLevelSize(width);
+		height = NextLevelSize(height);
+	}
+	return true;
+}
+
+// Checks the header of a DXT compressed DDS file (see loadDDS) and computes the size of it's mipmaps
+static bool ParseDDS(const unsigned char * data, size_t size, GLenum * format, std::vector<TextureStreamer::Level> * levels) {
+	if (size < 128 || strncmp((const char *)data, "DDS ", 4) != 0) return false;
+	const unsigned char * header = data + 4;
+	unsigned int height = ReadU32(header + 8);
+	unsigned int width = ReadU32(header + 12);
+	unsigned int mipMapCount = ReadU32(header + 24);
+	switch (ReadU32(header + 80)) {
+	case FOURCC_DXT1: *format = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT; break;
+	case FOURCC_DXT3: *format = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT; break;
+	case FOURCC_DXT5: *format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; break;
+	default: return false;
+	}
+	if (width == 0 || height == 0 || width > 0x8000 || height > 0x8000) return false;
+	// a file without the mipmap count has one level
+	if (mipMapCount == 0) mipMapCount = 1;
+
+	size_t blockSize = *format == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT ? 8 : 16;
+	levels->clear();
+	size_t offset = 0;
+	for (unsigned int i = 0; i < mipMapCount; i++) {
+		TextureStreamer::Level level = { width, height, offset, (size_t)((width + 3) / 4) * ((height + 3) / 4) * blockSize };
+		levels->push_back(level);
+		offset += level.size;
+		if (width == 1 && height == 1) break;
+		width = NextLevelSize(width);
+		height = NextLevelSize(height);
+	}
+	return offset <= size - 128;
+}
+
+// 2x2 box filter of a BGRA level (the last row and column of odd sizes are repeated)
+static void DownsampleBGRA(const unsigned char * source, unsigned int width, unsigned int height, unsigned char * destination) {
+	unsigned int nextWidth = NextLevelSize(width), nextHeight = NextLevelSize(height);
+	for (unsigned int y = 0; y < nextHeight; y++) {
+		const unsigned char * row0 = source + (size_t)std::min(2 * y, height - 1) * width * 4;
+		const unsigned char * row1 = source + (size_t)std::min(2 * y + 1, height - 1) * width * 4;
+		for (unsigned int x = 0; x < nextWidth; x++) {
+			unsigned int x0 = std::min(2 * x, width - 1) * 4, x1 = std::min(2 * x + 1, width - 1) * 4;
+			for (int c = 0; c < 4; c++) {
+				*destination++ = (unsigned char)((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) / 4);
+			}
+		}
+	}
+}
+
+TextureStreamer::TextureStreamer(size_t staging_size, unsigned int thread_count)
+	: m_stagingSize(staging_size), m_threadCount(thread_count > 0 ? thread_count : 1), m_buffer(0), m_mapped(NULL),
+	m_pending(0), m_running(false) {
+}
+
+TextureStreamer::~TextureStreamer() {
+	// the buffer can't be deleted without the context, stop() needs to be called before
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_running = false;
+	}
+	m_queued.notify_all();
+	m_freed.notify_all();
+	for (std::thread & thread : m_threads) thread.join();
+	for (Job * job : m_queue) delete job;
+	for (Job * job : m_ready) delete job;
+}
+
+void TextureStreamer::start() {
+	if (m_running) return;
+	if (GLEW_ARB_buffer_storage && m_stagingSize > 0) {
+		// written by the workers while the GPU reads other regions, coherent so nothing needs to be flushed
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glGenBuffers(1, &m_buffer);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_buffer);
+		glBufferStorage(GL_PIXEL_UNPACK_BUFFER, m_stagingSize, NULL, flags);
+		m_mapped = (unsigned char *)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, m_stagingSize, flags);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		if (m_mapped == NULL) {
+			fprintf(stderr, "Failed to map the texture staging buffer, textures are uploaded from memory\n");
+			glDeleteBuffers(1, &m_buffer);
+			m_buffer = 0;
+		}
+	}
+	m_running = true;
+	for (unsigned int i = 0; i < m_threadCount; i++) m_threads.push_back(std::thread(&TextureStreamer::run, this));
+}
+
+void TextureStreamer::stop() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_running = false;
+	}
+	m_queued.notify_all();
+	m_freed.notify_all();
+	for (std::thread & thread : m_threads) thread.join();
+	m_threads.clear();
+
+	for (Job * job : m_queue) delete job;
+	for (Job * job : m_ready) delete job;
+	m_queue.clear();
+	m_ready.clear();
+	m_pending = 0;
+	for (Allocation & allocation : m_allocations) {
+		if (allocation.fence != NULL) glDeleteSync(allocation.fence);
+	}
+	m_allocations.clear();
+	if (m_buffer != 0) {
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_buffer);
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		glDeleteBuffers(1, &m_buffer);
+	}
+	m_buffer = 0;
+	m_mapped = NULL;
+}
+
+GLuint TextureStreamer::loadBMP(const char * imagepath) {
+	return queue(imagepath, false);
+}
+
+GLuint TextureStreamer::loadDDS(const char * imagepath) {
+	return queue(imagepath, true);
+}
+
+GLuint TextureStreamer::queue(const char * imagepath, bool dds) {
+	GLuint textureID;
+	glGenTextures(1, &textureID);
+
+	Job * job = new Job();
+	job->path = imagepath;
+	job->dds = dds;
+	job->texture = textureID;
+	job->failed = false;
+	job->format = 0;
+	job->size = 0;
+	job->allocation = NULL;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_queue.push_back(job);
+		m_pending++;
+	}
+	m_queued.notify_one();
+	return textureID;
+}
+
+size_t TextureStreamer::pending() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_pending;
+}
+
+void TextureStreamer::run() {
+	while (true) {
+		Job * job;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_queued.wait(lock, [this] { return !m_running || !m_queue.empty(); });
+			if (!m_running) return;
+			job = m_queue.front();
+			m_queue.pop_front();
+		}
+
+		MappedFile file;
+		const unsigned char * data = NULL;
+		if (!file.open(job->path.c_str())) {
+			printf("%s could not be opened. Are you in the right directory ? Don't forget to read the FAQ !\n", job->path.c_str());
+			job->failed = true;
+		} else {
+			data = (const unsigned char *)file.data();
+			job->failed = job->dds ? !ParseDDS(data, file.size(), &job->format, &job->levels) : !ParseBMP(data, file.size(), &job->format, &job->levels);
+			if (job->failed) printf("Not a correct %s file: %s\n", job->dds ? "DDS" : "BMP", job->path.c_str());
+		}
+
+		if (!job->failed) {
+			const Level & last = job->levels.back();
+			job->size = last.offset + last.size;
+			unsigned char * destination = reserve(job);
+			if (destination == NULL) {
+				// stopped while waiting for space
+				delete job;
+				return;
+			}
+			if (job->dds) {
+				// the compressed mipmaps are stored in the file
+				memcpy(destination, data + 128, job->size);
+			} else {
+				// BGRA is the layout of the textures on most GPUs, it's uploaded without conversions by the driver
+				const Level & base = job->levels[0];
+				size_t paddedRowSize = ((size_t)base.width * 3 + 3) & ~(size_t)3;
+				uint32_t dataPos = ReadU32(data + 0x0A);
+				const unsigned char * source = data + (dataPos != 0 ? dataPos : 54);
+				unsigned char * pixel = destination;
+				for (unsigned int y = 0; y < base.height; y++) {
+					const unsigned char * row = source + y * paddedRowSize;
+					for (unsigned int x = 0; x < base.width; x++, pixel += 4) {
+						pixel[0] = row[3 * x];
+						pixel[1] = row[3 * x + 1];
+						pixel[2] = row[3 * x + 2];
+						pixel[3] = 255;
+					}
+				}
+				// then the mipmaps
+				for (size_t i = 1; i < job->levels.size(); i++) {
+					const Level & previous = job->levels[i - 1];
+					DownsampleBGRA(destination + previous.offset, previous.width, previous.height, destination + job->levels[i].offset);
+				}
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_ready.push_back(job);
+	}
+}
+
+unsigned char * TextureStreamer::reserve(Job * job) {
+	const size_t size = (job->size + STAGING_ALIGNMENT - 1) & ~(STAGING_ALIGNMENT - 1);
+	if (m_mapped == NULL || size > m_stagingSize) {
+		job->memory.resize(job->size);
+		return &job->memory[0];
+	}
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (m_running) {
+		// the regions are allocated after the newest one, wrapping around to the start of the buffer
+		size_t begin = m_stagingSize;
+		if (m_allocations.empty()) {
+			begin = 0;
+		} else {
+			size_t head = m_allocations.back().end, tail = m_allocations.front().begin;
+			if (head > tail) {
+				if (head + size <= m_stagingSize) begin = head;
+				else if (size <= tail) begin = 0;
+			} else if (head + size <= tail) {
+				begin = head;
+			}
+		}
+		if (begin != m_stagingSize) {
+			Allocation allocation = { begin, begin + size, NULL };
+			m_allocations.push_back(allocation);
+			// references to the elements of a deque stay valid when elements are added or removed at the ends
+			job->allocation = &m_allocations.back();
+			return m_mapped + begin;
+		}
+		m_freed.wait(lock);
+	}
+	return NULL;
+}
+
+void TextureStreamer::retire() {
+	bool freed = false;
+	while (!m_allocations.empty()) {
+		Allocation & allocation = m_allocations.front();
+		// the regions are freed in order, a region that isn't uploaded yet keeps the later ones
+		if (allocation.fence == NULL) break;
+		// GL_WAIT_FAILED doesn't tell whether the GPU finished reading the region, it's kept like an unsignalled one
+		GLenum status = glClientWaitSync(allocation.fence, 0, 0);
+		if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) break;
+		glDeleteSync(allocation.fence);
+		m_allocations.pop_front();
+		freed = true;
+	}
+	if (freed) m_freed.notify_all();
+}
+
+unsigned int TextureStreamer::update(size_t upload_budget) {
+	std::vector<Job *> jobs;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		retire();
+		// the textures that fit in the budget, in the order they were decoded
+		size_t budget = 0, taken = 0;
+		for (; taken < m_ready.size(); taken++) {
+			size_t size = m_ready[taken]->size;
+			if (taken > 0 && budget + size > upload_budget) break;
+			budget += size;
+		}
+		jobs.assign(m_ready.begin(), m_ready.begin() + taken);
+		m_ready.erase(m_ready.begin(), m_ready.begin() + taken);
+	}
+
+	for (Job * job : jobs) {
+		if (!job->failed) upload(job);
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for (Job * job : jobs) {
+		// the region is freed when the GPU finished reading it
+		if (job->allocation != NULL) job->allocation->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		delete job;
+	}
+	m_pending -= jobs.size();
+	return (unsigned int)jobs.size();
+}
+
+void TextureStreamer::upload(Job * job) {
+	// the pixels are read from the staging buffer (offsets) or from memory (pointers)
+	const uintptr_t source = job->allocation != NULL ? (uintptr_t)job->allocation->begin : (uintptr_t)&job->memory[0];
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, job->allocation != NULL ? m_buffer : 0);
+	glBindTexture(GL_TEXTURE_2D, job->texture);
+	// the synchronous loaders rely on the alignment of the caller (4 by default), it's restored after the upload
+	GLint alignment = 4;
+	glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	const GLsizei levelCount = (GLsizei)job->levels.size();
+	if (GLEW_ARB_texture_storage) {
+		GLenum internalFormat = job->dds ? job->format : GL_RGBA8;
+		glTexStorage2D(GL_TEXTURE_2D, levelCount, internalFormat, job->levels[0].width, job->levels[0].height);
+	}
+	for (GLsizei i = 0; i < levelCount; i++) {
+		const Level & level = job->levels[i];
+		if (job->dds && GLEW_ARB_texture_storage) {
+			glCompressedTexSubImage2D(GL_TEXTURE_2D, i, 0, 0, level.width, level.height, job->format, (GLsizei)level.size, (const void *)(source + level.offset));
+		} else if (job->dds) {
+			glCompressedTexImage2D(GL_TEXTURE_2D, i, job->format, level.width, level.height, 0, (GLsizei)level.size, (const void *)(source + level.offset));
+		} else if (GLEW_ARB_texture_storage) {
+			glTexSubImage2D(GL_TEXTURE_2D, i, 0, 0, level.width, level.height, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, (const void *)(source + level.offset));
+		} else {
+			glTexImage2D(GL_TEXTURE_2D, i, GL_RGBA8, level.width, level.height, 0, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, (const void *)(source + level.offset));
+		}
+	}
+	// a DDS file may have less levels than a full mipmap chain
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+	if (!job->dds) {
+		// the trilinear filtering of loadBMP_custom
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
@@ -0,0 +1,95 @@
+#ifndef TEXTURESTREAMER_HPP
+#define TEXTURESTREAMER_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <GL/glew.h>
+
+// Asynchronous loading of .BMP and .DDS textures: worker threads map the files, decode them (the mipmaps of a BMP
+// are computed by the workers, instead of glGenerateMipmap) and write the levels into a persistently mapped
+// pixel unpack buffer (a ring, GL_ARB_buffer_storage). The main thread uploads the finished textures from the buffer
+// under a per-frame budget, so loading textures mid-game never blocks the render loop on the disk.
+// Without GL_ARB_buffer_storage (or for textures larger than the ring) the workers decode into memory and the
+// main thread uploads from there.
+class TextureStreamer {
+public:
+	// A mipmap level of a decoded texture, at 'offset' bytes of the texture's staging memory
+	struct Level {
+		unsigned int width, height;
+		size_t offset, size;
+	};
+
+	// 'staging_size' bytes of pixel unpack buffer, 'thread_count' worker threads
+	explicit TextureStreamer(size_t staging_size = 32 << 20, unsigned int thread_count = 2);
+	~TextureStreamer();
+	TextureStreamer(const TextureStreamer&) = delete;
+	TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+	// Creates the staging buffer (needs a current context) and starts the workers
+	void start();
+	// Stops the workers and deletes the staging buffer (textures that weren't uploaded yet stay empty)
+	void stop();
+
+	// Queue a texture, the returned texture is empty (incomplete, it samples as black) until update() uploads it.
+	// Same formats as loadBMP_custom and loadDDS, a file that can't be loaded leaves the texture empty.
+	GLuint loadBMP(const char * imagepath);
+	GLuint loadDDS(const char * imagepath);
+
+	// Uploads decoded textures (call it once per frame on the main thread): at most 'upload_budget' bytes,
+	// but at least one texture. Returns the number of finished (uploaded or failed) textures.
+	unsigned int update(size_t upload_budget);
+	// Textures that were queued and aren't finished yet
+	size_t pending();
+	// True if the workers write into the persistently mapped buffer
+	bool isPersistent() const { return m_mapped != NULL; }
+
+private:
+	// A region of the staging buffer, freed when the GPU finished reading it
+	struct Allocation {
+		size_t begin, end;
+		GLsync fence;
+	};
+	struct Job {
+		std::string path;
+		bool dds;
+		GLuint texture;
+		// results of the worker
+		bool failed;
+		GLenum format;
+		std::vector<Level> levels;
+		size_t size;
+		Allocation * allocation;
+		std::vector<unsigned char> memory;
+	};
+
+	size_t m_stagingSize;
+	unsigned int m_threadCount;
+	GLuint m_buffer;
+	unsigned char * m_mapped;
+
+	std::mutex m_mutex;
+	// signalled when a job is queued and when space of the staging buffer is freed
+	std::condition_variable m_queued, m_freed;
+	std::deque<Job *> m_queue;
+	std::vector<Job *> m_ready;
+	// the regions of the staging buffer in the order of their allocation
+	std::deque<Allocation> m_allocations;
+	size_t m_pending;
+	bool m_running;
+	std::vector<std::thread> m_threads;
+
+	GLuint queue(const char * imagepath, bool dds);
+	// a worker thread
+	void run();
+	// the staging memory of a decoded job (waits for space if the ring is full)
+	unsigned char * reserve(Job * job);
+	// frees the regions that the GPU finished reading (mutex held)
+	void retire();
+	void upload(Job * job);
+};
+
+#endif
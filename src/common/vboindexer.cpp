@@ -1,5 +1,7 @@
 #include <vector>
-#include <map>
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
 
 #include <glm/glm.hpp>
 
@@ -7,160 +9,333 @@
 
 #include <string.h> // for memcmp
 
+// Maximum distance of every component of two similar vertices (see is_near)
+static const float NEAR_EPSILON = 0.01f;
+// Size of the position cells of the similar vertex search (wider cells need less probes but hold more vertices)
+static const float CELL_SIZE = 4 * NEAR_EPSILON;
+// Cells beyond this coordinate are merged (the vertices are compared anyway)
+static const double MAX_CELL = 1 << 30;
 
 // Returns true iif v1 can be considered equal to v2
 bool is_near(float v1, float v2){
-	return fabs( v1-v2 ) < 0.01f;
+	return fabs( v1-v2 ) < NEAR_EPSILON;
 }
 
-// Searches through all already-exported vertices
-// for a similar one.
-// Similar = same position + same UVs + same normal
-bool getSimilarVertexIndex( 
-	glm::vec3 & in_vertex, 
-	glm::vec2 & in_uv, 
-	glm::vec3 & in_normal, 
-	std::vector<glm::vec3> & out_vertices,
-	std::vector<glm::vec2> & out_uvs,
-	std::vector<glm::vec3> & out_normals,
-	unsigned short & result
-){
-	// Lame linear search
-	for ( unsigned int i=0; i<out_vertices.size(); i++ ){
-		if (
-			is_near( in_vertex.x , out_vertices[i].x ) &&
-			is_near( in_vertex.y , out_vertices[i].y ) &&
-			is_near( in_vertex.z , out_vertices[i].z ) &&
-			is_near( in_uv.x     , out_uvs     [i].x ) &&
-			is_near( in_uv.y     , out_uvs     [i].y ) &&
-			is_near( in_normal.x , out_normals [i].x ) &&
-			is_near( in_normal.y , out_normals [i].y ) &&
-			is_near( in_normal.z , out_normals [i].z )
-		){
-			result = i;
-			return true;
+// Hash of a key of 32 bit words (multiplicative mixing of every word, the high bits are mixed into the low bits at the end)
+static inline uint32_t HashWords(const void * data, size_t size){
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; i < size; i += 4) {
+		uint32_t word;
+		memcpy(&word, (const char *)data + i, 4);
+		hash = (hash ^ word) * 0x9E3779B1u;
+		hash ^= hash >> 15;
+	}
+	return hash ^ (hash >> 16);
+}
+
+// Open addressing hash table (linear probing) from keys compared by their bytes to 32 bit values
+template<class Key> class VertexHashTable {
+	static_assert(sizeof(Key) % 4 == 0, "the keys are hashed as 32 bit words");
+public:
+	explicit VertexHashTable(size_t expected) : m_count(0) {
+		size_t capacity = 16;
+		while (capacity < expected * 2) capacity *= 2;
+		m_keys.resize(capacity);
+		m_values.assign(capacity, EMPTY);
+	}
+
+	// Returns the value of the key, or EMPTY if the table doesn't contain the key
+	uint32_t find(const Key & key) const {
+		size_t mask = m_values.size() - 1;
+		for (size_t slot = HashWords(&key, sizeof(Key)) & mask; m_values[slot] != EMPTY; slot = (slot + 1) & mask) {
+			if (memcmp(&m_keys[slot], &key, sizeof(Key)) == 0) return m_values[slot];
+		}
+		return EMPTY;
+	}
+
+	// Sets the value of a key (the key is added if the table doesn't contain it)
+	void set(const Key & key, uint32_t value) {
+		if ((m_count + 1) * 2 > m_values.size()) grow();
+		size_t mask = m_values.size() - 1;
+		size_t slot = HashWords(&key, sizeof(Key)) & mask;
+		for (; m_values[slot] != EMPTY; slot = (slot + 1) & mask) {
+			if (memcmp(&m_keys[slot], &key, sizeof(Key)) == 0) {
+				m_values[slot] = value;
+				return;
+			}
+		}
+		m_keys[slot] = key;
+		m_values[slot] = value;
+		m_count++;
+	}
+
+	static constexpr uint32_t EMPTY = 0xFFFFFFFF;
+
+private:
+	std::vector<Key> m_keys;
+	std::vector<uint32_t> m_values;
+	size_t m_count;
+
+	void grow() {
+		std::vector<Key> keys;
+		std::vector<uint32_t> values;
+		keys.swap(m_keys);
+		values.swap(m_values);
+		m_keys.resize(keys.size() * 2);
+		m_values.assign(values.size() * 2, EMPTY);
+		m_count = 0;
+		for (size_t i = 0; i < keys.size(); i++) {
+			if (values[i] != EMPTY) set(keys[i], values[i]);
 		}
 	}
-	// No other vertex could be used instead.
-	// Looks like we'll have to add it to the VBO.
+};
+
+struct PackedVertex{
+	glm::vec3 position;
+	glm::vec2 uv;
+	glm::vec3 normal;
+};
+
+// Cell of a position, every vertex is in the chain of it's cell
+struct PositionCell{
+	int32_t x, y, z;
+};
+
+static inline int32_t GetCell(double coordinate){
+	double cell = floor(coordinate / CELL_SIZE);
+	return (int32_t)(cell < -MAX_CELL ? -MAX_CELL : cell > MAX_CELL ? MAX_CELL : cell);
+}
+
+// Search of similar vertices (every component is near, see is_near) in the positions cells:
+// only the cells within the epsilon of the position are probed (one to eight), so a search takes constant time
+// and finds the same vertex as the linear search of all vertices (the first similar one).
+class SimilarVertexIndex {
+public:
+	explicit SimilarVertexIndex(size_t expected) : m_cells(expected) {
+		m_next.reserve(expected);
+	}
+
+	// Returns the lowest index of a similar vertex in out_XXXX, or VertexHashTable::EMPTY if there's none
+	uint32_t find(
+		const glm::vec3 & in_vertex, const glm::vec2 & in_uv, const glm::vec3 & in_normal,
+		const std::vector<glm::vec3> & out_vertices, const std::vector<glm::vec2> & out_uvs, const std::vector<glm::vec3> & out_normals
+	) const {
+		uint32_t result = EMPTY;
+		// a position that isn't finite is never near another one
+		if (!isfinite(in_vertex.x) || !isfinite(in_vertex.y) || !isfinite(in_vertex.z)) return result;
+		// cells of the positions within the epsilon (slightly widened against rounding, the vertices are compared exactly)
+		const float margin = NEAR_EPSILON * 1.01f;
+		PositionCell first = { GetCell(in_vertex.x - margin), GetCell(in_vertex.y - margin), GetCell(in_vertex.z - margin) };
+		PositionCell last = { GetCell(in_vertex.x + margin), GetCell(in_vertex.y + margin), GetCell(in_vertex.z + margin) };
+		PositionCell cell;
+		for (cell.x = first.x; cell.x <= last.x; cell.x++) {
+			for (cell.y = first.y; cell.y <= last.y; cell.y++) {
+				for (cell.z = first.z; cell.z <= last.z; cell.z++) {
+					for (uint32_t i = m_cells.find(cell); i != EMPTY; i = m_next[i]) {
+						// the chains are ordered from the newest vertex to the oldest one
+						if (i < result &&
+							is_near( in_vertex.x , out_vertices[i].x ) &&
+							is_near( in_vertex.y , out_vertices[i].y ) &&
+							is_near( in_vertex.z , out_vertices[i].z ) &&
+							is_near( in_uv.x     , out_uvs     [i].x ) &&
+							is_near( in_uv.y     , out_uvs     [i].y ) &&
+							is_near( in_normal.x , out_normals [i].x ) &&
+							is_near( in_normal.y , out_normals [i].y ) &&
+							is_near( in_normal.z , out_normals [i].z )
+						){
+							result = i;
+						}
+					}
+				}
+			}
+		}
+		return result;
+	}
+
+	// Adds the vertex with the next index (indices need to be added in order)
+	void add(const glm::vec3 & vertex) {
+		uint32_t index = (uint32_t)m_next.size();
+		if (!isfinite(vertex.x) || !isfinite(vertex.y) || !isfinite(vertex.z)) {
+			m_next.push_back(EMPTY);
+			return;
+		}
+		PositionCell cell = { GetCell(vertex.x), GetCell(vertex.y), GetCell(vertex.z) };
+		m_next.push_back(m_cells.find(cell));
+		m_cells.set(cell, index);
+	}
+
+private:
+	static constexpr uint32_t EMPTY = VertexHashTable<PositionCell>::EMPTY;
+	// newest vertex of every cell and the next (older) vertex of the same cell of every vertex
+	VertexHashTable<PositionCell> m_cells;
+	std::vector<uint32_t> m_next;
+};
+
+// Checks whether the indices of a vertex fit into the index type (prints an error once)
+template<class Index> static bool CheckIndexRange(size_t vertexCount){
+	if (vertexCount - 1 <= (Index)~(Index)0) return true;
+	fprintf(stderr, "Too many vertices for %d bit indices, use the unsigned int version of the indexer\n", (int)(8 * sizeof(Index)));
 	return false;
 }
 
-void indexVBO_slow(
+template<class Index> static void IndexVBOSimilar(
 	std::vector<glm::vec3> & in_vertices,
 	std::vector<glm::vec2> & in_uvs,
 	std::vector<glm::vec3> & in_normals,
 
-	std::vector<unsigned short> & out_indices,
+	std::vector<Index> & out_indices,
 	std::vector<glm::vec3> & out_vertices,
 	std::vector<glm::vec2> & out_uvs,
 	std::vector<glm::vec3> & out_normals
 ){
+	// the vertices already in out_XXXX are used too
+	SimilarVertexIndex similar(out_vertices.size() + in_vertices.size());
+	for ( unsigned int i=0; i<out_vertices.size(); i++ ) similar.add( out_vertices[i] );
+	bool inRange = true;
+	out_indices.reserve(out_indices.size() + in_vertices.size());
+
 	// For each input vertex
 	for ( unsigned int i=0; i<in_vertices.size(); i++ ){
 
 		// Try to find a similar vertex in out_XXXX
-		unsigned short index;
-		bool found = getSimilarVertexIndex(in_vertices[i], in_uvs[i], in_normals[i],     out_vertices, out_uvs, out_normals, index);
+		uint32_t index = similar.find(in_vertices[i], in_uvs[i], in_normals[i],     out_vertices, out_uvs, out_normals);
 
-		if ( found ){ // A similar vertex is already in the VBO, use it instead !
-			out_indices.push_back( index );
+		if ( index != VertexHashTable<PositionCell>::EMPTY ){ // A similar vertex is already in the VBO, use it instead !
+			out_indices.push_back( (Index)index );
 		}else{ // If not, it needs to be added in the output data.
 			out_vertices.push_back( in_vertices[i]);
 			out_uvs     .push_back( in_uvs[i]);
 			out_normals .push_back( in_normals[i]);
-			out_indices .push_back( (unsigned short)out_vertices.size() - 1 );
+			similar.add( in_vertices[i] );
+			if (inRange) inRange = CheckIndexRange<Index>(out_vertices.size());
+			out_indices .push_back( (Index)(out_vertices.size() - 1) );
 		}
 	}
 }
 
-struct PackedVertex{
-	glm::vec3 position;
-	glm::vec2 uv;
-	glm::vec3 normal;
-	bool operator<(const PackedVertex that) const{
-		return memcmp((void*)this, (void*)&that, sizeof(PackedVertex))>0;
-	};
-};
+void indexVBO_slow(
+	std::vector<glm::vec3> & in_vertices,
+	std::vector<glm::vec2> & in_uvs,
+	std::vector<glm::vec3> & in_normals,
 
-bool getSimilarVertexIndex_fast( 
-	PackedVertex & packed, 
-	std::map<PackedVertex,unsigned short> & VertexToOutIndex,
-	unsigned short & result
+	std::vector<unsigned short> & out_indices,
+	std::vector<glm::vec3> & out_vertices,
+	std::vector<glm::vec2> & out_uvs,
+	std::vector<glm::vec3> & out_normals
 ){
-	std::map<PackedVertex,unsigned short>::iterator it = VertexToOutIndex.find(packed);
-	if ( it == VertexToOutIndex.end() ){
-		return false;
-	}else{
-		result = it->second;
-		return true;
-	}
+	IndexVBOSimilar(in_vertices, in_uvs, in_normals, out_indices, out_vertices, out_uvs, out_normals);
 }
 
-void indexVBO(
+void indexVBO_slow(
 	std::vector<glm::vec3> & in_vertices,
 	std::vector<glm::vec2> & in_uvs,
 	std::vector<glm::vec3> & in_normals,
 
-	std::vector<unsigned short> & out_indices,
+	std::vector<unsigned int> & out_indices,
+	std::vector<glm::vec3> & out_vertices,
+	std::vector<glm::vec2> & out_uvs,
+	std::vector<glm::vec3> & out_normals
+){
+	IndexVBOSimilar(in_vertices, in_uvs, in_normals, out_indices, out_vertices, out_uvs, out_normals);
+}
+
+template<class Index> static void IndexVBO(
+	std::vector<glm::vec3> & in_vertices,
+	std::vector<glm::vec2> & in_uvs,
+	std::vector<glm::vec3> & in_normals,
+
+	std::vector<Index> & out_indices,
 	std::vector<glm::vec3> & out_vertices,
 	std::vector<glm::vec2> & out_uvs,
 	std::vector<glm::vec3> & out_normals
 ){
-	std::map<PackedVertex,unsigned short> VertexToOutIndex;
+	// identical vertices (compared by their bytes)
+	VertexHashTable<PackedVertex> VertexToOutIndex(in_vertices.size());
+	bool inRange = true;
+	out_indices.reserve(out_indices.size() + in_vertices.size());
 
 	// For each input vertex
 	for ( unsigned int i=0; i<in_vertices.size(); i++ ){
 
 		PackedVertex packed = {in_vertices[i], in_uvs[i], in_normals[i]};
-		
 
 		// Try to find a similar vertex in out_XXXX
-		unsigned short index;
-		bool found = getSimilarVertexIndex_fast( packed, VertexToOutIndex, index);
+		uint32_t index = VertexToOutIndex.find(packed);
 
-		if ( found ){ // A similar vertex is already in the VBO, use it instead !
-			out_indices.push_back( index );
+		if ( index != VertexHashTable<PackedVertex>::EMPTY ){ // A similar vertex is already in the VBO, use it instead !
+			out_indices.push_back( (Index)index );
 		}else{ // If not, it needs to be added in the output data.
 			out_vertices.push_back( in_vertices[i]);
 			out_uvs     .push_back( in_uvs[i]);
 			out_normals .push_back( in_normals[i]);
-			unsigned short newindex = (unsigned short)out_vertices.size() - 1;
-			out_indices .push_back( newindex );
-			VertexToOutIndex[ packed ] = newindex;
+			uint32_t newindex = (uint32_t)out_vertices.size() - 1;
+			if (inRange) inRange = CheckIndexRange<Index>(out_vertices.size());
+			out_indices .push_back( (Index)newindex );
+			VertexToOutIndex.set( packed, newindex );
 		}
 	}
 }
 
+void indexVBO(
+	std::vector<glm::vec3> & in_vertices,
+	std::vector<glm::vec2> & in_uvs,
+	std::vector<glm::vec3> & in_normals,
+
+	std::vector<unsigned short> & out_indices,
+	std::vector<glm::vec3> & out_vertices,
+	std::vector<glm::vec2> & out_uvs,
+	std::vector<glm::vec3> & out_normals
+){
+	IndexVBO(in_vertices, in_uvs, in_normals, out_indices, out_vertices, out_uvs, out_normals);
+}
+
+void indexVBO(
+	std::vector<glm::vec3> & in_vertices,
+	std::vector<glm::vec2> & in_uvs,
+	std::vector<glm::vec3> & in_normals,
+
+	std::vector<unsigned int> & out_indices,
+	std::vector<glm::vec3> & out_vertices,
+	std::vector<glm::vec2> & out_uvs,
+	std::vector<glm::vec3> & out_normals
+){
+	IndexVBO(in_vertices, in_uvs, in_normals, out_indices, out_vertices, out_uvs, out_normals);
+}
+
 
 
 
 
 
 
-void indexVBO_TBN(
+template<class Index> static void IndexVBO_TBN(
 	std::vector<glm::vec3> & in_vertices,
 	std::vector<glm::vec2> & in_uvs,
 	std::vector<glm::vec3> & in_normals,
 	std::vector<glm::vec3> & in_tangents,
 	std::vector<glm::vec3> & in_bitangents,
 
-	std::vector<unsigned short> & out_indices,
+	std::vector<Index> & out_indices,
 	std::vector<glm::vec3> & out_vertices,
 	std::vector<glm::vec2> & out_uvs,
 	std::vector<glm::vec3> & out_normals,
 	std::vector<glm::vec3> & out_tangents,
 	std::vector<glm::vec3> & out_bitangents
 ){
+	// the vertices already in out_XXXX are used too
+	SimilarVertexIndex similar(out_vertices.size() + in_vertices.size());
+	for ( unsigned int i=0; i<out_vertices.size(); i++ ) similar.add( out_vertices[i] );
+	bool inRange = true;
+	out_indices.reserve(out_indices.size() + in_vertices.size());
+
 	// For each input vertex
 	for ( unsigned int i=0; i<in_vertices.size(); i++ ){
 
 		// Try to find a similar vertex in out_XXXX
-		unsigned short index;
-		bool found = getSimilarVertexIndex(in_vertices[i], in_uvs[i], in_normals[i],     out_vertices, out_uvs, out_normals, index);
+		uint32_t index = similar.find(in_vertices[i], in_uvs[i], in_normals[i],     out_vertices, out_uvs, out_normals);
 
-		if ( found ){ // A similar vertex is already in the VBO, use it instead !
-			out_indices.push_back( index );
+		if ( index != VertexHashTable<PositionCell>::EMPTY ){ // A similar vertex is already in the VBO, use it instead !
+			out_indices.push_back( (Index)index );
 
 			// Average the tangents and the bitangents
 			out_tangents[index] += in_tangents[i];
@@ -171,7 +346,43 @@ void indexVBO_TBN(
 			out_normals .push_back( in_normals[i]);
 			out_tangents .push_back( in_tangents[i]);
 			out_bitangents .push_back( in_bitangents[i]);
-			out_indices .push_back( (unsigned short)out_vertices.size() - 1 );
+			similar.add( in_vertices[i] );
+			if (inRange) inRange = CheckIndexRange<Index>(out_vertices.size());
+			out_indices .push_back( (Index)(out_vertices.size() - 1) );
 		}
 	}
 }
+
+void indexVBO_TBN(
+	std::vector<glm::vec3> & in_vertices,
+	std::vector<glm::vec2> & in_uvs,
+	std::vector<glm::vec3> & in_normals,
+	std::vector<glm::vec3> & in_tangents,
+	std::vector<glm::vec3> & in_bitangents,
+
+	std::vector<unsigned short> & out_indices,
+	std::vector<glm::vec3> & out_vertices,
+	std::vector<glm::vec2> & out_uvs,
+	std::vector<glm::vec3> & out_normals,
+	std::vector<glm::vec3> & out_tangents,
+	std::vector<glm::vec3> & out_bitangents
+){
+	IndexVBO_TBN(in_vertices, in_uvs, in_normals, in_tangents, in_bitangents, out_indices, out_vertices, out_uvs, out_normals, out_tangents, out_bitangents);
+}
+
+void indexVBO_TBN(
+	std::vector<glm::vec3> & in_vertices,
+	std::vector<glm::vec2> & in_uvs,
+	std::vector<glm::vec3> & in_normals,
+	std::vector<glm::vec3> & in_tangents,
+	std::vector<glm::vec3> & in_bitangents,
+
+	std::vector<unsigned int> & out_indices,
+	std::vector<glm::vec3> & out_vertices,
+	std::vector<glm::vec2> & out_uvs,
+	std::vector<glm::vec3> & out_normals,
+	std::vector<glm::vec3> & out_tangents,
+	std::vector<glm::vec3> & out_bitangents
+){
+	IndexVBO_TBN(in_vertices, in_uvs, in_normals, in_tangents, in_bitangents, out_indices, out_vertices, out_uvs, out_normals, out_tangents, out_bitangents);
+}
@@ -0,0 +1,243 @@
+#include <vector>
+#include <math.h>
+#include <stdint.h>
+
+#include <glm/glm.hpp>
+
+#include "vertexcache.hpp"
+
+// Size of the simulated LRU cache of the optimisation (the scores decay with the position, so the order suits smaller caches too)
+static const int OPTIMIZER_CACHE_SIZE = 32;
+// Scores of Tom Forsyth's "Linear-Speed Vertex Cache Optimisation"
+static const float CACHE_DECAY_POWER = 1.5f;
+static const float LAST_TRIANGLE_SCORE = 0.75f;
+static const float VALENCE_BOOST_SCALE = 2.0f;
+static const float VALENCE_BOOST_POWER = 0.5f;
+// Valences beyond the table get the score of the last entry
+static const int MAX_SCORED_VALENCE = 64;
+
+static const uint32_t NOT_CACHED = 0xFFFFFFFF;
+
+// Precomputed scores of the cache positions and the remaining valences
+struct VertexScoreTable {
+	float cache[OPTIMIZER_CACHE_SIZE];
+	float valence[MAX_SCORED_VALENCE + 1];
+
+	VertexScoreTable() {
+		for (int i = 0; i < OPTIMIZER_CACHE_SIZE; i++) {
+			// the vertices of the last triangle get a fixed score, so it's vertices aren't preferred in any order
+			cache[i] = i < 3 ? LAST_TRIANGLE_SCORE : powf(1.0f - (float)(i - 3) / (OPTIMIZER_CACHE_SIZE - 3), CACHE_DECAY_POWER);
+		}
+		valence[0] = 0.0f;
+		for (int i = 1; i <= MAX_SCORED_VALENCE; i++) {
+			// vertices with few remaining triangles are preferred, so they leave the cache sooner
+			valence[i] = VALENCE_BOOST_SCALE * powf((float)i, -VALENCE_BOOST_POWER);
+		}
+	}
+
+	float get(uint32_t cachePosition, uint32_t remainingValence) const {
+		if (remainingValence == 0) return -1.0f;
+		float score = cachePosition != NOT_CACHED ? cache[cachePosition] : 0.0f;
+		return score + valence[remainingValence < MAX_SCORED_VALENCE ? remainingValence : MAX_SCORED_VALENCE];
+	}
+};
+
+template<class Index> static VertexCacheStatistics AnalyzeVertexCache(const std::vector<Index> & indices, size_t vertex_count, unsigned int cache_size){
+	// a vertex is in the FIFO cache if less than 'cache_size' vertices were transformed after it
+	std::vector<uint32_t> transformedAt(vertex_count, 0);
+	uint32_t time = cache_size + 1;
+	unsigned int used = 0;
+	VertexCacheStatistics statistics = { 0, 0.0f, 0.0f };
+	for (size_t i = 0; i < indices.size(); i++) {
+		uint32_t & transformed = transformedAt[indices[i]];
+		if (time - transformed > cache_size) {
+			if (transformed == 0) used++;
+			transformed = time++;
+			statistics.transformed++;
+		}
+	}
+	if (indices.size() >= 3) statistics.acmr = (float)statistics.transformed / (indices.size() / 3);
+	if (used > 0) statistics.atvr = (float)statistics.transformed / used;
+	return statistics;
+}
+
+VertexCacheStatistics analyzeVertexCache(const std::vector<unsigned short> & indices, size_t vertex_count, unsigned int cache_size){
+	return AnalyzeVertexCache(indices, vertex_count, cache_size);
+}
+
+VertexCacheStatistics analyzeVertexCache(const std::vector<unsigned int> & indices, size_t vertex_count, unsigned int cache_size){
+	return AnalyzeVertexCache(indices, vertex_count, cache_size);
+}
+
+template<class Index> static void OptimizeVertexCache(std::vector<Index> & indices, size_t vertex_count){
+	static const VertexScoreTable scores;
+	const size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0) return;
+
+	// triangles of every vertex (the triangles that weren't added yet are kept at the start of a vertex's list)
+	std::vector<uint32_t> remaining(vertex_count, 0);
+	for (size_t i = 0; i < triangleCount * 3; i++) remaining[indices[i]]++;
+	std::vector<uint32_t> offsets(vertex_count + 1, 0);
+	for (size_t v = 0; v < vertex_count; v++) offsets[v + 1] = offsets[v] + remaining[v];
+	std::vector<uint32_t> adjacency(triangleCount * 3);
+	{
+		std::vector<uint32_t> filled(offsets.begin(), offsets.end() - 1);
+		for (size_t i = 0; i < triangleCount * 3; i++) adjacency[filled[indices[i]]++] = (uint32_t)(i / 3);
+	}
+
+	std::vector<uint32_t> cachePositions(vertex_count, NOT_CACHED);
+	std::vector<float> vertexScores(vertex_count);
+	for (size_t v = 0; v < vertex_count; v++) vertexScores[v] = scores.get(NOT_CACHED, remaining[v]);
+	auto getTriangleScore = [&](size_t t) {
+		return vertexScores[indices[3 * t]] + vertexScores[indices[3 * t + 1]] + vertexScores[indices[3 * t + 2]];
+	};
+	std::vector<bool> added(triangleCount, false);
+
+	// the first triangle is the best one, later ones are the best triangle of the cached vertices
+	uint32_t best = 0;
+	float bestScore = getTriangleScore(0);
+	for (size_t t = 1; t < triangleCount; t++) {
+		float score = getTriangleScore(t);
+		if (score > bestScore) {
+			bestScore = score;
+			best = (uint32_t)t;
+		}
+	}
+
+	std::vector<Index> output;
+	output.reserve(triangleCount * 3);
+	uint32_t cache[OPTIMIZER_CACHE_SIZE + 3];
+	uint32_t cacheSize = 0;
+	// next triangle in input order that's tried if no cached vertex has a triangle left
+	size_t nextInputTriangle = 0;
+	while (true) {
+		if (best == NOT_CACHED) {
+			while (nextInputTriangle < triangleCount && added[nextInputTriangle]) nextInputTriangle++;
+			if (nextInputTriangle == triangleCount) break;
+			best = (uint32_t)nextInputTriangle;
+		}
+		added[best] = true;
+		const Index * triangle = &indices[3 * best];
+		output.insert(output.end(), triangle, triangle + 3);
+
+		// removing the triangle from it's vertices
+		for (int i = 0; i < 3; i++) {
+			uint32_t v = triangle[i];
+			uint32_t * list = &adjacency[offsets[v]];
+			for (uint32_t j = 0; j < remaining[v]; j++) {
+				if (list[j] == best) {
+					list[j] = list[remaining[v] - 1];
+					break;
+				}
+			}
+			remaining[v]--;
+		}
+
+		// the triangle's vertices move to the front of the cache (the last ones may leave the cache)
+		uint32_t newCache[OPTIMIZER_CACHE_SIZE + 3];
+		uint32_t newCacheSize = 0;
+		for (int i = 0; i < 3; i++) {
+			// a degenerate triangle uses a vertex more than once
+			uint32_t v = triangle[i];
+			bool duplicate = false;
+			for (uint32_t j = 0; j < newCacheSize; j++) duplicate = duplicate || newCache[j] == v;
+			if (!duplicate) newCache[newCacheSize++] = v;
+		}
+		for (uint32_t i = 0; i < cacheSize; i++) {
+			uint32_t v = cache[i];
+			if (v != triangle[0] && v != triangle[1] && v != triangle[2]) newCache[newCacheSize++] = v;
+		}
+		for (uint32_t i = 0; i < newCacheSize; i++) {
+			uint32_t v = newCache[i];
+			cachePositions[v] = i < OPTIMIZER_CACHE_SIZE ? i : NOT_CACHED;
+			vertexScores[v] = scores.get(cachePositions[v], remaining[v]);
+		}
+
+		// the best triangle of the vertices whose score changed is added next (the other triangles' scores didn't change)
+		best = NOT_CACHED;
+		bestScore = -1.0f;
+		for (uint32_t i = 0; i < newCacheSize; i++) {
+			uint32_t v = newCache[i];
+			for (uint32_t j = 0; j < remaining[v]; j++) {
+				uint32_t t = adjacency[offsets[v] + j];
+				float score = getTriangleScore(t);
+				if (score > bestScore) {
+					bestScore = score;
+					best = t;
+				}
+			}
+		}
+		cacheSize = newCacheSize < OPTIMIZER_CACHE_SIZE ? newCacheSize : OPTIMIZER_CACHE_SIZE;
+		for (uint32_t i = 0; i < cacheSize; i++) cache[i] = newCache[i];
+	}
+	// a trailing incomplete triangle is kept
+	output.insert(output.end(), indices.begin() + triangleCount * 3, indices.end());
+	indices.swap(output);
+}
+
+void optimizeVertexCache(std::vector<unsigned short> & indices, size_t vertex_count){
+	OptimizeVertexCache(indices, vertex_count);
+}
+
+void optimizeVertexCache(std::vector<unsigned int> & indices, size_t vertex_count){
+	OptimizeVertexCache(indices, vertex_count);
+}
+
+// Renumbers the vertices in the order of their first use, returns the number of used vertices
+template<class Index> static size_t RemapIndices(std::vector<Index> & indices, size_t vertex_count, std::vector<uint32_t> & remap){
+	remap.assign(vertex_count, NOT_CACHED);
+	uint32_t next = 0;
+	for (size_t i = 0; i < indices.size(); i++) {
+		uint32_t & index = remap[indices[i]];
+		if (index == NOT_CACHED) index = next++;
+		indices[i] = (Index)index;
+	}
+	return next;
+}
+
+// Moves the attributes to their new positions
+template<class T> static void RemapAttribute(std::vector<T> & attribute, const std::vector<uint32_t> & remap, size_t used){
+	std::vector<T> remapped(used);
+	for (size_t v = 0; v < attribute.size() && v < remap.size(); v++) {
+		if (remap[v] != NOT_CACHED) remapped[remap[v]] = attribute[v];
+	}
+	attribute.swap(remapped);
+}
+
+void optimizeVertexFetch(std::vector<unsigned short> & indices, std::vector<glm::vec3> & vertices, std::vector<glm::vec2> & uvs, std::vector<glm::vec3> & normals){
+	std::vector<uint32_t> remap;
+	size_t used = RemapIndices(indices, vertices.size(), remap);
+	RemapAttribute(vertices, remap, used);
+	RemapAttribute(uvs, remap, used);
+	RemapAttribute(normals, remap, used);
+}
+
+void optimizeVertexFetch(std::vector<unsigned int> & indices, std::vector<glm::vec3> & vertices, std::vector<glm::vec2> & uvs, std::vector<glm::vec3> & normals){
+	std::vector<uint32_t> remap;
+	size_t used = RemapIndices(indices, vertices.size(), remap);
+	RemapAttribute(vertices, remap, used);
+	RemapAttribute(uvs, remap, used);
+	RemapAttribute(normals, remap, used);
+}
+
+void optimizeVertexFetch_TBN(std::vector<unsigned short> & indices, std::vector<glm::vec3> & vertices, std::vector<glm::vec2> & uvs, std::vector<glm::vec3> & normals,
+	std::vector<glm::vec3> & tangents, std::vector<glm::vec3> & bitangents){
+	std::vector<uint32_t> remap;
+	size_t used = RemapIndices(indices, vertices.size(), remap);
+	RemapAttribute(vertices, remap, used);
+	RemapAttribute(uvs, remap, used);
+	RemapAttribute(normals, remap, used);
+	RemapAttribute(tangents, remap, used);
+	RemapAttribute(bitangents, remap, used);
+}
+
+void optimizeVertexFetch_TBN(std::vector<unsigned int> & indices, std::vector<glm::vec3> & vertices, std::vector<glm::vec2> & uvs, std::vector<glm::vec3> & normals,
+	std::vector<glm::vec3> & tangents, std::vector<glm::vec3> & bitangents){
+	std::vector<uint32_t> remap;
+	size_t used = RemapIndices(indices, vertices.size(), remap);
+	RemapAttribute(vertices, remap, used);
+	RemapAttribute(uvs, remap, used);
+	RemapAttribute(normals, remap, used);
+	RemapAttribute(tangents, remap, used);
+	RemapAttribute(bitangents, remap, used);
+}
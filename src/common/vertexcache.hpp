@@ -0,0 +1,71 @@
+#ifndef VERTEXCACHE_HPP
+#define VERTEXCACHE_HPP
+
+// Optional stage after indexVBO / indexVBO_TBN: reorders the triangles for the post-transform vertex cache of the GPU
+// (optimizeVertexCache), then the vertices in the order of their first use (optimizeVertexFetch).
+
+// Post-transform cache statistics of indexed triangles (simulated FIFO cache)
+struct VertexCacheStatistics {
+	// transformed vertices (cache misses)
+	unsigned int transformed;
+	// average cache miss ratio: transformed vertices per triangle (0.5 is the optimum of a regular grid, 3 the worst case)
+	float acmr;
+	// average transform to vertex ratio: transformed vertices per used vertex (1 is the optimum)
+	float atvr;
+};
+
+// Simulates a FIFO cache of 'cache_size' vertices
+VertexCacheStatistics analyzeVertexCache(
+	const std::vector<unsigned short> & indices,
+	size_t vertex_count,
+	unsigned int cache_size = 16
+);
+VertexCacheStatistics analyzeVertexCache(
+	const std::vector<unsigned int> & indices,
+	size_t vertex_count,
+	unsigned int cache_size = 16
+);
+
+// Reorders the triangles (Tom Forsyth's linear-speed vertex cache optimisation), the vertices aren't changed
+void optimizeVertexCache(
+	std::vector<unsigned short> & indices,
+	size_t vertex_count
+);
+void optimizeVertexCache(
+	std::vector<unsigned int> & indices,
+	size_t vertex_count
+);
+
+// Reorders the vertices in the order of their first use by the triangles (unused vertices are removed)
+void optimizeVertexFetch(
+	std::vector<unsigned short> & indices,
+	std::vector<glm::vec3> & vertices,
+	std::vector<glm::vec2> & uvs,
+	std::vector<glm::vec3> & normals
+);
+void optimizeVertexFetch(
+	std::vector<unsigned int> & indices,
+	std::vector<glm::vec3> & vertices,
+	std::vector<glm::vec2> & uvs,
+	std::vector<glm::vec3> & normals
+);
+
+// Same for the output of indexVBO_TBN
+void optimizeVertexFetch_TBN(
+	std::vector<unsigned short> & indices,
+	std::vector<glm::vec3> & vertices,
+	std::vector<glm::vec2> & uvs,
+	std::vector<glm::vec3> & normals,
+	std::vector<glm::vec3> & tangents,
+	std::vector<glm::vec3> & bitangents
+);
+void optimizeVertexFetch_TBN(
+	std::vector<unsigned int> & indices,
+	std::vector<glm::vec3> & vertices,
+	std::vector<glm::vec2> & uvs,
+	std::vector<glm::vec3> & normals,
+	std::vector<glm::vec3> & tangents,
+	std::vector<glm::vec3> & bitangents
+);
+
+#endif
@@ -0,0 +1,282 @@
+#include "bitBoard.h"
+#include <algorithm>
+#include <memory>
+#include <string.h>
+
+using namespace gameData;
+
+namespace gameUtils {
+
+	//range of brick offsets that are considered during the search of final locations
+	constexpr int MIN_OFFSET = -3;
+	constexpr int RANGE_X = fieldX + 6, RANGE_Y = fieldY + 7;
+	constexpr int STATE_COUNT = 4 * RANGE_X * RANGE_Y;
+
+	BitBoard::BitBoard() {
+		memset(rows, 0, sizeof(rows));
+	}
+
+	BitBoard BitBoard::fromField(GameField& field) {
+		BitBoard board;
+		for (int y = 0; y < fieldY; y++) {
+			board.rows[y] = field.getRowMask(y);
+		}
+		return board;
+	}
+
+	bool BitBoard::collides(const int type, const int x, const int y, const int rotation) const {
+		const BrickMask& mask = getBrickMask(type, rotation);
+		for (int by = 0; by < mask.size; by++) {
+			uint32_t row = mask.rows[by];
+			//empty brick-rows and brick-rows above the field never overlap
+			if (row == 0 || y + by >= fieldY) continue;
+			if (y + by < 0) return true;
+			//translating the row to the brick's offset (fields that are moved out of the field on the left side overlap)
+			if (x < 0) {
+				if (row & ((1u << -x) - 1)) return true;
+				row >>= -x;
+			}
+			else row <<= x;
+			//checking the right boundary and the fields of the board
+			if ((row & ~(uint32_t)FULL_ROW) || (row & rows[y + by])) return true;
+		}
+		return false;
+	}
+
+	int BitBoard::place(const int type, const Placement& placement) {
+		const BrickMask& mask = getBrickMask(type, placement.rotation);
+		for (int by = 0; by < mask.size; by++) {
+			int y = placement.y + by;
+			if (mask.rows[by] == 0 || y < 0 || y >= fieldY) continue;
+			rows[y] |= placement.x < 0 ? mask.rows[by] >> -placement.x : mask.rows[by] << placement.x;
+		}
+		//removing filled rows (all other rows are moved downwards)
+		int target = 0;
+		for (int y = 0; y < fieldY; y++) {
+			if (rows[y] == FULL_ROW) continue;
+			rows[target++] = rows[y];
+		}
+		for (int y = target; y < fieldY; y++) {
+			rows[y] = 0;
+		}
+		return fieldY - target;
+	}
+
+	int BitBoard::getHeight() const {
+		for (int y = fieldY - 1; y >= 0; y--) {
+			if (rows[y]) return y + 1;
+		}
+		return 0;
+	}
+
+	int BitBoard::getCount() const {
+		int count = 0;
+		for (int y = 0; y < fieldY; y++) {
+			for (Row row = rows[y]; row; row &= row - 1) count++;
+		}
+		return count;
+	}
+
+	bool BitBoard::isEmpty() const {
+		for (int y = 0; y < fieldY; y++) {
+			if (rows[y]) return false;
+		}
+		return true;
+	}
+
+	void getStartLocation(const int type, int* x, int* y) {
+		//same calculation as in BrickDroppingField::startBrick (centered above the field, dropped by the empty bottom rows)
+		const BrickMask& mask = getBrickMask(type, 0);
+		*x = fieldX / 2 - mask.size / 2 - mask.size % 2;
+		*y = fieldY;
+		for (int by = 0; by < mask.size && mask.rows[by] == 0; by++) {
+			(*y)--;
+		}
+	}
+
+	//index of a brick state in the arrays of searchLocations
+	static inline int getStateIndex(const int x, const int y, const int rotation) {
+		return (rotation * RANGE_Y + y - MIN_OFFSET) * RANGE_X + x - MIN_OFFSET;
+	}
+
+	/*
+	* breadth-first search of every brick state that is reachable from the initial location
+	* @param board the board the brick is dropped on
+	* @param type brick's type
+	* @param parents array of STATE_COUNT values, the index of the previous state of every reached state will be applied to (-1 if not reached)
+	* @param moves array of STATE_COUNT values, the movement that leads to every reached state will be applied to (may be nullptr)
+	* @param locks vector, the indices of every reached state that can't be moved down will be added to
+	* @param seeds states to start with instead of the initial location (may be nullptr, their parents are set to themselves)
+	* @param kicks kick table of the rotations
+	*/
+	static void searchLocations(const BitBoard& board, const int type, int16_t* parents, int8_t* moves, std::vector<int16_t>& locks, const std::vector<int16_t>* seeds, const KickTable& kicks) {
+		memset(parents, -1, STATE_COUNT * sizeof(int16_t));
+
+		int16_t queue[STATE_COUNT];
+		int queueStart = 0, queueEnd = 0;
+
+		if (seeds != nullptr) {
+			for (int16_t seed : *seeds) {
+				parents[seed] = seed;
+				queue[queueEnd++] = seed;
+			}
+		}
+		else {
+			int x, y;
+			getStartLocation(type, &x, &y);
+			if (board.collides(type, x, y, 0)) return;
+			int16_t start = (int16_t)getStateIndex(x, y, 0);
+			parents[start] = start;
+			queue[queueEnd++] = start;
+		}
+
+		while (queueStart < queueEnd) {
+			const int16_t index = queue[queueStart++];
+			const int rotation = index / (RANGE_X * RANGE_Y);
+			const int by = (index / RANGE_X) % RANGE_Y + MIN_OFFSET;
+			const int bx = index % RANGE_X + MIN_OFFSET;
+
+			//candidate states: moving down, left, right and rotating right, left
+			int nx[5], ny[5], nr[5], move[5], count = 0;
+			if (!board.collides(type, bx, by - 1, rotation)) {
+				nx[count] = bx; ny[count] = by - 1; nr[count] = rotation; move[count++] = BrickDroppingField::TYPE_MOVE_DOWN;
+			}
+			else locks.push_back(index);
+			if (!board.collides(type, bx - 1, by, rotation)) {
+				nx[count] = bx - 1; ny[count] = by; nr[count] = rotation; move[count++] = BrickDroppingField::TYPE_MOVE_LEFT;
+			}
+			if (!board.collides(type, bx + 1, by, rotation)) {
+				nx[count] = bx + 1; ny[count] = by; nr[count] = rotation; move[count++] = BrickDroppingField::TYPE_MOVE_RIGHT;
+			}
+			for (int direction = BrickDroppingField::TYPE_ROTATE_LEFT; direction <= BrickDroppingField::TYPE_ROTATE_RIGHT; direction++) {
+				const bool right = direction == BrickDroppingField::TYPE_ROTATE_RIGHT;
+				const int r = right ? (rotation + 1) % 4 : (rotation + 3) % 4;
+				const int transition = getKickTransition(rotation, right);
+				//the first translation without overlapping is applied (like BrickDroppingField::canRotateBrick)
+				for (int i = 0; i < kicks.counts[type][transition]; i++) {
+					const int kx = bx + kicks.dx[type][transition][i], ky = by + kicks.dy[type][transition][i];
+					if (!board.collides(type, kx, ky, r)) {
+						nx[count] = kx; ny[count] = ky; nr[count] = r; move[count++] = direction;
+						break;
+					}
+				}
+			}
+
+			for (int i = 0; i < count; i++) {
+				if (nx[i] < MIN_OFFSET || nx[i] >= MIN_OFFSET + RANGE_X || ny[i] < MIN_OFFSET || ny[i] >= MIN_OFFSET + RANGE_Y) continue;
+				int16_t next = (int16_t)getStateIndex(nx[i], ny[i], nr[i]);
+				if (parents[next] != -1) continue;
+				parents[next] = index;
+				if (moves != nullptr) moves[next] = (int8_t)move[i];
+				queue[queueEnd++] = next;
+			}
+		}
+	}
+
+	/*
+	* states of every brick that are reachable on an empty board, grouped by their y-offset
+	* without vertical kicks a brick never moves upwards, so every state above the highest non-empty row of a board is reachable
+	* exactly if it's reachable on an empty board (the search can start at the row above the board's content)
+	*/
+	struct EmptyBoardStates {
+		std::vector<int16_t> states[brickCount][RANGE_Y];
+		EmptyBoardStates(const KickTable& kicks) {
+			BitBoard board;
+			int16_t parents[STATE_COUNT];
+			std::vector<int16_t> locks;
+			for (int type = 0; type < brickCount; type++) {
+				searchLocations(board, type, parents, nullptr, locks, nullptr, kicks);
+				for (int index = 0; index < STATE_COUNT; index++) {
+					if (parents[index] != -1) {
+						states[type][(index / RANGE_X) % RANGE_Y].push_back((int16_t)index);
+					}
+				}
+			}
+		}
+	};
+
+	/*
+	* get the states reachable on an empty board
+	* the states are calculated once per thread and kick table (the table of the previous call is cached)
+	* @param kicks kick table of the rotations (without vertical translations)
+	*/
+	static const EmptyBoardStates& getEmptyBoardStates(const KickTable& kicks) {
+		thread_local const KickTable* cachedKicks = nullptr;
+		thread_local std::unique_ptr<EmptyBoardStates> cachedStates;
+		if (cachedKicks != &kicks) {
+			cachedStates.reset(new EmptyBoardStates(kicks));
+			cachedKicks = &kicks;
+		}
+		return *cachedStates;
+	}
+
+	void generatePlacements(const BitBoard& board, const int type, std::vector<Placement>& placements, const KickTable& kicks) {
+		int16_t parents[STATE_COUNT];
+		std::vector<int16_t> locks;
+
+		//starting at the row above the board's content if the initial location is above it (only possible without vertical kicks)
+		int x, y;
+		getStartLocation(type, &x, &y);
+		const int height = board.getHeight();
+		if (height < y && !kicks.vertical) {
+			searchLocations(board, type, parents, nullptr, locks, &getEmptyBoardStates(kicks).states[type][height - MIN_OFFSET], kicks);
+		}
+		else searchLocations(board, type, parents, nullptr, locks, nullptr, kicks);
+
+		//fields covered by the placements that were added (to skip duplicates)
+		std::vector<uint64_t> covered;
+		for (int16_t index : locks) {
+			Placement placement;
+			placement.rotation = (int8_t)(index / (RANGE_X * RANGE_Y));
+			placement.y = (int8_t)((index / RANGE_X) % RANGE_Y + MIN_OFFSET);
+			placement.x = (int8_t)(index % RANGE_X + MIN_OFFSET);
+
+			//calculating the covered fields, skipping the placement if the brick isn't completely inside the field
+			const BrickMask& mask = getBrickMask(type, placement.rotation);
+			uint64_t fields = 0;
+			int lowest = -1;
+			bool inField = true;
+			for (int by = 0; by < mask.size; by++) {
+				if (mask.rows[by] == 0) continue;
+				if (placement.y + by >= fieldY) inField = false;
+				if (lowest == -1) lowest = by;
+				uint64_t row = placement.x < 0 ? mask.rows[by] >> -placement.x : mask.rows[by] << placement.x;
+				fields |= row << (16 * (by - lowest));
+			}
+			if (!inField) continue;
+			fields |= (uint64_t)(placement.y + lowest) << 58;
+
+			bool duplicate = false;
+			for (uint64_t c : covered) {
+				if (c == fields) {
+					duplicate = true;
+					break;
+				}
+			}
+			if (duplicate) continue;
+			covered.push_back(fields);
+			placements.push_back(placement);
+		}
+	}
+
+	bool findPath(const BitBoard& board, const int type, const Placement& placement, std::vector<int>& moves, const KickTable& kicks) {
+		int16_t parents[STATE_COUNT];
+		int8_t stateMoves[STATE_COUNT];
+		std::vector<int16_t> locks;
+		searchLocations(board, type, parents, stateMoves, locks, nullptr, kicks);
+
+		if (placement.x < MIN_OFFSET || placement.x >= MIN_OFFSET + RANGE_X || placement.y < MIN_OFFSET || placement.y >= MIN_OFFSET + RANGE_Y) return false;
+		int16_t index = (int16_t)getStateIndex(placement.x, placement.y, placement.rotation);
+		if (parents[index] == -1) return false;
+
+		//following the parents back to the initial location
+		size_t first = moves.size();
+		while (parents[index] != index) {
+			moves.push_back(stateMoves[index]);
+			index = parents[index];
+		}
+		std::reverse(moves.begin() + first, moves.end());
+		return true;
+	}
+
+}
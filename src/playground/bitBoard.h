@@ -0,0 +1,114 @@
+#ifndef BIT_BOARD_H
+#define BIT_BOARD_H
+
+#include <vector>
+#include <type_traits>
+#include <stdint.h>
+#include "gameData.h"
+
+namespace gameUtils {
+
+	/*
+	* get the cells of a brick (see gameData::brickMasks)
+	* @param type brick's type
+	* @param rotation brick's rotation (0-3)
+	* @return the brick's mask
+	*/
+	inline const gameData::BrickMask& getBrickMask(const int type, const int rotation) {
+		return gameData::brickMasks[type][rotation];
+	}
+
+	/*
+	* final location of a brick
+	* (x, y) is the lower left corner of the brick's area like in BrickDroppingField
+	*/
+	struct Placement {
+		int8_t x, y, rotation;
+	};
+
+	/*
+	* packed representation of the static field (without the current brick)
+	* every row is stored as a bit mask (bit x is set if the field at x is not empty)
+	* collision checks follow the rules of BrickDroppingField::willOverlap: brick-fields above the field never overlap
+	*/
+	class BitBoard {
+	public:
+		typedef uint16_t Row;
+		static_assert(std::is_same<Row, gameData::GameField::RowMask>::value, "a row needs to fit into BitBoard::Row");
+		//mask of a completely filled row
+		static const Row FULL_ROW = (1 << gameData::fieldX) - 1;
+		//rows of the field (row 0 is the bottom row)
+		Row rows[gameData::fieldY];
+		/*
+		* constructs an empty board
+		*/
+		BitBoard();
+		/*
+		* constructs a board from the values of a field
+		* @param field the field that is packed
+		*/
+		static BitBoard fromField(gameData::GameField& field);
+		/*
+		* check if a brick-configuration overlaps with the board or the field's boundaries
+		* @param type brick's type
+		* @param x, y brick's offset
+		* @param rotation brick's rotation
+		* @return whether the configuration overlaps or not
+		*/
+		bool collides(const int type, const int x, const int y, const int rotation) const;
+		/*
+		* place a brick and remove every filled row afterwards (rows above are moved downwards)
+		* @param type brick's type
+		* @param placement brick's location
+		* @return number of removed rows
+		*/
+		int place(const int type, const Placement& placement);
+		/*
+		* get the number of rows up to the highest non-empty row
+		* @return height of the board
+		*/
+		int getHeight() const;
+		/*
+		* get the number of non-empty fields
+		* @return number of fields
+		*/
+		int getCount() const;
+		/*
+		* check whether every row is empty
+		* @return if the board is empty
+		*/
+		bool isEmpty() const;
+	};
+
+	/*
+	* calculate the initial location of a brick (the same location BrickDroppingField::startBrick uses)
+	* @param type brick's type
+	* @param x, y ints, the brick's offset will be applied to
+	*/
+	void getStartLocation(const int type, int* x, int* y);
+
+	/*
+	* calculate every final location that can be reached from the brick's initial location
+	* by moving (left, right, down) and rotating (left, right, including the kicks of BrickDroppingField::canRotateBrick)
+	* locations that leave parts of the brick above the field and duplicates covering the same fields are skipped
+	* @param board the board the brick is dropped on
+	* @param type brick's type
+	* @param placements vector, the final locations will be added to
+	* @param kicks kick table of the rotations (needs to equal the table of the BrickDroppingField)
+	*/
+	void generatePlacements(const BitBoard& board, const int type, std::vector<Placement>& placements, const gameData::KickTable& kicks = gameData::KICKS_LEGACY);
+
+	/*
+	* calculate the movements that move a brick from it's initial to the given location
+	* @param board the board the brick is dropped on
+	* @param type brick's type
+	* @param placement the final location
+	* @param moves vector, the movement and rotation types of BrickDroppingField will be added to (TYPE_MOVE_DOWN, TYPE_ROTATE_LEFT, ...)
+	* @param kicks kick table of the rotations (needs to equal the table of the BrickDroppingField)
+	* @return whether the location can be reached or not
+	*/
+	bool findPath(const BitBoard& board, const int type, const Placement& placement, std::vector<int>& moves, const gameData::KickTable& kicks = gameData::KICKS_LEGACY);
+
+}
+
+#endif
@@ -0,0 +1,104 @@
+#include "bot.h"
+#include "placementTable.h"
+#include <float.h>
+#include <stdlib.h>
+#include <vector>
+
+using namespace gameData;
+
+namespace gameUtils {
+
+	//weights of the board's properties in evaluate()
+	static const double WEIGHT_HEIGHT = -0.510066;
+	static const double WEIGHT_ROWS = 0.760666;
+	static const double WEIGHT_HOLES = -0.35663;
+	static const double WEIGHT_BUMPINESS = -0.184483;
+	//rating of a combination where the next brick can't be placed anymore
+	static const double RATING_GAME_OVER = -1e9;
+
+	Bot::Bot(const PlacementTable* _table, const KickTable* _kicks) : table(_table), kicks(_kicks) {
+	}
+
+	double Bot::evaluate(const BitBoard& board, const int rowCount) {
+		int heights[fieldX] = {};
+		int aggregateHeight = 0, holes = 0, bumpiness = 0;
+		//walking down from the highest row: 'covered' contains every column with a filled field above the current row
+		BitBoard::Row covered = 0;
+		for (int y = board.getHeight() - 1; y >= 0; y--) {
+			const BitBoard::Row row = board.rows[y];
+			for (BitBoard::Row top = row & ~covered; top; top &= top - 1) {
+				int x = 0;
+				while (!(top & (1 << x))) x++;
+				heights[x] = y + 1;
+				aggregateHeight += y + 1;
+			}
+			for (BitBoard::Row hole = covered & ~row; hole; hole &= hole - 1) holes++;
+			covered |= row;
+		}
+		for (int x = 1; x < fieldX; x++) {
+			bumpiness += abs(heights[x] - heights[x - 1]);
+		}
+		return WEIGHT_HEIGHT * aggregateHeight + WEIGHT_ROWS * rowCount + WEIGHT_HOLES * holes + WEIGHT_BUMPINESS * bumpiness;
+	}
+
+	double Bot::evaluateNext(const BitBoard& board, const int rowCount, const int nextBrick, const KickTable& kicks) {
+		std::vector<Placement> placements;
+		generatePlacements(board, nextBrick, placements, kicks);
+		double best = RATING_GAME_OVER;
+		for (const Placement& placement : placements) {
+			BitBoard next = board;
+			int nextRowCount = next.place(nextBrick, placement);
+			double rating = evaluate(next, rowCount + nextRowCount);
+			if (rating > best) best = rating;
+		}
+		return best;
+	}
+
+	bool Bot::search(const BitBoard& board, const int brick, const int nextBrick, Placement* placement, const KickTable& kicks) {
+		std::vector<Placement> placements;
+		generatePlacements(board, brick, placements, kicks);
+		double best = -DBL_MAX;
+		for (const Placement& candidate : placements) {
+			BitBoard next = board;
+			int rowCount = next.place(brick, candidate);
+			double rating = evaluateNext(next, rowCount, nextBrick, kicks);
+			if (rating > best) {
+				best = rating;
+				*placement = candidate;
+			}
+		}
+		return !placements.empty();
+	}
+
+	bool Bot::searchAll(const BitBoard& board, const int brick, Placement* placements, const KickTable& kicks) {
+		std::vector<Placement> candidates;
+		generatePlacements(board, brick, candidates, kicks);
+		double best[brickCount];
+		for (int nextBrick = 0; nextBrick < brickCount; nextBrick++) {
+			best[nextBrick] = -DBL_MAX;
+		}
+		//same order and comparison as in search(), so both functions choose the same placements
+		for (const Placement& candidate : candidates) {
+			BitBoard next = board;
+			int rowCount = next.place(brick, candidate);
+			for (int nextBrick = 0; nextBrick < brickCount; nextBrick++) {
+				double rating = evaluateNext(next, rowCount, nextBrick, kicks);
+				if (rating > best[nextBrick]) {
+					best[nextBrick] = rating;
+					placements[nextBrick] = candidate;
+				}
+			}
+		}
+		return !candidates.empty();
+	}
+
+	bool Bot::choose(const BitBoard& board, const int brick, const int nextBrick, Placement* placement) {
+		if (table != nullptr && table->lookup(board, brick, nextBrick, placement)) {
+			tableHits++;
+			return true;
+		}
+		searchCount++;
+		return search(board, brick, nextBrick, placement, *kicks);
+	}
+
+}
@@ -0,0 +1,94 @@
+#ifndef BOT_H
+#define BOT_H
+
+#include <stdint.h>
+#include "bitBoard.h"
+
+namespace gameUtils {
+
+	class PlacementTable;
+
+	/*
+	* class that chooses the placement of the current brick with a two-brick lookahead (current and next brick)
+	*
+	* every placement of the current brick is combined with every placement of the next brick and the resulting board is rated by evaluate()
+	* the placement of the current brick with the best combination is chosen (the first one if multiple combinations are rated equally)
+	* if a placement table is set, low boards are looked up in the table instead (the table stores the results of the same search)
+	*/
+	class Bot {
+		//precomputed placements (may be nullptr)
+		const PlacementTable* table;
+		//kick table of the rotations the placements are searched with
+		const gameData::KickTable* kicks;
+		//statistics (number of placements looked up in the table and number of searches)
+		uint64_t tableHits = 0, searchCount = 0;
+		/*
+		* rate the best placement of the next brick after the current brick was placed
+		* @param board the board after the current brick was placed
+		* @param rowCount number of rows removed by the current brick
+		* @param nextBrick type of the next brick
+		* @param kicks kick table of the rotations
+		* @return rating of the best combination
+		*/
+		static double evaluateNext(const BitBoard& board, const int rowCount, const int nextBrick, const gameData::KickTable& kicks);
+	public:
+		/*
+		* constructs a bot
+		* @param _table precomputed placements (may be nullptr, needs to be opened with the same kick table)
+		* @param _kicks kick table of the rotations (needs to equal the table of the BrickDroppingField)
+		*/
+		Bot(const PlacementTable* _table = nullptr, const gameData::KickTable* _kicks = &gameData::KICKS_LEGACY);
+		/*
+		* rate a board (aggregate height, holes and bumpiness are penalized, removed rows are rewarded)
+		* @param board the board to rate
+		* @param rowCount number of rows removed to reach the board
+		* @return rating of the board (higher is better)
+		*/
+		static double evaluate(const BitBoard& board, const int rowCount);
+		/*
+		* search the best placement of a brick (without looking at the table)
+		* @param board the board the brick is dropped on
+		* @param brick type of the current brick
+		* @param nextBrick type of the next brick
+		* @param placement the best placement will be applied to
+		* @param kicks kick table of the rotations
+		* @return whether the brick can be placed at all
+		*/
+		static bool search(const BitBoard& board, const int brick, const int nextBrick, Placement* placement, const gameData::KickTable& kicks = gameData::KICKS_LEGACY);
+		/*
+		* search the best placement of a brick for every type of the next brick (equals brickCount calls of search(), but generates every placement of the current brick only once)
+		* @param board the board the brick is dropped on
+		* @param brick type of the current brick
+		* @param placements array of brickCount placements, the best placement for every next brick will be applied to
+		* @param kicks kick table of the rotations
+		* @return whether the brick can be placed at all
+		*/
+		static bool searchAll(const BitBoard& board, const int brick, Placement* placements, const gameData::KickTable& kicks = gameData::KICKS_LEGACY);
+		/*
+		* choose the placement of a brick (looked up in the table if possible, searched otherwise)
+		* @param board the board the brick is dropped on
+		* @param brick type of the current brick
+		* @param nextBrick type of the next brick
+		* @param placement the chosen placement will be applied to
+		* @return whether the brick can be placed at all
+		*/
+		bool choose(const BitBoard& board, const int brick, const int nextBrick, Placement* placement);
+		/*
+		* get the number of placements that were looked up in the table
+		* @return number of table hits
+		*/
+		inline uint64_t getTableHits() {
+			return tableHits;
+		}
+		/*
+		* get the number of placements that were searched
+		* @return number of searches
+		*/
+		inline uint64_t getSearchCount() {
+			return searchCount;
+		}
+	};
+
+}
+
+#endif
@@ -0,0 +1,116 @@
+#include "brickGenerator.h"
+#include "gameData.h"
+
+using namespace gameData;
+
+namespace gameUtils {
+
+	//rotation used by xoshiro128**
+	static inline uint32_t rotl(const uint32_t x, const int k) {
+		return (x << k) | (x >> (32 - k));
+	}
+
+	BrickGenerator::BrickGenerator(const uint64_t seed, const int _mode) :mode(_mode) {
+		this->seed(seed);
+	}
+
+	void BrickGenerator::seed(const uint64_t seed) {
+		//expanding the seed to the generator's state using splitmix64 (avoids an all-zero state)
+		uint64_t s = seed;
+		for (int i = 0; i < 4; i += 2) {
+			uint64_t z = (s += 0x9E3779B97F4A7C15ull);
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+			z = z ^ (z >> 31);
+			state[i] = (uint32_t)z;
+			state[i + 1] = (uint32_t)(z >> 32);
+		}
+		bag = 0;
+		queueStart = 0;
+		queueLength = 0;
+	}
+
+	void BrickGenerator::setMode(const int _mode) {
+		mode = _mode;
+	}
+
+	uint32_t BrickGenerator::nextBits() {
+		const uint32_t result = rotl(state[1] * 5, 7) * 9;
+		const uint32_t t = state[1] << 9;
+		state[2] ^= state[0];
+		state[3] ^= state[1];
+		state[1] ^= state[2];
+		state[0] ^= state[3];
+		state[2] ^= t;
+		state[3] = rotl(state[3], 11);
+		return result;
+	}
+
+	uint32_t BrickGenerator::nextBounded(uint32_t n) {
+		//multiply-shift with rejection of the biased low values (Lemire)
+		uint64_t m = (uint64_t)nextBits() * n;
+		uint32_t low = (uint32_t)m;
+		if (low < n) {
+			uint32_t threshold = (0u - n) % n;
+			while (low < threshold) {
+				m = (uint64_t)nextBits() * n;
+				low = (uint32_t)m;
+			}
+		}
+		return (uint32_t)(m >> 32);
+	}
+
+	int BrickGenerator::generate() {
+		if (mode == MODE_UNIFORM) {
+			return nextBounded(brickCount);
+		}
+		//starting a new bag if every brick of the current one is drawn
+		if (bag == 0) {
+			bag = (1u << brickCount) - 1;
+		}
+		int remaining = 0;
+		for (uint32_t b = bag; b; b &= b - 1) remaining++;
+		//drawing the n-th brick that is left in the bag
+		uint32_t n = nextBounded(remaining);
+		for (int type = 0; type < brickCount; type++) {
+			if (bag & (1u << type)) {
+				if (n == 0) {
+					bag &= ~(1u << type);
+					return type;
+				}
+				n--;
+			}
+		}
+		return 0;
+	}
+
+	int BrickGenerator::next() {
+		//consuming a brick of the queue if there are peeked bricks
+		if (queueLength > 0) {
+			int type = queue[queueStart];
+			queueStart = (queueStart + 1) % MAX_LOOKAHEAD;
+			queueLength--;
+			return type;
+		}
+		return generate();
+	}
+
+	int BrickGenerator::peek(const int index) {
+		//the queue can't hold more bricks (generating further ones would overwrite queued bricks)
+		if (index < 0 || index >= MAX_LOOKAHEAD) return -1;
+		//generating bricks until the queue contains the requested one
+		while (queueLength <= index) {
+			queue[(queueStart + queueLength) % MAX_LOOKAHEAD] = (int8_t)generate();
+			queueLength++;
+		}
+		return queue[(queueStart + index) % MAX_LOOKAHEAD];
+	}
+
+	void BrickGenerator::peek(int* bricks, const int count) {
+		//bricks beyond the lookahead are set to -1 by peek(index)
+		for (int i = 0; i < count; i++) {
+			bricks[i] = peek(i);
+		}
+	}
+
+}
@@ -0,0 +1,87 @@
+#ifndef BRICK_GENERATOR_H
+#define BRICK_GENERATOR_H
+
+#include <stdint.h>
+
+namespace gameUtils {
+
+	/*
+	* per-game generator of brick types based on the xoshiro128** algorithm
+	* the generator doesn't use any shared state, so every game (or thread) can own it's own generator
+	* it's a plain value type: copying it (e.g. for branches of a search) copies the complete state including the lookahead-queue
+	*
+	* two modes are supported:
+	*  - MODE_UNIFORM: every brick is drawn independently with the same probability (without modulo bias)
+	*  - MODE_BAG: all brick types are drawn in random order before a new bag is started (7-bag)
+	*/
+	class BrickGenerator {
+	public:
+		const static int MODE_UNIFORM = 0;
+		const static int MODE_BAG = 1;
+		//maximum number of bricks that can be looked ahead
+		const static int MAX_LOOKAHEAD = 16;
+	private:
+		//state of the xoshiro128** generator
+		uint32_t state[4];
+		//current mode (MODE_UNIFORM or MODE_BAG)
+		int mode;
+		//brick types that are left in the current bag (bit i is set if type i wasn't drawn yet)
+		uint32_t bag;
+		//ring buffer of bricks that were generated by peek() but not consumed by next() yet
+		int8_t queue[MAX_LOOKAHEAD];
+		int queueStart, queueLength;
+		/*
+		* advance the generator
+		* @return 32 random bits
+		*/
+		uint32_t nextBits();
+		/*
+		* draw an unbiased random number
+		* @param n upper bound (exclusive)
+		* @return random number in [0, n)
+		*/
+		uint32_t nextBounded(uint32_t n);
+		/*
+		* generate a new brick type depending on the mode (ignores the queue)
+		* @return brick type
+		*/
+		int generate();
+	public:
+		/*
+		* constructs a generator
+		* @param seed value the state is derived from
+		* @param _mode MODE_UNIFORM or MODE_BAG
+		*/
+		BrickGenerator(const uint64_t seed = 0, const int _mode = MODE_UNIFORM);
+		/*
+		* reset the generator to the state derived from the given seed (the queue and the bag are cleared)
+		* @param seed value the state is derived from
+		*/
+		void seed(const uint64_t seed);
+		/*
+		* change the mode of this generator (bricks that are already queued keep their type)
+		* @param _mode MODE_UNIFORM or MODE_BAG
+		*/
+		void setMode(const int _mode);
+		/*
+		* consume the next brick
+		* @return brick type
+		*/
+		int next();
+		/*
+		* get an upcoming brick without consuming it
+		* @param index 0 for the brick returned by the next call of next(), 1 for the one after that and so on
+		* @return brick type, -1 if index is negative or not less than MAX_LOOKAHEAD (the generator isn't changed then)
+		*/
+		int peek(const int index);
+		/*
+		* get the upcoming bricks without consuming them
+		* @param bricks buffer, the brick types will be applied to
+		* @param count number of bricks, the bricks after the first MAX_LOOKAHEAD ones are set to -1
+		*/
+		void peek(int* bricks, const int count);
+	};
+
+}
+
+#endif
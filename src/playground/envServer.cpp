@@ -0,0 +1,220 @@
+#include "envServer.h"
+#include "gameData.h"
+#include <chrono>
+#include <new>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <time.h>
+
+using namespace gameData;
+using namespace gameUtils;
+using namespace std::chrono;
+
+namespace envServer {
+
+	//how often a waiting side checks a sequence number before it sleeps on the futex
+	constexpr int SPIN_COUNT = 4000;
+	//maximum time a sleeping side waits before checking the shutdown flag again
+	constexpr long FUTEX_TIMEOUT_NS = 100 * 1000 * 1000;
+
+	/*
+	* sleep until the value at the given address changes (or the timeout passes)
+	* the futex is not private because the region is shared with another process
+	*/
+	static void futexWait(std::atomic<uint32_t>* address, uint32_t expected) {
+		timespec timeout{ 0, FUTEX_TIMEOUT_NS };
+		syscall(SYS_futex, reinterpret_cast<uint32_t*>(address), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+	}
+
+	/*
+	* wake every process sleeping on the given address
+	*/
+	static void futexWake(std::atomic<uint32_t>* address) {
+		syscall(SYS_futex, reinterpret_cast<uint32_t*>(address), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+	}
+
+	//aligns every tensor to a cache line
+	static uint64_t alignOffset(uint64_t offset) {
+		return (offset + 63) & ~(uint64_t)63;
+	}
+
+	EnvServer::EnvServer(const std::string& _name, const int envCount, const uint64_t seed, const int generatorMode) :name(_name) {
+		for (int i = 0; i < envCount; i++) {
+			games.emplace_back(new GameInstance(seed + i, generatorMode));
+		}
+	}
+
+	EnvServer::~EnvServer() {
+		if (header != nullptr) {
+			munmap(header, size);
+			shm_unlink(name.c_str());
+		}
+	}
+
+	uint8_t* EnvServer::getSlot(uint32_t seq) {
+		return reinterpret_cast<uint8_t*>(header) + alignOffset(sizeof(ShmHeader)) + (seq % RING_SIZE) * header->slotSize;
+	}
+
+	bool EnvServer::open() {
+		const uint64_t envCount = games.size();
+
+		//calculating the layout of a single slot
+		uint64_t offset = 0;
+		const uint64_t actionsOffset = offset; offset = alignOffset(offset + envCount);
+		const uint64_t boardOffset = offset; offset = alignOffset(offset + envCount * fieldX * fieldY);
+		const uint64_t brickOffset = offset; offset = alignOffset(offset + envCount);
+		const uint64_t nextBrickOffset = offset; offset = alignOffset(offset + envCount);
+		const uint64_t scoreOffset = offset; offset = alignOffset(offset + envCount * sizeof(int32_t));
+		const uint64_t rewardOffset = offset; offset = alignOffset(offset + envCount * sizeof(int32_t));
+		const uint64_t doneOffset = offset; offset = alignOffset(offset + envCount);
+		const uint64_t slotSize = offset;
+
+		size = alignOffset(sizeof(ShmHeader)) + RING_SIZE * slotSize;
+
+		//creating and mapping the shared memory object
+		int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0600);
+		if (fd < 0) {
+			fprintf(stderr, "Failed to create shared memory object %s\n", name.c_str());
+			return false;
+		}
+		if (ftruncate(fd, size) != 0) {
+			fprintf(stderr, "Failed to resize shared memory object %s\n", name.c_str());
+			close(fd);
+			shm_unlink(name.c_str());
+			return false;
+		}
+		void* region = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		close(fd);
+		if (region == MAP_FAILED) {
+			fprintf(stderr, "Failed to map shared memory object %s\n", name.c_str());
+			shm_unlink(name.c_str());
+			return false;
+		}
+
+		//initializing the header (the magic value is written last, so clients can wait for it)
+		header = new (region) ShmHeader();
+		header->version = SHM_VERSION;
+		header->envCount = (uint32_t)envCount;
+		header->fieldX = fieldX;
+		header->fieldY = fieldY;
+		header->ringSize = RING_SIZE;
+		header->slotSize = slotSize;
+		header->actionsOffset = actionsOffset;
+		header->boardOffset = boardOffset;
+		header->brickOffset = brickOffset;
+		header->nextBrickOffset = nextBrickOffset;
+		header->scoreOffset = scoreOffset;
+		header->rewardOffset = rewardOffset;
+		header->doneOffset = doneOffset;
+
+		//writing the initial observations to every slot
+		for (uint32_t seq = 0; seq < RING_SIZE; seq++) {
+			uint8_t* slot = getSlot(seq);
+			for (uint64_t i = 0; i < envCount; i++) {
+				games[i]->writeObservation(
+					reinterpret_cast<int8_t*>(slot + boardOffset) + i * fieldX * fieldY,
+					reinterpret_cast<int8_t*>(slot + brickOffset) + i,
+					reinterpret_cast<int8_t*>(slot + nextBrickOffset) + i,
+					reinterpret_cast<int32_t*>(slot + scoreOffset) + i);
+			}
+		}
+
+		std::atomic_thread_fence(std::memory_order_release);
+		header->magic = SHM_MAGIC;
+		return true;
+	}
+
+	bool EnvServer::waitForRequest(uint32_t seq) {
+		int spins = 0;
+		while (header->requestSeq.load(std::memory_order_acquire) == seq) {
+			if (stopped.load(std::memory_order_relaxed) || header->shutdown.load(std::memory_order_relaxed)) {
+				return false;
+			}
+			//spinning first, the client normally answers within a few microseconds
+			if (spins < SPIN_COUNT) {
+				spins++;
+				continue;
+			}
+			//announcing the sleep before checking the sequence number again (the client wakes the server only if this flag is set)
+			header->serverWaiting.store(1);
+			if (header->requestSeq.load() == seq) {
+				futexWait(&header->requestSeq, seq);
+			}
+			header->serverWaiting.store(0);
+		}
+		return true;
+	}
+
+	void EnvServer::stepBatch(uint8_t* slot) {
+		const int8_t* actions = reinterpret_cast<int8_t*>(slot + header->actionsOffset);
+		int8_t* board = reinterpret_cast<int8_t*>(slot + header->boardOffset);
+		int8_t* brick = reinterpret_cast<int8_t*>(slot + header->brickOffset);
+		int8_t* nextBrick = reinterpret_cast<int8_t*>(slot + header->nextBrickOffset);
+		int32_t* score = reinterpret_cast<int32_t*>(slot + header->scoreOffset);
+		int32_t* reward = reinterpret_cast<int32_t*>(slot + header->rewardOffset);
+		uint8_t* done = slot + header->doneOffset;
+
+		for (size_t i = 0; i < games.size(); i++) {
+			//stepping the game and resetting it if it's over
+			int points;
+			bool over = games[i]->step(actions[i], &points);
+			if (over) {
+				games[i]->reset();
+			}
+			//writing the observation directly into the slot's tensors
+			games[i]->writeObservation(board + i * fieldX * fieldY, brick + i, nextBrick + i, score + i);
+			reward[i] = points;
+			done[i] = over;
+		}
+	}
+
+	void EnvServer::run() {
+		uint32_t seq = header->responseSeq.load();
+
+		//statistics of the current report interval
+		high_resolution_clock::time_point tReport = high_resolution_clock::now();
+		uint64_t batches = 0;
+		double busyMicros = 0;
+
+		while (waitForRequest(seq)) {
+			high_resolution_clock::time_point tBatch = high_resolution_clock::now();
+			stepBatch(getSlot(seq));
+			high_resolution_clock::time_point now = high_resolution_clock::now();
+
+			//publishing the observations and waking the client if it sleeps
+			header->responseSeq.store(++seq);
+			if (header->clientWaiting.load()) {
+				futexWake(&header->responseSeq);
+			}
+
+			batches++;
+			busyMicros += duration_cast<duration<double, std::micro>>(now - tBatch).count();
+
+			//reporting latency and throughput about once per second
+			double elapsed = duration_cast<duration<double>>(now - tReport).count();
+			if (elapsed >= 1.0) {
+				header->batchCount += batches;
+				header->batchLatencyMicros = busyMicros / batches;
+				header->stepsPerSecond = batches * games.size() / elapsed;
+				printf("batches: %llu, batch latency: %.1f us, steps/s: %.0f\n",
+					(unsigned long long)header->batchCount, header->batchLatencyMicros, header->stepsPerSecond);
+				fflush(stdout);
+				tReport = now;
+				batches = 0;
+				busyMicros = 0;
+			}
+		}
+	}
+
+	void EnvServer::stop() {
+		stopped.store(true);
+	}
+
+}
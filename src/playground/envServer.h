@@ -0,0 +1,121 @@
+#ifndef ENV_SERVER_H
+#define ENV_SERVER_H
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "gameInstance.h"
+
+namespace envServer {
+
+	//identification of the shared memory region ("TETR") and version of it's layout
+	constexpr uint32_t SHM_MAGIC = 0x52544554;
+	constexpr uint32_t SHM_VERSION = 1;
+	//number of batches the client may submit before it has to wait for the server
+	constexpr uint32_t RING_SIZE = 4;
+
+	/*
+	* header at the start of the shared memory region
+	*
+	* the header is followed by RING_SIZE slots of 'slotSize' bytes
+	* every slot contains the following contiguous tensors (offsets relative to the slot's start):
+	*  - actions   int8_t [envCount]                  written by the client (GameInstance::ACTION_*)
+	*  - board     int8_t [envCount][fieldY][fieldX]  field types including the current brick (-1 for empty fields, row 0 is the bottom row)
+	*  - brick     int8_t [envCount]                  type of the current brick
+	*  - nextBrick int8_t [envCount]                  type of the next brick (shown in the preview-field)
+	*  - score     int32_t[envCount]                  score after the step
+	*  - reward    int32_t[envCount]                  points gained during the step
+	*  - done      uint8_t[envCount]                  whether the game was over (the game is reset automatically)
+	*
+	* protocol (sequence numbers are counted up and never reset):
+	*  1. the client writes actions to slot (requestSeq % RING_SIZE) and increments requestSeq
+	*  2. the server steps every game and writes the observations to the same slot, then increments responseSeq
+	*  3. the client reads the observations once responseSeq has passed the slot's sequence number
+	* waiting sides spin for a short time and sleep on the futex of the sequence number afterwards,
+	* the other side only calls FUTEX_WAKE if the related 'waiting'-flag is set
+	*/
+	struct ShmHeader {
+		uint32_t magic;
+		uint32_t version;
+		//number of games and dimensions of the field
+		uint32_t envCount;
+		uint32_t fieldX, fieldY;
+		uint32_t ringSize;
+		//size of a single slot and offsets of the tensors inside a slot
+		uint64_t slotSize;
+		uint64_t actionsOffset, boardOffset, brickOffset, nextBrickOffset, scoreOffset, rewardOffset, doneOffset;
+
+		//sequence numbers and flags that signal sleeping sides (each on it's own cache line)
+		alignas(64) std::atomic<uint32_t> requestSeq;
+		std::atomic<uint32_t> serverWaiting;
+		alignas(64) std::atomic<uint32_t> responseSeq;
+		std::atomic<uint32_t> clientWaiting;
+		//set by the client to stop the server
+		alignas(64) std::atomic<uint32_t> shutdown;
+
+		//statistics, updated by the server about once per second
+		uint64_t batchCount;
+		double batchLatencyMicros;
+		double stepsPerSecond;
+	};
+
+	/*
+	* class that hosts a number of games and steps them in batches through a POSIX shared memory region
+	*/
+	class EnvServer {
+		//name of the shared memory object (e.g. "/tetris_env")
+		std::string name;
+		//hosted games
+		std::vector<std::unique_ptr<gameUtils::GameInstance>> games;
+		//the mapped region and it's size
+		ShmHeader* header = nullptr;
+		size_t size = 0;
+		//set by stop(), checked together with the header's shutdown flag
+		std::atomic<bool> stopped{ false };
+		/*
+		* wait until the client submits the batch with the given sequence number
+		* @param seq sequence number of the batch
+		* @return false if the server has been stopped while waiting
+		*/
+		bool waitForRequest(uint32_t seq);
+		/*
+		* get the start of a slot
+		* @param seq sequence number of the batch stored in the slot
+		*/
+		uint8_t* getSlot(uint32_t seq);
+		/*
+		* step every game with the actions of a slot and write the observations into the same slot
+		* @param slot the slot to process
+		*/
+		void stepBatch(uint8_t* slot);
+	public:
+		/*
+		* constructs a server hosting the given number of games
+		* @param _name name of the shared memory object
+		* @param envCount number of games
+		* @param seed seed of the first game (game i is seeded with seed + i)
+		* @param generatorMode BrickGenerator::MODE_UNIFORM or BrickGenerator::MODE_BAG
+		*/
+		EnvServer(const std::string& _name, const int envCount, const uint64_t seed, const int generatorMode);
+		~EnvServer();
+		/*
+		* create and map the shared memory region and write the initial observations to every slot
+		* @return whether the region could be created or not
+		*/
+		bool open();
+		/*
+		* process batches until the shutdown flag is set
+		* latency and throughput are printed and stored in the header every second
+		*/
+		void run();
+		/*
+		* request the server to stop (safe to be called from a signal handler)
+		*/
+		void stop();
+	};
+
+}
+
+#endif
@@ -0,0 +1,45 @@
+#include "envServer.h"
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*
+* headless server mode for training agents against the game's ruleset
+* usage: envserver [envCount] [shmName] [seed] [uniform|bag]
+* the layout of the shared memory region and the protocol are described in envServer.h
+*/
+
+//server instance (required for stopping it by SIGINT/SIGTERM)
+static envServer::EnvServer* server = nullptr;
+
+static void onSignal(int) {
+	if (server != nullptr) server->stop();
+}
+
+int main(int argc, char* argv[]) {
+	int envCount = argc > 1 ? atoi(argv[1]) : 64;
+	const char* name = argc > 2 ? argv[2] : "/tetris_env";
+	//the games are seeded with the given value (or the current time) to make runs reproducible
+	uint64_t seed = argc > 3 ? strtoull(argv[3], nullptr, 10) : (uint64_t)time(NULL);
+	int generatorMode = argc > 4 && strcmp(argv[4], "bag") == 0 ? gameUtils::BrickGenerator::MODE_BAG : gameUtils::BrickGenerator::MODE_UNIFORM;
+	if (envCount <= 0) {
+		fprintf(stderr, "usage: %s [envCount] [shmName] [seed] [uniform|bag]\n", argv[0]);
+		return -1;
+	}
+
+	envServer::EnvServer envServer(name, envCount, seed, generatorMode);
+	if (!envServer.open()) return -1;
+	server = &envServer;
+
+	signal(SIGINT, onSignal);
+	signal(SIGTERM, onSignal);
+
+	printf("hosting %d games in shared memory object %s (seed %llu)\n", envCount, name, (unsigned long long)seed);
+	fflush(stdout);
+	envServer.run();
+
+	server = nullptr;
+	return 0;
+}
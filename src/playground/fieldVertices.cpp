@@ -0,0 +1,89 @@
+#include "fieldVertices.h"
+#include <math.h>
+
+//the vertices are transformed with SSE if it's available (always on x86-64), a scalar loop otherwise
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define VERTICES_SSE
+#endif
+
+namespace gameData {
+
+	//number of vertices of the widest row (6 per field, rounded up to the SSE width)
+	constexpr int ROW_VERTEX_COUNT = (6 * fieldX + 3) / 4 * 4;
+
+	/*
+	* corners of every vertex of a row in structure-of-arrays layout (the values don't depend on the row or it's transformation)
+	*/
+	struct RowCorners {
+		//x-offset of the vertex's field plus the spacing
+		alignas(16) float offsetX[ROW_VERTEX_COUNT];
+		//corner inside the field's rectangle scaled by the rectangle's size (the values the transformation is applied to)
+		alignas(16) float cornerX[ROW_VERTEX_COUNT];
+		alignas(16) float cornerY[ROW_VERTEX_COUNT];
+		//corner inside the field's rectangle (0 or 1, the xy-values of the shape buffer)
+		alignas(16) float shapeX[ROW_VERTEX_COUNT];
+		alignas(16) float shapeY[ROW_VERTEX_COUNT];
+		RowCorners() {
+			for (int i = 0; i < ROW_VERTEX_COUNT; i++) {
+				const int v = i % 6;
+				offsetX[i] = i / 6 + spacing;
+				shapeX[i] = vertex_buffer_single[3 * v];
+				shapeY[i] = vertex_buffer_single[3 * v + 1];
+				cornerX[i] = shapeX[i] * (1 - spacing * 2);
+				cornerY[i] = shapeY[i] * (1 - spacing * 2);
+			}
+		}
+	};
+
+	static const RowCorners rowCorners;
+
+	void transformFieldRow(const int width, const int y, const FieldTransform& transform, float* vertices, float* shapes) {
+		const RowCorners& corners = rowCorners;
+		const int count = 6 * width;
+		//the y-offset of the row and the translation are the same for every vertex
+		const float offsetY = y + spacing + transform.f;
+		//the scaled size of every field's rectangle (the shape of the rounded rectangle)
+		const float sizeX = fabsf(transform.a) * (1 - spacing * 2), sizeY = fabsf(transform.e) * (1 - spacing * 2);
+
+		int i = 0;
+#ifdef VERTICES_SSE
+		const __m128 a = _mm_set1_ps(transform.a), b = _mm_set1_ps(transform.b), c = _mm_set1_ps(transform.c);
+		const __m128 d = _mm_set1_ps(transform.d), e = _mm_set1_ps(transform.e), oy = _mm_set1_ps(offsetY);
+		const __m128 zero = _mm_setzero_ps(), size = _mm_setr_ps(sizeX, sizeY, sizeX, sizeY);
+		for (; i + 4 <= count; i += 4) {
+			const __m128 cx = _mm_load_ps(&corners.cornerX[i]), cy = _mm_load_ps(&corners.cornerY[i]);
+			const __m128 x = _mm_add_ps(_mm_add_ps(_mm_load_ps(&corners.offsetX[i]), c), _mm_add_ps(_mm_mul_ps(a, cx), _mm_mul_ps(b, cy)));
+			const __m128 y = _mm_add_ps(oy, _mm_add_ps(_mm_mul_ps(d, cx), _mm_mul_ps(e, cy)));
+
+			//interleaving four vertices (x, y, 0) into three vectors: (x0 y0 0 x1) (y1 0 x2 y2) (0 x3 y3 0)
+			const __m128 xy01 = _mm_unpacklo_ps(x, y), xy23 = _mm_unpackhi_ps(x, y);
+			const __m128 zx01 = _mm_unpacklo_ps(zero, x), zx23 = _mm_unpackhi_ps(zero, x);
+			const __m128 yz01 = _mm_unpacklo_ps(y, zero), yz23 = _mm_unpackhi_ps(y, zero);
+			_mm_storeu_ps(vertices + 3 * i, _mm_shuffle_ps(xy01, zx01, _MM_SHUFFLE(3, 2, 1, 0)));
+			_mm_storeu_ps(vertices + 3 * i + 4, _mm_shuffle_ps(yz01, xy23, _MM_SHUFFLE(1, 0, 3, 2)));
+			_mm_storeu_ps(vertices + 3 * i + 8, _mm_shuffle_ps(zx23, yz23, _MM_SHUFFLE(3, 2, 3, 2)));
+
+			//the shape values of four vertices (shapeX, shapeY, sizeX, sizeY)
+			const __m128 sx = _mm_load_ps(&corners.shapeX[i]), sy = _mm_load_ps(&corners.shapeY[i]);
+			const __m128 s01 = _mm_unpacklo_ps(sx, sy), s23 = _mm_unpackhi_ps(sx, sy);
+			_mm_storeu_ps(shapes + 4 * i, _mm_movelh_ps(s01, size));
+			_mm_storeu_ps(shapes + 4 * i + 4, _mm_shuffle_ps(s01, size, _MM_SHUFFLE(1, 0, 3, 2)));
+			_mm_storeu_ps(shapes + 4 * i + 8, _mm_movelh_ps(s23, size));
+			_mm_storeu_ps(shapes + 4 * i + 12, _mm_shuffle_ps(s23, size, _MM_SHUFFLE(1, 0, 3, 2)));
+		}
+#endif
+		//remaining vertices (every vertex without SSE)
+		for (; i < count; i++) {
+			const float cx = corners.cornerX[i], cy = corners.cornerY[i];
+			vertices[3 * i] = corners.offsetX[i] + transform.c + transform.a * cx + transform.b * cy;
+			vertices[3 * i + 1] = offsetY + transform.d * cx + transform.e * cy;
+			vertices[3 * i + 2] = 0.0f;
+			shapes[4 * i] = corners.shapeX[i];
+			shapes[4 * i + 1] = corners.shapeY[i];
+			shapes[4 * i + 2] = sizeX;
+			shapes[4 * i + 3] = sizeY;
+		}
+	}
+
+}
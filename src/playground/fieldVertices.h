@@ -0,0 +1,52 @@
+#ifndef FIELD_VERTICES_H
+#define FIELD_VERTICES_H
+
+#include "gameData.h"
+
+namespace gameData {
+
+	/*
+	* affine transformation of a field's rectangle relative to it's lower left corner (in fields)
+	* x' = a * x + b * y + c
+	* y' = d * x + e * y + f
+	*/
+	struct FieldTransform {
+		float a, b, c;
+		float d, e, f;
+	};
+
+	//transformation that keeps every field at it's location
+	constexpr FieldTransform FIELD_TRANSFORM_IDENTITY{ 1, 0, 0, 0, 1, 0 };
+
+	/*
+	* get the index of a field of the main field in the vertex, color and shape buffers (the preview's 16 fields come first)
+	* @param x, y the field's coordinates
+	* @return the field's index (6 vertices per field)
+	*/
+	constexpr int getMainFieldIndex(const int x, const int y) {
+		return 16 + x + (fieldY - 1 - y) * fieldX;
+	}
+
+	/*
+	* get the index of a field of the preview field in the vertex and shape buffers (the color of preview index y is drawn at row 3 - y)
+	* @param x, y the field's coordinates
+	* @return the field's index (6 vertices per field)
+	*/
+	constexpr int getPreviewFieldIndex(const int x, const int y) {
+		return x + (3 - y) * 4;
+	}
+
+	/*
+	* transform the vertices of a whole row of fields (the rows of the main field and the preview field are stored contiguously)
+	* the vertices are calculated from the corners of all fields of a row in structure-of-arrays layout, four vertices at once with SSE
+	* @param width number of fields of the row (at most fieldX)
+	* @param y the row's y-coordinate (in fields)
+	* @param transform the transformation applied to every field of the row
+	* @param vertices buffer, the vertices (3 values each) of the row's first field and the following fields will be applied to
+	* @param shapes buffer, the shape values (4 values each) of the row's vertices will be applied to
+	*/
+	void transformFieldRow(const int width, const int y, const FieldTransform& transform, float* vertices, float* shapes);
+
+}
+
+#endif
@@ -1,17 +1,17 @@
 #ifndef GAME_DATA_H
 #define GAME_DATA_H
 #include <memory>
+#include <array>
+#include <stdint.h>
 #include "gameUtils.h";
 #include <glfw3.h>
+#ifdef _WIN32
 #include <windows.h>
+#endif
 using namespace gameUtils;
 
 namespace gameData {
 
-	//variables to store (effective static field-variables
-	extern std::shared_ptr<Field> field; //representation of the field (without current brick)
-	extern std::shared_ptr<BrickDroppingField> brickDroppingField; // combination of variable 'field' and the current brick
-
 	//width of the main field (in opengl-coordinates)
 	const float widthMainField = 1.4f;
 	//width of the preview field (in opengl-coordinates)
@@ -19,6 +19,14 @@ namespace gameData {
 
 	//size of the main field
 	const int fieldX = 10, fieldY = 18;
+
+	//field types with the size of the main field (index calculations and row loops are resolved at compile time)
+	typedef BasicField<fieldX, fieldY> GameField;
+	typedef BasicBrickDroppingField<GameField> GameBrickDroppingField;
+
+	//variables to store (effective static field-variables
+	extern std::shared_ptr<GameField> field; //representation of the field (without current brick)
+	extern std::shared_ptr<GameBrickDroppingField> brickDroppingField; // combination of variable 'field' and the current brick
 	//width and height of every single field
 	const float mx = widthMainField / fieldX, my = 2.0f / fieldY;
 	//width and height of every single preview field
@@ -30,6 +38,12 @@ namespace gameData {
 	//the aspect ratio of the main field (important for window-size calculation)
 	const double aspectRatio = 1.0f * fieldX / fieldY;
 
+	//points added to the score (depending on row count during collapse)
+	constexpr int POINTS_SINGLE_ROW = 20;
+	constexpr int POINTS_DOUBLE_ROW = 50;
+	constexpr int POINTS_TRIPLE_ROW = 100;
+	constexpr int POINTS_QUADRUPLE_ROW = 180;
+
 	//template of a rectangle represented by two triangles (those values are transformed to calculate the vertices of every single field)
 	static GLfloat vertex_buffer_single[3 * 6]{
 		0.0f, 0.0f, 0.0f,
@@ -48,80 +62,70 @@ namespace gameData {
 	constexpr int FIELD_TYPE_EMPTY = -1, FIELD_TYPE_I = 0, FIELD_TYPE_J = 1, FIELD_TYPE_L = 2,
 		FIELD_TYPE_O = 3, FIELD_TYPE_S = 4, FIELD_TYPE_T = 5, FIELD_TYPE_Z = 6;
 
-	//bricks represented as arrays of length 4, 9 or 16
-	const std::shared_ptr<int> BRICK_I{ new int[16]{
+	//bricks represented as arrays of 4, 9 or 16 values (index x + y * brickSize, the remaining values are unused)
+	//the tables below are constexpr inline variables, so they exist only once and are initialized at compile time
+	typedef std::array<int8_t, 16> BrickTemplate;
+	inline constexpr BrickTemplate BRICK_I{
 		0,0,0,0,
 		1,1,1,1,
 		0,0,0,0,
 		0,0,0,0
-	},std::default_delete<int[]>() };
-	const std::shared_ptr<int> BRICK_J{ new int[9]{
+	};
+	inline constexpr BrickTemplate BRICK_J{
 		1,0,0,
 		1,1,1,
 		0,0,0
-	},std::default_delete<int[]>() };
-	const std::shared_ptr<int> BRICK_L{ new int[9]{
+	};
+	inline constexpr BrickTemplate BRICK_L{
 		0,0,1,
 		1,1,1,
 		0,0,0
-	},std::default_delete<int[]>() };
-	const std::shared_ptr<int> BRICK_O{ new int[4]{
+	};
+	inline constexpr BrickTemplate BRICK_O{
 		1,1,
 		1,1
-	},std::default_delete<int[]>() };
-	const std::shared_ptr<int> BRICK_S{ new int[9]{
+	};
+	inline constexpr BrickTemplate BRICK_S{
 		0,1,1,
 		1,1,0,
 		0,0,0,
-	},std::default_delete<int[]>() };
-	const std::shared_ptr<int> BRICK_T{ new int[9]{
+	};
+	inline constexpr BrickTemplate BRICK_T{
 		0,1,0,
 		1,1,1,
 		0,0,0
-	},std::default_delete<int[]>() };
-	const std::shared_ptr<int> BRICK_Z{ new int[9]{
+	};
+	inline constexpr BrickTemplate BRICK_Z{
 		1,1,0,
 		0,1,1,
 		0,0,0
-	},std::default_delete<int[]>() };
+	};
 
 	//brick count (equals size of arrays 'bricks' and 'brickSizes')
 	constexpr int brickCount = 7;
 
 	//sizes of the brick-rectangles (in one direction)
-	const std::shared_ptr<int>brickSizes{
-		new int[brickCount] {4, 3, 3, 2, 3, 3, 3}, 
-		std::default_delete<int[]>()
-	};
+	inline constexpr std::array<int, brickCount> brickSizes{ 4, 3, 3, 2, 3, 3, 3 };
 
-	//pointers to all the bricks
-	const std::shared_ptr<std::shared_ptr<int>> bricks{
-		new std::shared_ptr<int>[brickCount] {
-			BRICK_I,
-			BRICK_J,
-			BRICK_L,
-			BRICK_O,
-			BRICK_S,
-			BRICK_T,
-			BRICK_Z
-		},std::default_delete< std::shared_ptr<int>[]>()
+	//all the bricks
+	inline constexpr std::array<BrickTemplate, brickCount> bricks{
+		BRICK_I,
+		BRICK_J,
+		BRICK_L,
+		BRICK_O,
+		BRICK_S,
+		BRICK_T,
+		BRICK_Z
 	};
 	
 	//the game's background color
-	const std::shared_ptr<float> backgroundColor{
-		new float[3]{0.08f,0.08f,0.08f},
-		std::default_delete<float[]>()
-	};
+	inline constexpr std::array<float, 3> backgroundColor{ 0.08f,0.08f,0.08f };
 
 	//the field's background color
-	const std::shared_ptr<float> fieldBackgroundColor{
-		new float[3]{0.13f,0.13f,0.13f},
-		std::default_delete<float[]>()
-	};
+	inline constexpr std::array<float, 3> fieldBackgroundColor{ 0.13f,0.13f,0.13f };
 
 	//the colors for each brick
-	const std::shared_ptr<float> brickColors{
-		new float[3 * brickCount]{
+	inline constexpr std::array<float, 3 * brickCount> brickColors{
 		0.0f, 0.94f,0.94f,
 		0.0f, 0.0f ,0.94f,
 		0.94f,0.62f,0.0f,
@@ -129,25 +133,22 @@ namespace gameData {
 		0.0f, 0.94f,0.0f,
 		0.62f,0.0f ,0.94f,
 		0.94f,0.0f ,0.0f
-		},std::default_delete<float[]>()
 	};
 
 	//matrices to calculate brick rotations
-	const std::shared_ptr<int> rotations{
-		new int[16]{
-			// 0
-			1,0,
-			0,1,
-			// 90
-			0,-1,
-			1,0,
-			// 180
-			-1,0,
-			0,-1,
-			// 270
-			0,1,
-			-1,0,
-		},std::default_delete<int[]>()
+	inline constexpr std::array<int, 16> rotations{
+		// 0
+		1,0,
+		0,1,
+		// 90
+		0,-1,
+		1,0,
+		// 180
+		-1,0,
+		0,-1,
+		// 270
+		0,1,
+		-1,0,
 	};
 
 	/*
@@ -162,7 +163,224 @@ namespace gameData {
 	* @param b float, the color's blue value will be applied to
 	* @param r,g,b the floats, the value data will be applied to
 	*/
-	void getTypeColor(const int type, float* r, float* g, float* b);
+	constexpr void getTypeColor(const int type, float* r, float* g, float* b) {
+		if (type >= 0) {//return the type color
+			*r = brickColors[3 * type];
+			*g = brickColors[3 * type + 1];
+			*b = brickColors[3 * type + 2];
+		}
+		else if (type == -2) {//return a changed background color (debugging only)
+			*r = 0.3f;
+			*g = 0.3f;
+			*b = 0.3f;
+		}
+		else if (type < -2) {//return a changed type color (debugging only)
+			*r = brickColors[3 * (-3 - type)] / 2;
+			*g = brickColors[3 * (-3 - type) + 1] / 2;
+			*b = brickColors[3 * (-3 - type) + 2] / 2;
+		}
+		else {//return the background color
+			*r = fieldBackgroundColor[0];
+			*g = fieldBackgroundColor[1];
+			*b = fieldBackgroundColor[2];
+		}
+	}
+	/*
+	* function to get the points for collapsing a number of rows at once
+	* @param rowCount number of collapsed rows
+	* @returns points that will be added to the score (0 if no rows were collapsed)
+	*/
+	constexpr int getCollapsePoints(const int rowCount) {
+		if (rowCount == 1) return POINTS_SINGLE_ROW;
+		else if (rowCount == 2) return POINTS_DOUBLE_ROW;
+		else if (rowCount == 3) return POINTS_TRIPLE_ROW;
+		else if (rowCount == 4) return POINTS_QUADRUPLE_ROW;
+		return 0;
+	}
+	/*
+	* translates brick-view-coordinates to brick-template-coordinates
+	* (rotation around the center of the brick's area, calculated with doubled coordinates to stay in integers)
+	* @param x brick's view x coordinate
+	* @param y brick's view y coordinate
+	* @param rotation brick's rotation
+	* @param brickSize brick's size (width and height)
+	*/
+	constexpr void transformFieldToPoint(int* x, int* y, const int rotation, const int brickSize) {
+		//applying a matrix depending on the given rotation around the brickSize's center to x and y
+		const int c = brickSize - 1;
+		int x1 = (rotations[rotation * 4] * (2 * *x - c) + rotations[rotation * 4 + 1] * (2 * *y - c) + c) / 2;
+		*y = (rotations[rotation * 4 + 2] * (2 * *x - c) + rotations[rotation * 4 + 3] * (2 * *y - c) + c) / 2;
+		*x = x1;
+	}
+
+	/*
+	* cells of a brick in a specific rotation
+	* calculated with transformFieldToPoint, so the masks equal the BrickDroppingField's view of the brick
+	*/
+	struct BrickMask {
+		//filled cells of every row of the brick's area (bit x is set if the cell at x is filled, row 0 is the bottom row)
+		uint16_t rows[4];
+		//size of the brick's area (in one direction)
+		int size;
+	};
+
+	/*
+	* calculate the masks of every brick in every rotation (evaluated at compile time)
+	* @return masks (index [type][rotation])
+	*/
+	constexpr std::array<std::array<BrickMask, 4>, brickCount> makeBrickMasks() {
+		std::array<std::array<BrickMask, 4>, brickCount> masks{};
+		for (int type = 0; type < brickCount; type++) {
+			const int size = brickSizes[type];
+			for (int rotation = 0; rotation < 4; rotation++) {
+				BrickMask& mask = masks[type][rotation];
+				mask.size = size;
+				for (int y = 0; y < size; y++) {
+					for (int x = 0; x < size; x++) {
+						int x1 = x;
+						int y1 = y;
+						transformFieldToPoint(&x1, &y1, rotation, size);
+						if (bricks[type][x1 + (size - 1 - y1) * size]) {
+							mask.rows[y] |= 1 << x;
+						}
+					}
+				}
+			}
+		}
+		return masks;
+	}
+
+	//masks of every brick in every rotation (index [type][rotation])
+	inline constexpr std::array<std::array<BrickMask, 4>, brickCount> brickMasks = makeBrickMasks();
+
+	//maximum number of translations (kicks) tested for a single rotation (the first one that doesn't overlap is applied)
+	constexpr int MAX_KICKS = 8;
+	//maximum distance of a kick in every direction
+	constexpr int MAX_KICK_OFFSET = 2;
+	//size of the area (in both directions) that contains the brick's area translated by every possible kick
+	constexpr int KICK_WINDOW_SIZE = 4 + 2 * MAX_KICK_OFFSET;
+	static_assert(KICK_WINDOW_SIZE * KICK_WINDOW_SIZE <= 64, "the kick window needs to fit into 64 bits");
+
+	/*
+	* get the index of a rotation transition in a KickTable
+	* @param rotation the brick's rotation before the transition
+	* @param right whether the brick is rotated right (clockwise) or left
+	* @return index of the transition (0-7)
+	*/
+	constexpr int getKickTransition(const int rotation, const bool right) {
+		return rotation * 2 + (right ? 1 : 0);
+	}
+
+	/*
+	* translations applied to rotated bricks (wall kicks) for every brick type and rotation transition
+	*
+	* the translations of a transition are tested in order and the first one that doesn't overlap is applied
+	* for every translation the mask of the rotated and translated brick is stored inside an area of KICK_WINDOW_SIZE x KICK_WINDOW_SIZE fields
+	* (starting MAX_KICK_OFFSET fields left of and below the brick's offset, bit x + y * KICK_WINDOW_SIZE), so every translation
+	* can be tested against the same 64-bit window of the field
+	*/
+	struct KickTable {
+		//number of translations of every transition (index [type][transition])
+		int8_t counts[brickCount][8];
+		//translations (index [type][transition][kick])
+		int8_t dx[brickCount][8][MAX_KICKS];
+		int8_t dy[brickCount][8][MAX_KICKS];
+		//masks of the rotated and translated bricks (index [type][transition][kick])
+		uint64_t masks[brickCount][8][MAX_KICKS];
+		//whether any translation moves a brick vertically (bricks can move upwards then)
+		bool vertical;
+	};
+
+	/*
+	* add a translation to a kick table (calculates the translated mask)
+	* @param table the table
+	* @param type brick's type
+	* @param transition index of the transition (see getKickTransition)
+	* @param dx, dy the translation
+	*/
+	constexpr void addKick(KickTable& table, const int type, const int transition, const int dx, const int dy) {
+		const int kick = table.counts[type][transition]++;
+		table.dx[type][transition][kick] = (int8_t)dx;
+		table.dy[type][transition][kick] = (int8_t)dy;
+		if (dy != 0) table.vertical = true;
+		//the rotated brick's mask inside the window
+		const BrickMask& mask = brickMasks[type][(transition / 2 + (transition % 2 == 1 ? 1 : 3)) % 4];
+		uint64_t bits = 0;
+		for (int y = 0; y < mask.size; y++) {
+			bits |= (uint64_t)mask.rows[y] << ((y + dy + MAX_KICK_OFFSET) * KICK_WINDOW_SIZE + dx + MAX_KICK_OFFSET);
+		}
+		table.masks[type][transition][kick] = bits;
+	}
+
+	/*
+	* calculate the kick table of the original rules: no vertical translations,
+	* bricks of size 3 and 4 may be moved by 1 (first right, then left), bricks of size 4 may be moved by 2
+	* @return the kick table
+	*/
+	constexpr KickTable makeLegacyKickTable() {
+		KickTable table{};
+		for (int type = 0; type < brickCount; type++) {
+			for (int transition = 0; transition < 8; transition++) {
+				addKick(table, type, transition, 0, 0);
+				if (brickSizes[type] > 2) {
+					addKick(table, type, transition, 1, 0);
+					addKick(table, type, transition, -1, 0);
+				}
+				if (brickSizes[type] > 3) {
+					addKick(table, type, transition, 2, 0);
+					addKick(table, type, transition, -2, 0);
+				}
+			}
+		}
+		return table;
+	}
+
+	//translations of the super rotation system (SRS) in the order of getKickTransition (0->L, 0->R, R->0, R->2, 2->R, 2->L, L->2, L->0)
+	inline constexpr int8_t SRS_KICKS_JLSTZ[8][5][2]{
+		{ {0,0}, {1,0}, {1,1}, {0,-2}, {1,-2} },
+		{ {0,0}, {-1,0}, {-1,1}, {0,-2}, {-1,-2} },
+		{ {0,0}, {1,0}, {1,-1}, {0,2}, {1,2} },
+		{ {0,0}, {1,0}, {1,-1}, {0,2}, {1,2} },
+		{ {0,0}, {-1,0}, {-1,1}, {0,-2}, {-1,-2} },
+		{ {0,0}, {1,0}, {1,1}, {0,-2}, {1,-2} },
+		{ {0,0}, {-1,0}, {-1,-1}, {0,2}, {-1,2} },
+		{ {0,0}, {-1,0}, {-1,-1}, {0,2}, {-1,2} }
+	};
+	inline constexpr int8_t SRS_KICKS_I[8][5][2]{
+		{ {0,0}, {-1,0}, {2,0}, {-1,2}, {2,-1} },
+		{ {0,0}, {-2,0}, {1,0}, {-2,-1}, {1,2} },
+		{ {0,0}, {2,0}, {-1,0}, {2,1}, {-1,-2} },
+		{ {0,0}, {-1,0}, {2,0}, {-1,2}, {2,-1} },
+		{ {0,0}, {1,0}, {-2,0}, {1,-2}, {-2,1} },
+		{ {0,0}, {2,0}, {-1,0}, {2,1}, {-1,-2} },
+		{ {0,0}, {-2,0}, {1,0}, {-2,-1}, {1,2} },
+		{ {0,0}, {1,0}, {-2,0}, {1,-2}, {-2,1} }
+	};
+
+	/*
+	* calculate the kick table of the super rotation system (the O-brick isn't translated)
+	* @return the kick table
+	*/
+	constexpr KickTable makeSRSKickTable() {
+		KickTable table{};
+		for (int type = 0; type < brickCount; type++) {
+			for (int transition = 0; transition < 8; transition++) {
+				if (type == FIELD_TYPE_O) {
+					addKick(table, type, transition, 0, 0);
+					continue;
+				}
+				const int8_t(&kicks)[5][2] = type == FIELD_TYPE_I ? SRS_KICKS_I[transition] : SRS_KICKS_JLSTZ[transition];
+				for (int kick = 0; kick < 5; kick++) {
+					addKick(table, type, transition, kicks[kick][0], kicks[kick][1]);
+				}
+			}
+		}
+		return table;
+	}
+
+	//kick tables of the original rules and of the super rotation system
+	inline constexpr KickTable KICKS_LEGACY = makeLegacyKickTable();
+	inline constexpr KickTable KICKS_SRS = makeSRSKickTable();
 
 }
 
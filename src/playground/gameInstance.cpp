@@ -0,0 +1,134 @@
+#include "gameInstance.h"
+#include "gameData.h"
+
+using namespace gameData;
+
+namespace gameUtils {
+
+	GameInstance::GameInstance(const uint64_t seed, const int generatorMode) :
+		field(std::make_shared<GameField>()),
+		brickDroppingField(std::make_shared<GameBrickDroppingField>(field)),
+		brickGenerator(seed, generatorMode) {
+		reset();
+	}
+
+	void GameInstance::reset() {
+		//clearing the field and the score and starting with a new pair of bricks
+		field->clear();
+		score = 0;
+		nextBrick = brickGenerator.next();
+		startBrick();
+	}
+
+	void GameInstance::startBrick() {
+		brickDroppingField->startBrick(nextBrick);
+		nextBrick = brickGenerator.next();
+	}
+
+	int GameInstance::collapseRows() {
+		//index of the row the next not filled row will be moved to
+		int target = 0;
+		for (int y = 0; y < fieldY; y++)
+		{
+			//filled rows are skipped, all other rows are moved downwards to the target row
+			if (field->isRowFull(y)) continue;
+			if (target != y) {
+				field->copyRow(y, target);
+			}
+			target++;
+		}
+		//clearing the rows at the top of the field which are empty now
+		for (int y = target; y < fieldY; y++) {
+			field->clearRow(y);
+		}
+		return fieldY - target;
+	}
+
+	bool GameInstance::lockBrick(int* reward) {
+		//place the brick on the field (and check if the field is full)
+		if (!brickDroppingField->placeBrick()) {
+			return false;
+		}
+		//adding a row-count related value to the score
+		int points = getCollapsePoints(collapseRows());
+		score += points;
+		*reward += points;
+
+		startBrick();
+		return true;
+	}
+
+	bool GameInstance::step(int action, int* reward) {
+		*reward = 0;
+		if (action == ACTION_RESET) {
+			reset();
+			return false;
+		}
+		//the game is over until it's reset
+		if (!brickDroppingField->hasBrick()) {
+			return true;
+		}
+
+		//applying the action to the current brick (actions that are not allowed are ignored)
+		if (action == ACTION_MOVE_LEFT && brickDroppingField->canMoveBrick(BrickDroppingField::TYPE_MOVE_LEFT)) {
+			brickDroppingField->moveBrick(BrickDroppingField::TYPE_MOVE_LEFT);
+		}
+		else if (action == ACTION_MOVE_RIGHT && brickDroppingField->canMoveBrick(BrickDroppingField::TYPE_MOVE_RIGHT)) {
+			brickDroppingField->moveBrick(BrickDroppingField::TYPE_MOVE_RIGHT);
+		}
+		else if (action == ACTION_ROTATE_LEFT || action == ACTION_ROTATE_RIGHT) {
+			int direction = action == ACTION_ROTATE_LEFT ? BrickDroppingField::TYPE_ROTATE_LEFT : BrickDroppingField::TYPE_ROTATE_RIGHT;
+			//flag to store side effects of the rotation (see BrickDroppingField::canRotateBrick)
+			int flag = brickDroppingField->canRotateBrick(direction);
+			if (flag) {
+				brickDroppingField->rotateBrick(direction, flag);
+			}
+		}
+		else if (action == ACTION_MOVE_DOWN && brickDroppingField->canMoveBrick(BrickDroppingField::TYPE_MOVE_DOWN)) {
+			brickDroppingField->moveBrick(BrickDroppingField::TYPE_MOVE_DOWN);
+		}
+		else if (action == ACTION_DROP) {
+			//dropping the brick as far as possible and placing it afterwards
+			while (brickDroppingField->canMoveBrick(BrickDroppingField::TYPE_MOVE_DOWN)) {
+				brickDroppingField->moveBrick(BrickDroppingField::TYPE_MOVE_DOWN);
+			}
+			return !lockBrick(reward);
+		}
+
+		//dropping the brick by one unit or placing it if it can't be moved
+		if (brickDroppingField->canMoveBrick(BrickDroppingField::TYPE_MOVE_DOWN)) {
+			brickDroppingField->moveBrick(BrickDroppingField::TYPE_MOVE_DOWN);
+			return false;
+		}
+		return !lockBrick(reward);
+	}
+
+	void GameInstance::save(GameSnapshot* snapshot) {
+		*snapshot = GameSnapshot{};
+		brickDroppingField->saveState(&snapshot->field);
+		snapshot->brickGenerator = brickGenerator;
+		snapshot->score = score;
+		snapshot->nextBrick = nextBrick;
+	}
+
+	void GameInstance::restore(const GameSnapshot* snapshot) {
+		brickDroppingField->restoreState(&snapshot->field);
+		brickGenerator = snapshot->brickGenerator;
+		score = snapshot->score;
+		nextBrick = snapshot->nextBrick;
+	}
+
+	void GameInstance::writeObservation(int8_t* board, int8_t* brick, int8_t* next, int32_t* score) {
+		for (int y = 0; y < fieldY; y++)
+		{
+			for (int x = 0; x < fieldX; x++)
+			{
+				board[x + y * fieldX] = (int8_t)brickDroppingField->get(x, y);
+			}
+		}
+		*brick = (int8_t)brickDroppingField->getBrickType();
+		*next = (int8_t)nextBrick;
+		*score = this->score;
+	}
+
+}
@@ -0,0 +1,108 @@
+#ifndef GAME_INSTANCE_H
+#define GAME_INSTANCE_H
+
+#include <memory>
+#include <stdint.h>
+#include "gameUtils.h"
+#include "gameData.h"
+#include "brickGenerator.h"
+#include "gameSnapshot.h"
+
+namespace gameUtils {
+
+	/*
+	* class that runs a single game without any window, timers or animations
+	* the rules (brick movement, rotation, collapsing rows and points) are the same as in the playground,
+	* but the game only advances when step() is called (one step equals one drop-movement of the brick)
+	* collapsing rows are removed immediately instead of being animated
+	*/
+	class GameInstance {
+		//the static field and the combined view of field and current brick
+		std::shared_ptr<gameData::GameField> field;
+		std::shared_ptr<gameData::GameBrickDroppingField> brickDroppingField;
+		//current score and brick to be dropped next
+		int score = 0, nextBrick = 0;
+		//generator of the brick types (owned by this game, so games can be stepped on different threads)
+		BrickGenerator brickGenerator;
+		/*
+		* start the next brick on the field and calculate a new next brick
+		*/
+		void startBrick();
+		/*
+		* remove all filled rows of the field and move every row above them downwards
+		* @return number of removed rows
+		*/
+		int collapseRows();
+		/*
+		* place the current brick and handle collapsing rows and the next brick
+		* @param reward int, the points of collapsed rows will be added to
+		* @return whether the game is still running or not
+		*/
+		bool lockBrick(int* reward);
+	public:
+		/*
+		* actions that can be applied by step(action)
+		*/
+		const static int ACTION_NONE = 0;
+		const static int ACTION_MOVE_LEFT = 1;
+		const static int ACTION_MOVE_RIGHT = 2;
+		const static int ACTION_ROTATE_LEFT = 3;
+		const static int ACTION_ROTATE_RIGHT = 4;
+		const static int ACTION_MOVE_DOWN = 5;
+		const static int ACTION_DROP = 6;
+		const static int ACTION_RESET = 7;
+		/*
+		* constructs a new game and starts the first brick
+		* @param seed seed of the game's brick generator
+		* @param generatorMode BrickGenerator::MODE_UNIFORM or BrickGenerator::MODE_BAG
+		*/
+		GameInstance(const uint64_t seed = 0, const int generatorMode = BrickGenerator::MODE_UNIFORM);
+		/*
+		* clear the field, reset the score and start a new brick
+		*/
+		void reset();
+		/*
+		* apply an action to the current brick and drop it by one unit afterwards
+		* if the brick can't be dropped it is placed, filled rows are collapsed and the next brick is started
+		* @param action one of the ACTION_* constants
+		* @param reward int, the points gained during this step will be applied to
+		* @return whether the game is over (the game needs to be reset before it can be continued)
+		*/
+		bool step(int action, int* reward);
+		/*
+		* write the current state of the game into the given buffers
+		* @param board buffer of fieldX*fieldY values, the types of every field (including the current brick) will be applied to (index x + y * fieldX, -1 for empty fields)
+		* @param brick value, the current brick's type will be applied to
+		* @param next value, the next brick's type will be applied to
+		* @param score value, the current score will be applied to
+		*/
+		void writeObservation(int8_t* board, int8_t* brick, int8_t* next, int32_t* score);
+		/*
+		* save the state of this game (field, brick, generator and score; the playground-only values are set to 0)
+		* @param snapshot the snapshot the state will be applied to
+		*/
+		void save(GameSnapshot* snapshot);
+		/*
+		* restore the state of this game (e.g. to branch a search without copying the game)
+		* @param snapshot the snapshot to restore
+		*/
+		void restore(const GameSnapshot* snapshot);
+		/*
+		* get the brick generator of this game (e.g. to look ahead of the next brick)
+		* @return the game's brick generator
+		*/
+		inline BrickGenerator& getBrickGenerator() {
+			return brickGenerator;
+		}
+		/*
+		* get the current score
+		* @return current score
+		*/
+		inline int getScore() {
+			return score;
+		}
+	};
+
+}
+
+#endif
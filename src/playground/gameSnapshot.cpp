@@ -0,0 +1,27 @@
+#include "gameSnapshot.h"
+#include <type_traits>
+
+namespace gameUtils {
+
+	static_assert(std::is_trivially_copyable<GameSnapshot>::value, "snapshots need to be copyable by memcpy");
+
+	SnapshotRing::SnapshotRing(const int _capacity) :snapshots(new GameSnapshot[_capacity]), capacity(_capacity) {}
+
+	GameSnapshot* SnapshotRing::push() {
+		if (length < capacity) {
+			length++;
+		}
+		else {//overwriting the oldest snapshot
+			start = (start + 1) % capacity;
+		}
+		return &snapshots[(start + length - 1) % capacity];
+	}
+
+	const GameSnapshot* SnapshotRing::rewind(const int count) {
+		if (length == 0) return nullptr;
+		//dropping the newest snapshots (the oldest one is always kept)
+		length -= count < length - 1 ? count : length - 1;
+		return &snapshots[(start + length - 1) % capacity];
+	}
+
+}
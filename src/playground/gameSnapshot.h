@@ -0,0 +1,88 @@
+#ifndef GAME_SNAPSHOT_H
+#define GAME_SNAPSHOT_H
+
+#include <memory>
+#include <stdint.h>
+#include "gameData.h"
+#include "brickGenerator.h"
+
+namespace gameUtils {
+
+	/*
+	* state of a BrickDroppingField (values of the underlying field and the current brick)
+	*/
+	struct FieldSnapshot {
+		//type of every single field (index x + y * width, larger fields can't be saved)
+		int8_t values[gameData::fieldX * gameData::fieldY];
+		//current brick's type (-1 if no brick is set), translation and rotation
+		int8_t brickType;
+		int8_t brickX, brickY, brickRot;
+	};
+
+	/*
+	* plain copy of the complete game state
+	* snapshots contain no pointers, so they can be saved and restored with a simple copy
+	* time points are stored as milliseconds that have passed since them when the snapshot was taken
+	*/
+	struct GameSnapshot {
+		FieldSnapshot field;
+		BrickGenerator brickGenerator;
+		int32_t score;
+		int32_t nextBrick;
+		int32_t programState, programStateAfterWait;
+		//drop delay (in milliseconds)
+		float dTDrop;
+		//elapsed times of the drop-, animation- and pause-timers
+		int32_t elapsedStart, elapsedAnimationStart, elapsedPauseStart;
+		uint8_t pause;
+		//state of the collapse animation
+		int8_t animationPhase;
+		int8_t collapseRowCount;
+		int8_t collapseConfiguration[gameData::fieldY];
+	};
+
+	/*
+	* ring buffer that keeps the latest snapshots (the oldest one is overwritten when it's full)
+	*/
+	class SnapshotRing {
+		//storage of all snapshots
+		std::unique_ptr<GameSnapshot[]> snapshots;
+		//maximum number of snapshots, index of the oldest snapshot and number of stored snapshots
+		const int capacity;
+		int start = 0, length = 0;
+	public:
+		/*
+		* constructs an empty ring
+		* @param _capacity maximum number of snapshots
+		*/
+		SnapshotRing(const int _capacity);
+		/*
+		* add a new snapshot (the oldest one is dropped if the ring is full)
+		* @return the snapshot that needs to be written by the caller
+		*/
+		GameSnapshot* push();
+		/*
+		* go back in time: the given number of the newest snapshots are dropped
+		* @param count number of snapshots to go back (limited to the number of stored snapshots - 1)
+		* @return the snapshot that is the newest one now or nullptr if the ring is empty
+		*/
+		const GameSnapshot* rewind(const int count);
+		/*
+		* remove every snapshot
+		*/
+		inline void clear() {
+			start = 0;
+			length = 0;
+		}
+		/*
+		* get the number of stored snapshots
+		* @return number of snapshots
+		*/
+		inline int size() {
+			return length;
+		}
+	};
+
+}
+
+#endif
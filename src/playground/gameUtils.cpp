@@ -1,7 +1,17 @@
 #include "gameUtils.h"
 #include "gameData.h"
+#include "gameSnapshot.h"
 #include <memory>
+#include <assert.h>
 #include <iostream>
+#include <string.h>
+#include <stdlib.h>
+
+//row operations use SSE2 if it's available (always on x86-64), a scalar loop otherwise
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FIELD_SSE2
+#endif
 
 
 using namespace gameUtils;
@@ -10,30 +20,123 @@ using namespace gameData;
 
 namespace gameUtils {
 
-	Field::Field(const int _sX, const int _sY) :sX(_sX), sY(_sY), onChanged(nullptr) {
-		field = std::shared_ptr<int>{ new int[sX * sY],std::default_delete<int>() };
+	FieldStorage<DYNAMIC_SIZE, DYNAMIC_SIZE>::FieldStorage(const int _sX, const int _sY) :sX(_sX), sY(_sY), stride((_sX + FIELD_ROW_ALIGNMENT - 1) / FIELD_ROW_ALIGNMENT * FIELD_ROW_ALIGNMENT) {
+		//allocating FIELD_ROW_ALIGNMENT-1 additional bytes to align the first row
+		storage.reset(new int8_t[stride * sY + FIELD_ROW_ALIGNMENT - 1]);
+		field = storage.get() + (FIELD_ROW_ALIGNMENT - (uintptr_t)storage.get() % FIELD_ROW_ALIGNMENT) % FIELD_ROW_ALIGNMENT;
+	}
+
+	template<int W, int H>
+	BasicField<W, H>::BasicField(const int _sX, const int _sY) :FieldStorage<W, H>(_sX, _sY), onChanged(nullptr) {
+		//every field (and the padding) starts empty
+		memset(field, -1, getStride() * getHeight());
+	}
+
+	template<int W, int H>
+	void BasicField<W, H>::notifyRow(const int y) {
+		if (onChanged == nullptr) return;
+		for (int x = 0; x < getWidth(); x++)
+			onChanged(x, y, field[x + y * getStride()]);
+	}
+
+	template<int W, int H>
+	void BasicField<W, H>::clear() {
+		for (int y = 0; y < getHeight(); y++)
+			clearRow(y);
+	}
+
+	template<int W, int H>
+	void BasicField<W, H>::clearRow(const int y) {
+		int8_t* row = field + y * getStride();
+#ifdef FIELD_SSE2
+		const __m128i empty = _mm_set1_epi8(-1);
+		for (int x = 0; x < getStride(); x += FIELD_ROW_ALIGNMENT)
+			_mm_store_si128((__m128i*)(row + x), empty);
+#else
+		memset(row, -1, getStride());
+#endif
+		notifyRow(y);
+	}
+
+	template<int W, int H>
+	bool BasicField<W, H>::isRowFull(const int y) {
+		const int8_t* row = field + y * getStride();
+#ifdef FIELD_SSE2
+		const __m128i empty = _mm_set1_epi8(-1);
+		for (int x = 0; x < getWidth(); x += FIELD_ROW_ALIGNMENT) {
+			//one bit for every empty field of the block
+			int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128((const __m128i*)(row + x)), empty));
+			//ignoring the padding after the last field
+			if (getWidth() - x < FIELD_ROW_ALIGNMENT)
+				mask &= (1 << (getWidth() - x)) - 1;
+			if (mask)
+				return false;
+		}
+		return true;
+#else
+		for (int x = 0; x < getWidth(); x++)
+			if (row[x] == -1)
+				return false;
+		return true;
+#endif
 	}
 
-	inline bool Field::contains(const int x, const int y) {
-		return 0 <= x && x < sX && 0 <= y && y < sY;
+	template<int W, int H>
+	void BasicField<W, H>::copyRow(const int from, const int to) {
+		const int8_t* source = field + from * getStride();
+		int8_t* target = field + to * getStride();
+#ifdef FIELD_SSE2
+		for (int x = 0; x < getStride(); x += FIELD_ROW_ALIGNMENT)
+			_mm_store_si128((__m128i*)(target + x), _mm_load_si128((const __m128i*)(source + x)));
+#else
+		memcpy(target, source, getStride());
+#endif
+		notifyRow(to);
 	}
 
-	BrickDroppingField::BrickDroppingField(const std::shared_ptr<Field> _field) :field(_field) {}
+	template<int W, int H>
+	typename BasicField<W, H>::RowMask BasicField<W, H>::getRowMask(const int y) {
+		const int8_t* row = field + y * getStride();
+		uint64_t mask = 0;
+#ifdef FIELD_SSE2
+		const __m128i empty = _mm_set1_epi8(-1);
+		for (int x = 0; x < getWidth(); x += FIELD_ROW_ALIGNMENT) {
+			//one bit for every non-empty field of the block
+			uint64_t block = ~_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128((const __m128i*)(row + x)), empty)) & 0xffff;
+			mask |= block << x;
+		}
+		//ignoring the padding after the last field
+		if (getWidth() < 64)
+			mask &= ((uint64_t)1 << getWidth()) - 1;
+#else
+		for (int x = 0; x < getWidth(); x++)
+			if (row[x] != -1)
+				mask |= (uint64_t)1 << x;
+#endif
+		return (RowMask)mask;
+	}
 
-	int BrickDroppingField::getBrickState(const int x, const int y) {
-		return brick.get()[x + (brickSize - 1 - y) * brickSize];
+	template<int W, int H>
+	void BasicField<W, H>::save(int8_t* values) {
+		for (int y = 0; y < getHeight(); y++)
+			memcpy(values + y * getWidth(), field + y * getStride(), getWidth());
 	}
 
-	const int BrickDroppingField::get(const int x, const int y) {
+	template<int W, int H>
+	void BasicField<W, H>::restore(const int8_t* values) {
+		for (int y = 0; y < getHeight(); y++)
+			memcpy(field + y * getStride(), values + y * getWidth(), getWidth());
+	}
+
+	template<class F>
+	BasicBrickDroppingField<F>::BasicBrickDroppingField(const std::shared_ptr<F> _field) :field(_field), kickTable(&KICKS_LEGACY) {}
+
+	template<class F>
+	const int BasicBrickDroppingField<F>::get(const int x, const int y) {
 		//check if a brick is applied and the current field is in the are of this brick
 		if (brick != nullptr && brickX <= x && x < brickX + brickSize && brickY <= y && y < brickY + brickSize) {
-			//transformation to brick-view coordinates
-			int x1 = x - brickX;
-			int y1 = y - brickY;
-			//transformation to brick-template coordinates
-			transformFieldToPoint(&x1, &y1, brickRot, brickSize);
-			
-			if (getBrickState(x1, y1)) {//checking the template-value of this brick
+			//checking the brick's value at the brick-view coordinates
+			if (getFieldBrickState(x - brickX, y - brickY)) {
 				return brickType;//return the brick's state
 			}
 			else if (debug) return -3 - field->get(x, y);//only used for debugging-types (see gameData::debug and gameData::getTypeColor)
@@ -43,15 +146,16 @@ namespace gameUtils {
 		return field->get(x, y);
 	}
 
-	void BrickDroppingField::updateRegion(const int x, const int y, const int w, const int h) {
+	template<class F>
+	void BasicBrickDroppingField<F>::updateRegion(const int x, const int y, const int w, const int h) {
 		//iterate through every field in the given region
 		for (int y1 = 0; y1 < h; y1++)
 		{
 			for (int x1 = 0; x1 < w; x1++) {
 				int x2 = x + x1;
 				int y2 = y + y1;
-				//call the onChanged-function if the coordinates are contained in this field
-				if (field->contains(x2, y2)) {
+				//call the onChanged-function if it's set yet and the coordinates are contained in this field
+				if (onChanged != nullptr && field->contains(x2, y2)) {
 					onChanged(x2, y2, get(x2, y2));
 				}
 			}
@@ -59,15 +163,16 @@ namespace gameUtils {
 
 	}
 
-	void BrickDroppingField::startBrick(int _type) {
+	template<class F>
+	void BasicBrickDroppingField<F>::startBrick(int _type) {
 		//updating brick, brickType and brickSize
 		brickType = _type;
-		brick = bricks.get()[brickType];
-		brickSize = brickSizes.get()[brickType];
+		brick = bricks[brickType].data();
+		brickSize = brickSizes[brickType];
 
 		//calculating initial brick-coordinates (in the center above the field)
-		int x = fieldX / 2 - brickSize / 2 - brickSize % 2;
-		int y = fieldY;
+		int x = field->getWidth() / 2 - brickSize / 2 - brickSize % 2;
+		int y = field->getHeight();
 
 		//dropping the brick as long as it's bottom rows are empty
 		for (int y1 = brickSize - 1; y1 >= 0; y1--)
@@ -76,7 +181,7 @@ namespace gameUtils {
 			//check if the current brick-row is empty
 			for (int x1 = brickSize - 1; x1 >= 0; x1--)
 			{
-				if (brick.get()[x1 + brickSize * y1]) {
+				if (brick[x1 + brickSize * y1]) {
 					empty = false;
 					break;
 				}
@@ -93,10 +198,18 @@ namespace gameUtils {
 		brickRot = 0;
 
 		//updating the region, the brick has been set to
-		updateRegion(x, y, 4, 4);
+		updateRegion(x, y, brickSize, brickSize);
 	}
 
-	void BrickDroppingField::rotateBrick(int direction, int flag) {
+	template<class F>
+	void BasicBrickDroppingField<F>::rotateBrick(int direction, int flag) {
+		//translation of the kick that was chosen by canRotateBrick (the flag is the kick's index + 1)
+		int dx = 0, dy = 0;
+		if (flag > 0) {
+			const int transition = getKickTransition(brickRot, direction == TYPE_ROTATE_RIGHT);
+			dx = kickTable->dx[brickType][transition][flag - 1];
+			dy = kickTable->dy[brickType][transition][flag - 1];
+		}
 		//applying the given direction to the brickRot-value
 		if (direction == TYPE_ROTATE_LEFT) {
 			brickRot = (brickRot + 3) % 4;
@@ -104,27 +217,14 @@ namespace gameUtils {
 		else if (direction == TYPE_ROTATE_RIGHT) {
 			brickRot = (brickRot + 1) % 4;
 		}
-		//translating the brick depending on the flag's value
-		if (flag == 2) {
-			brickX++;
-			updateRegion(brickX - 1, brickY, 5, 4);
-		}
-		else if (flag == 3) {
-			brickX--;
-			updateRegion(brickX, brickY, 5, 4);
-		}
-		else if (flag == 4) {
-			brickX += 2;
-			updateRegion(brickX - 2, brickY, 6, 4);
-		}
-		else if (flag == 5) {
-			brickX -= 2;
-			updateRegion(brickX, brickY, 6, 4);
-		}
-		else updateRegion(brickX, brickY, 4, 4);
+		//translating the brick and updating the region covered before and after the rotation
+		brickX += dx;
+		brickY += dy;
+		updateRegion(dx < 0 ? brickX : brickX - dx, dy < 0 ? brickY : brickY - dy, brickSize + abs(dx), brickSize + abs(dy));
 	}
 
-	void BrickDroppingField::moveBrick(int direction) {
+	template<class F>
+	void BasicBrickDroppingField<F>::moveBrick(int direction) {
 		//applying the given direction to the brick's coordinates and updating the modified region
 		if (direction == TYPE_MOVE_DOWN) {
 			brickY--;
@@ -141,49 +241,75 @@ namespace gameUtils {
 
 	}
 
-	int BrickDroppingField::getFieldBrickState(const int x, const int y) {
+	template<class F>
+	int BasicBrickDroppingField<F>::getFieldBrickState(const int x, const int y) {
 		return getFieldBrickState(x, y, brickRot);
 	}
 
-	int BrickDroppingField::getFieldBrickState(const int x, const int y, const int rotation) {
-		int x1 = x;
-		int y1 = y;
-		transformFieldToPoint(&x1, &y1, rotation, brickSize);
-		return getBrickState(x1, y1);
+	template<class F>
+	int BasicBrickDroppingField<F>::getFieldBrickState(const int x, const int y, const int rotation) {
+		//the masks are the templates transformed by transformFieldToPoint (see gameData::makeBrickMasks)
+		return (brickMasks[brickType][rotation].rows[y] >> x) & 1;
 	}
 
-	int BrickDroppingField::canRotateBrick(int direction) {
-		//applying the given direction to brickRot and and storing the result in rotation (variable brickRot is not modified by this operation)
-		int rotation = 0;
-		if (direction == TYPE_ROTATE_LEFT) {
-			rotation = (brickRot + 3) % 4;
-		}
-		else if (direction == TYPE_ROTATE_RIGHT) {
-			rotation = (brickRot + 1) % 4;
-		}
-		//check whether the brick will overlap with the field when applying it's new rotation
-		//if the brick overlaps, checks for locations in x-direction are made and a flag is returned on success
-		//the flag will by handed over to BrickDroppingField::rotateBrick
-		if (!willOverlap(brickX, brickY, rotation)) {
-			return 1;
-		}
-		else if (brickSize>2 &&!willOverlap(brickX + 1, brickY, rotation)) {
-			return 2;
-		}
-		else if (brickSize > 2 && !willOverlap(brickX - 1, brickY, rotation)) {
-			return 3;
-		}
-		else if (brickSize > 3 && !willOverlap(brickX +2, brickY, rotation)) {
-			return 4;
+	template<class F>
+	uint64_t BasicBrickDroppingField<F>::getKickWindow(const int x, const int y) {
+		//columns inside the field's width and fields of a single row of the window
+		const uint64_t columns = field->getWidth() < 64 ? ((uint64_t)1 << field->getWidth()) - 1 : ~(uint64_t)0;
+		const uint64_t windowRow = ((uint64_t)1 << KICK_WINDOW_SIZE) - 1;
+		uint64_t window = 0;
+		for (int y1 = 0; y1 < KICK_WINDOW_SIZE; y1++) {
+			const int y2 = y + y1;
+			uint64_t row;
+			//rows below the field overlap, rows above it don't (like in willOverlap)
+			if (y2 < 0) row = windowRow;
+			else if (y2 >= field->getHeight()) row = 0;
+			else if (x >= 64) row = windowRow;
+			else {
+				//translating the non-empty fields and the fields right of the field to the window's offset
+				const uint64_t blocked = (uint64_t)field->getRowMask(y2) | ~columns;
+				if (x < 0) row = (blocked << -x) | (((uint64_t)1 << -x) - 1);
+				else if (x > 0) row = (blocked >> x) | ~(~(uint64_t)0 >> x);
+				else row = blocked;
+			}
+			window |= (row & windowRow) << (y1 * KICK_WINDOW_SIZE);
 		}
-		else if (brickSize > 3 && !willOverlap(brickX - 2, brickY, rotation)) {
-			return 5;
+		return window;
+	}
+
+	template<class F>
+	int BasicBrickDroppingField<F>::canRotateBrick(int direction) {
+		//translations of this rotation and their masks inside the window around the brick (see gameData::KickTable)
+		const int transition = getKickTransition(brickRot, direction == TYPE_ROTATE_RIGHT);
+		const int count = kickTable->counts[brickType][transition];
+		const uint64_t* masks = kickTable->masks[brickType][transition];
+		const uint64_t window = getKickWindow(brickX - MAX_KICK_OFFSET, brickY - MAX_KICK_OFFSET);
+
+		//testing every translation against the window (bit i of 'free' is set if translation i doesn't overlap)
+		int free = 0;
+#ifdef FIELD_SSE2
+		const __m128i windows = _mm_set1_epi64x((long long)window);
+		const __m128i zero = _mm_setzero_si128();
+		for (int i = 0; i < MAX_KICKS; i += 2) {
+			//one bit for every empty byte of the two intersections
+			const int empty = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(_mm_loadu_si128((const __m128i*)(masks + i)), windows), zero));
+			free |= ((empty & 0xff) == 0xff) << i | ((empty >> 8) == 0xff) << (i + 1);
 		}
-		//brick can't be rotated
-		return 0;
+#else
+		for (int i = 0; i < MAX_KICKS; i++)
+			if ((masks[i] & window) == 0)
+				free |= 1 << i;
+#endif
+		//ignoring the unused entries, the flag will by handed over to BrickDroppingField::rotateBrick
+		free &= (1 << count) - 1;
+		if (free == 0) return 0;
+		int kick = 0;
+		while (!((free >> kick) & 1)) kick++;
+		return kick + 1;
 	}
 
-	bool BrickDroppingField::willOverlap(int brickX, int brickY, int brickRot) {
+	template<class F>
+	bool BasicBrickDroppingField<F>::willOverlap(int brickX, int brickY, int brickRot) {
 		//check for every field in the brick's area
 		for (int y = 0; y < brickSize; y++)
 		{
@@ -192,7 +318,7 @@ namespace gameUtils {
 				//get the state of the brick (already transformed by x, y and brickRot)
 				int brickState = getFieldBrickState(x, y, brickRot);
 
-				if (brickState && y + brickY < fieldY) {
+				if (brickState && y + brickY < field->getHeight()) {
 					//translating the brick to it's actual location
 					int x1 = x + brickX;
 					int y1 = y + brickY;
@@ -207,7 +333,8 @@ namespace gameUtils {
 		return false;
 	}
 
-	bool BrickDroppingField::canMoveBrick(int direction) {
+	template<class F>
+	bool BasicBrickDroppingField<F>::canMoveBrick(int direction) {
 		//check whether the brick will overlap with the field when applying the given movement-direction
 		if (direction == TYPE_MOVE_DOWN) {
 			return !willOverlap(brickX, brickY - 1, brickRot);
@@ -221,7 +348,8 @@ namespace gameUtils {
 		return true;
 	}
 
-	bool BrickDroppingField::placeBrick() {
+	template<class F>
+	bool BasicBrickDroppingField<F>::placeBrick() {
 		//variable to check if the brick is fully contained in the field
 		bool inField = true;
 		for (int y = 0; y < brickSize; y++) {
@@ -242,19 +370,53 @@ namespace gameUtils {
 		brick = nullptr;
 		brickType = -1;
 		//updating the modified region
-		updateRegion(0, 0, fieldX, fieldY);
+		updateRegion(0, 0, field->getWidth(), field->getHeight());
 
 		return inField;
 	}
 
-	void transformFieldToPoint(int* x, int* y, const int rotation, const int brickSize) {
-		//applying a matrix depending on the given rotation around the brickSize's center to x and y
-		float cR = brickSize / 2.0 - 0.5;
-		int x1 = rotations.get()[rotation * 4] * (*x - cR) + rotations.get()[rotation * 4 + 1] * (*y - cR) + cR;
-		*y = rotations.get()[rotation * 4 + 2] * (*x - cR) + rotations.get()[rotation * 4 + 3] * (*y - cR) + cR;
-		*x = x1;
+	template<class F>
+	bool BasicBrickDroppingField<F>::saveState(FieldSnapshot* snapshot) {
+		//snapshots only have room for fields up to the game's dimensions
+		assert(field->getWidth() * field->getHeight() <= (int)sizeof(snapshot->values));
+		if (field->getWidth() * field->getHeight() > (int)sizeof(snapshot->values)) return false;
+		field->save(snapshot->values);
+		snapshot->brickType = (int8_t)getBrickType();
+		snapshot->brickX = (int8_t)brickX;
+		snapshot->brickY = (int8_t)brickY;
+		snapshot->brickRot = (int8_t)brickRot;
+		return true;
+	}
+
+	template<class F>
+	bool BasicBrickDroppingField<F>::restoreState(const FieldSnapshot* snapshot) {
+		assert(field->getWidth() * field->getHeight() <= (int)sizeof(snapshot->values));
+		if (field->getWidth() * field->getHeight() > (int)sizeof(snapshot->values)) return false;
+		field->restore(snapshot->values);
+		//restoring the brick-data (like startBrick without calculating the initial position)
+		if (snapshot->brickType >= 0) {
+			brickType = snapshot->brickType;
+			brick = bricks[brickType].data();
+			brickSize = brickSizes[brickType];
+		}
+		else {
+			brick = nullptr;
+			brickType = -1;
+		}
+		brickX = snapshot->brickX;
+		brickY = snapshot->brickY;
+		brickRot = snapshot->brickRot;
+		//updating every field
+		updateRegion(0, 0, field->getWidth(), field->getHeight());
+		return true;
 	}
 
+	//instantiations for configurable boards and the game's board
+	template class BasicField<DYNAMIC_SIZE, DYNAMIC_SIZE>;
+	template class BasicField<fieldX, fieldY>;
+	template class BasicBrickDroppingField<Field>;
+	template class BasicBrickDroppingField<GameField>;
+
 
 }
 
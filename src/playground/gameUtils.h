@@ -2,28 +2,98 @@
 #define GAME_UTILS_H
 
 #include <memory>
+#include <type_traits>
+#include <stdint.h>
 #include <glfw3.h>
 #include <iostream>
 
+namespace gameData {
+	struct KickTable;
+}
+
 namespace gameUtils {
 
+	struct FieldSnapshot;
+
+	//alignment of every row of a field (in bytes)
+	constexpr int FIELD_ROW_ALIGNMENT = 16;
+	//dimension of a field that is set at runtime
+	constexpr int DYNAMIC_SIZE = 0;
+
+	/*
+	* memory of a field with dimensions known at compile time
+	* the fields are stored inside the object (no allocation) and every index calculation uses constants
+	* @param W, H the dimensions of the field
+	*/
+	template<int W, int H> class FieldStorage {
+	public:
+		//smallest unsigned type with at least W bits (used for the occupancy of a row, see BasicField::getRowMask)
+		typedef typename std::conditional<W <= 8, uint8_t, typename std::conditional<W <= 16, uint16_t,
+			typename std::conditional<W <= 32, uint32_t, uint64_t>::type>::type>::type RowMask;
+		static_assert(W > 0 && H > 0 && W <= 64, "invalid field dimensions");
+		//dimensions of this field and bytes per row (W rounded up to a multiple of FIELD_ROW_ALIGNMENT)
+		constexpr static int getWidth() { return W; }
+		constexpr static int getHeight() { return H; }
+		constexpr static int getStride() { return (W + FIELD_ROW_ALIGNMENT - 1) / FIELD_ROW_ALIGNMENT * FIELD_ROW_ALIGNMENT; }
+	protected:
+		//values of this field (every row starts at a multiple of getStride() bytes)
+		alignas(FIELD_ROW_ALIGNMENT) int8_t field[getStride() * H];
+		/*
+		* the dimensions given to the constructor are ignored, they are given by W and H
+		*/
+		FieldStorage(int, int) {}
+	};
+
+	/*
+	* memory of a field with dimensions set at runtime (allocated once by the constructor)
+	*/
+	template<> class FieldStorage<DYNAMIC_SIZE, DYNAMIC_SIZE> {
+	public:
+		//type of the occupancy of a row (fields can be at most 64 units wide)
+		typedef uint64_t RowMask;
+		//dimensions of this field and bytes per row (sX rounded up to a multiple of FIELD_ROW_ALIGNMENT)
+		inline int getWidth() const { return sX; }
+		inline int getHeight() const { return sY; }
+		inline int getStride() const { return stride; }
+	protected:
+		//allocated memory and it's first aligned byte (the start of row 0)
+		std::unique_ptr<int8_t[]> storage;
+		int8_t* field;
+		const int sX, sY, stride;
+		/*
+		* @param _sX, _sY the dimensions of the field
+		*/
+		FieldStorage(const int _sX, const int _sY);
+	};
+
 	/*
 	* class that wraps an array of brick-types which represent the static background of the game
 	* this class provides some util functions to get/set values and listen to changes of single fields
+	*
+	* every field is stored as a single byte (the types range from -1 to brickCount-1)
+	* every row starts at a multiple of FIELD_ROW_ALIGNMENT bytes, so whole rows can be checked, cleared and copied with SIMD instructions
+	* the dimensions are either template parameters (W, H) or set at runtime (DYNAMIC_SIZE, see gameUtils::Field)
+	* the class is instantiated in gameUtils.cpp for the dynamic and the game's dimensions (gameData::GameField)
 	*/
-	class Field {
-		//values of this field (containing the type of every single field)
-		std::shared_ptr<int> field;
-		//dimensions of this field
-		const int sX, sY;
+	template<int W, int H> class BasicField : public FieldStorage<W, H> {
+		using FieldStorage<W, H>::field;
 		//function to be called when a field is changed
 		void (*onChanged)(int, int, int);
+		/*
+		* call the 'onChanged'-function for every field of a row (if it's set yet)
+		* @param y index of the row
+		*/
+		void notifyRow(const int y);
 	public:
+		using typename FieldStorage<W, H>::RowMask;
+		using FieldStorage<W, H>::getWidth;
+		using FieldStorage<W, H>::getHeight;
+		using FieldStorage<W, H>::getStride;
 		/*
 		* creates a new field of the given dimensions
-		* @param _sX, _sY the dimensions of the field
+		* @param _sX, _sY the dimensions of the field (only used by fields with DYNAMIC_SIZE)
 		*/
-		Field(const int _sX, const int _sY);
+		BasicField(const int _sX = W, const int _sY = H);
 		/*
 		* change the type of a single field
 		* @param x, y the field's coordinates
@@ -31,7 +101,7 @@ namespace gameUtils {
 		*/
 		inline void set(const int x, const int y, const int v) {
 			//set the field
-			field.get()[x + y * sX] = v;
+			field[x + y * getStride()] = (int8_t)v;
 			//call the 'onChanged'-function if it's set yet
 			if (onChanged != nullptr)onChanged(x, y, v);
 		}
@@ -41,7 +111,7 @@ namespace gameUtils {
 		* @returns type of the field
 		*/
 		inline const int get(const int x, const int y) {
-			return field.get()[x + y * sX];
+			return field[x + y * getStride()];
 		}
 		/*
 		* set which function will be called when a field changes
@@ -55,26 +125,52 @@ namespace gameUtils {
 		* @param x, y the coordinates to be checked
 		* @returns whether the coordinates are contained in this field or not
 		*/
-		inline bool contains(const int x, const int y);
+		inline bool contains(const int x, const int y) {
+			return 0 <= x && x < getWidth() && 0 <= y && y < getHeight();
+		}
 		/*
 		* clear the whole field
 		*/
-		inline void clear() {
-			//clear every single field
-			for (int y = 0; y < sY; y++)
-				for (int x = 0; x < sX; x++)
-					set(x, y, -1);
-		}
+		void clear();
 		/*
 		* clear a single row
 		* @param y index of the row that will be cleared
 		*/
-		inline void clearRow(static int y) {
-			for (int x = 0; x < sX; x++)
-				set(x, y, -1);
-		}
+		void clearRow(const int y);
+		/*
+		* check whether every field of a row is set
+		* @param y index of the row
+		* @return if the row doesn't contain empty fields
+		*/
+		bool isRowFull(const int y);
+		/*
+		* copy the values of a row to another row
+		* @param from index of the copied row
+		* @param to index of the row that will be overwritten
+		*/
+		void copyRow(const int from, const int to);
+		/*
+		* get the occupancy of a row
+		* @param y index of the row
+		* @return mask with bit x set if the field at x is not empty
+		*/
+		RowMask getRowMask(const int y);
+		/*
+		* copy the values of every field to a buffer
+		* @param values buffer of width*height values (index x + y * width)
+		*/
+		void save(int8_t* values);
+		/*
+		* restore the values of every field from a buffer
+		* the 'onChanged'-function is not called, the caller is responsible for updating the view
+		* @param values buffer of width*height values (index x + y * width)
+		*/
+		void restore(const int8_t* values);
 	};
 
+	//field with dimensions set at runtime (for configurable boards)
+	typedef BasicField<DYNAMIC_SIZE, DYNAMIC_SIZE> Field;
+
 	/*
 	* class that wraps a gameUtils::Field object and projects a dynamic brick on it's output
 	* this class is an extended interface for 'gameUtils::Field' and further implements:
@@ -82,20 +178,23 @@ namespace gameUtils {
 	*  - collision detection (whether an operation is possible or not)
 	*  - a combined view of background ('field') and current brick
 	*  - a listener that is directly connected to the update-methods of the main field
+	* @param F type of the wrapped field (a BasicField, instantiated in gameUtils.cpp for gameUtils::Field and gameData::GameField)
 	*/
-	class BrickDroppingField {
+	template<class F> class BasicBrickDroppingField {
 		//object this class wraps around
-		const std::shared_ptr<Field> field;
+		const std::shared_ptr<F> field;
 		/*
 		* function to be called when a field needs to be updated
 		* (on brick position/rotation change or changes of the underlying field)
 		*/
 		void (*onChanged)(int, int, int) = nullptr;
-		//current brick pointer and brick-data
-		std::shared_ptr<int> brick = nullptr;
+		//current brick pointer (one of the templates in gameData::bricks) and brick-data
+		const int8_t* brick = nullptr;
 		int brickType = 0, brickSize = 0;
 		//current brick translation and rotation
 		int brickX = 0, brickY = 0, brickRot = 0;
+		//translations tested when the brick is rotated (gameData::KICKS_LEGACY by default)
+		const gameData::KickTable* kickTable;
 		/*
 		* update the view of a given region
 		* @param x region's x-coordinate
@@ -105,13 +204,6 @@ namespace gameUtils {
 		*/
 		void updateRegion(const int x, const int y, const int w, const int h);
 		/*
-		* get the template brick-state of the current brick
-		* @param x brick's field x-coordinate
-		* @param y brick's field y-coordinate
-		* @returns template brick state
-		*/
-		int getBrickState(int x, int y);
-		/*
 		* get the brick state on a viewport-field
 		* (translation and rotation of the brick is taken into account)
 		* @param x field's x coordinate
@@ -134,6 +226,14 @@ namespace gameUtils {
 		* @return whether the configuration overlaps with the field or not
 		*/
 		bool willOverlap(int brickX, int brickY, int brickRot);
+		/*
+		* get the occupancy of an area of gameData::KICK_WINDOW_SIZE x gameData::KICK_WINDOW_SIZE fields
+		* (bit x + y * KICK_WINDOW_SIZE is set if the field at (x, y) relative to the area's offset would overlap with a brick,
+		* fields outside of the field's width or below it overlap, fields above it don't)
+		* @param x, y the area's offset
+		* @return bit mask of the area
+		*/
+		uint64_t getKickWindow(const int x, const int y);
 	public:
 		/*
 		* redirection method to Field::clear()
@@ -145,10 +245,25 @@ namespace gameUtils {
 		* redirection method to Field::clearRow(y)
 		* @param y row's index
 		*/
-		inline void clearRow(static int y) {
+		inline void clearRow(const int y) {
 			field->clearRow(y);
 		}
 		/*
+		* redirection method to Field::isRowFull(y)
+		* @param y row's index
+		*/
+		inline bool isRowFull(const int y) {
+			return field->isRowFull(y);
+		}
+		/*
+		* redirection method to Field::copyRow(from, to)
+		* @param from index of the copied row
+		* @param to index of the row that will be overwritten
+		*/
+		inline void copyRow(const int from, const int to) {
+			field->copyRow(from, to);
+		}
+		/*
 		* movement and rotation types
 		*/
 		const static int TYPE_MOVE_DOWN = 0;
@@ -158,9 +273,9 @@ namespace gameUtils {
 		const static int TYPE_ROTATE_RIGHT = 4;
 		/*
 		* constructs a BrickDroppingField
-		* @param _field gameUtils::Field to be wrapped by this class
+		* @param _field field to be wrapped by this class
 		*/
-		BrickDroppingField(const std::shared_ptr<Field> _field);
+		BasicBrickDroppingField(const std::shared_ptr<F> _field);
 		/*
 		* get type of a single field
 		* returns the brick-type if the brick overlaps with the field or redirects to Field::get(x,y)
@@ -198,16 +313,31 @@ namespace gameUtils {
 			return brick != nullptr;
 		}
 		/*
+		* get the type of the current brick
+		* @return brick's type or -1 if no brick is set
+		*/
+		inline int getBrickType() {
+			return brick != nullptr ? brickType : -1;
+		}
+		/*
 		* check if movement of the current brick in the given direction is allowed
 		* @param direction direction the brick may be moved to
 		*/
 		bool canMoveBrick(int direction);
 		/*
-		* check if movement of the current brick in the given direction is allowed
-		* @param direction direction the brick may be moved to
-		* @returns flag that is 0 when the brick can't be moved and may otherwise contain side effects pf this movement
+		* check if rotation of the current brick in the given direction is allowed
+		* every translation of the kick table is tested at once, the first one that doesn't overlap is applied by rotateBrick
+		* @param direction direction the brick may be rotated to
+		* @returns flag that is 0 when the brick can't be rotated and otherwise the index of the applied translation + 1
 		*/
 		int canRotateBrick(int direction);
+		/*
+		* set the translations that are tested when the brick is rotated
+		* @param _kickTable the kick table (e.g. gameData::KICKS_LEGACY or gameData::KICKS_SRS)
+		*/
+		inline void setKickTable(const gameData::KickTable* _kickTable) {
+			kickTable = _kickTable;
+		}
 
 		/*
 		* places the brick in the underlying gameUtils::Field object
@@ -215,6 +345,21 @@ namespace gameUtils {
 		*/
 		bool placeBrick();
 
+		/*
+		* save the state of the underlying field and the current brick
+		* @param snapshot the snapshot the state will be applied to
+		* @return whether the field fits into the snapshot (at most gameData::fieldX * gameData::fieldY values)
+		*/
+		bool saveState(FieldSnapshot* snapshot);
+
+		/*
+		* restore the state of the underlying field and the current brick
+		* the 'onChanged'-function is called for every single field afterwards
+		* @param snapshot the snapshot to restore
+		* @return whether the field fits into the snapshot (nothing is restored otherwise)
+		*/
+		bool restoreState(const FieldSnapshot* snapshot);
+
 		/*
 		* redirection method to Field::setOnChanged()
 		* and further support for brick-change events
@@ -226,14 +371,8 @@ namespace gameUtils {
 
 	};
 
-	/*
-	* translates brick-view-coordinates to brick-template-coordinates
-	* @param x brick's view x coordinate
-	* @param y brick's view y coordinate
-	* @param rotation brick's rotation
-	* @param brickSize brick's size (width and height)
-	*/
-	void transformFieldToPoint(int* x, int* y, const int rotation, const int brickSize);
+	//brick dropping field with dimensions set at runtime (for configurable boards)
+	typedef BasicBrickDroppingField<Field> BrickDroppingField;
 }
 
 using namespace gameUtils;
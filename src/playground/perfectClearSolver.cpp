@@ -0,0 +1,212 @@
+#include "perfectClearSolver.h"
+#include <atomic>
+#include <bitset>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+
+using namespace gameData;
+using namespace std::chrono;
+
+namespace gameUtils {
+
+	//range of the column-parity (empty fields in even columns minus empty fields in odd columns)
+	constexpr int PARITY_OFFSET = 4 * PerfectClearSolver::MAX_BRICKS;
+	typedef std::bitset<2 * PARITY_OFFSET + 1> ParitySet;
+
+	/*
+	* calculate the column-parities a brick can fill (depending on it's rotation and whether it's placed in an even or odd column)
+	* @param type brick's type
+	* @return set of parities (shifted by PARITY_OFFSET)
+	*/
+	static ParitySet getBrickParities(const int type) {
+		ParitySet parities;
+		for (int rotation = 0; rotation < 4; rotation++) {
+			const BrickMask& mask = getBrickMask(type, rotation);
+			int parity = 0;
+			for (int y = 0; y < mask.size; y++) {
+				for (int x = 0; x < mask.size; x++) {
+					if (mask.rows[y] & (1 << x)) parity += x % 2 == 0 ? 1 : -1;
+				}
+			}
+			parities.set(PARITY_OFFSET + parity);
+			parities.set(PARITY_OFFSET - parity);
+		}
+		return parities;
+	}
+
+	/*
+	* state of a single search thread
+	*/
+	struct SearchContext {
+		const int* bricks;
+		int count;
+		const KickTable* kicks;
+		//reachable parities: parities[depth][k] contains every sum of the bricks depth..depth+k-1
+		const std::vector<std::vector<ParitySet>>* parities;
+		//shared flags to stop every thread
+		std::atomic<bool>* found;
+		std::atomic<bool>* cancelled;
+		high_resolution_clock::time_point deadline;
+		//boards that can't be cleared (packed rows and depth)
+		std::unordered_set<uint64_t> failed;
+		//placements of the current branch
+		Placement path[PerfectClearSolver::MAX_BRICKS];
+		uint64_t nodeCount = 0;
+	};
+
+	//pack the rows below the height and the depth into a single key (the height follows from the depth and the number of fields)
+	static inline uint64_t getBoardKey(const BitBoard& board, const int height, const int depth) {
+		uint64_t key = 0;
+		for (int y = 0; y < height; y++) {
+			key |= (uint64_t)board.rows[y] << (fieldX * y);
+		}
+		return key | (uint64_t)depth << (fieldX * PerfectClearSolver::MAX_HEIGHT);
+	}
+
+	//check if every field of a placement is below the given height
+	static inline bool isBelow(const int type, const Placement& placement, const int height) {
+		const BrickMask& mask = getBrickMask(type, placement.rotation);
+		for (int by = mask.size - 1; by >= 0; by--) {
+			if (mask.rows[by]) return placement.y + by < height;
+		}
+		return true;
+	}
+
+	/*
+	* depth-first search for a perfect clear
+	* @param context state of the search thread
+	* @param board current board
+	* @param depth index of the brick to be placed
+	* @param height bricks are placed below this height
+	* @return whether the board can be cleared or not
+	*/
+	static bool search(SearchContext& context, const BitBoard& board, const int depth, const int height) {
+		if (board.isEmpty()) return true;
+		if (context.found->load(std::memory_order_relaxed) || context.cancelled->load(std::memory_order_relaxed)) return false;
+		//checking the time budget every 1024 boards
+		if ((++context.nodeCount & 1023) == 0 && high_resolution_clock::now() > context.deadline) {
+			context.cancelled->store(true);
+			return false;
+		}
+
+		//fill-count: the empty fields below the height need to be filled by the next k bricks
+		const int empty = height * fieldX - board.getCount();
+		const int k = empty / 4;
+		if (empty % 4 != 0 || depth + k > context.count) return false;
+
+		//cell-parity: the next k bricks need to fill the difference between empty fields in even and odd columns
+		int parity = 0;
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < fieldX; x++) {
+				if (!(board.rows[y] & (1 << x))) parity += x % 2 == 0 ? 1 : -1;
+			}
+		}
+		if (!(*context.parities)[depth][k].test(PARITY_OFFSET + parity)) return false;
+
+		const uint64_t key = getBoardKey(board, height, depth);
+		if (context.failed.count(key)) return false;
+
+		const int type = context.bricks[depth];
+		std::vector<Placement> placements;
+		generatePlacements(board, type, placements, *context.kicks);
+		for (const Placement& placement : placements) {
+			if (!isBelow(type, placement, height)) continue;
+			BitBoard next = board;
+			int removed = next.place(type, placement);
+			context.path[depth] = placement;
+			if (search(context, next, depth + 1, height - removed)) return true;
+		}
+
+		context.failed.insert(key);
+		return false;
+	}
+
+	PerfectClearSolver::PerfectClearSolver(const int _maxHeight, const int _threadCount, const long _timeBudget, const KickTable* _kicks) :
+		maxHeight(_maxHeight < MAX_HEIGHT ? _maxHeight : MAX_HEIGHT), threadCount(_threadCount), timeBudget(_timeBudget), kicks(_kicks) {}
+
+	bool PerfectClearSolver::solve(const BitBoard& board, const int* bricks, const int count, std::vector<Placement>& solution) {
+		const int brickCount = count < MAX_BRICKS ? count : MAX_BRICKS;
+		const high_resolution_clock::time_point deadline = high_resolution_clock::now() + milliseconds(timeBudget);
+		nodeCount = 0;
+		timedOut = false;
+
+		if (board.isEmpty()) return true;
+		if (board.getHeight() > maxHeight || brickCount == 0) return false;
+
+		//calculating the reachable parities of every sequence of bricks
+		std::vector<std::vector<ParitySet>> parities(brickCount + 1, std::vector<ParitySet>(brickCount + 1));
+		for (int depth = 0; depth <= brickCount; depth++) {
+			parities[depth][0].set(PARITY_OFFSET);
+			for (int k = 1; depth + k <= brickCount; k++) {
+				ParitySet brickParities = getBrickParities(bricks[depth + k - 1]);
+				for (int p = 0; p < 2 * PARITY_OFFSET + 1; p++) {
+					if (!parities[depth][k - 1].test(p)) continue;
+					for (int q = 0; q < 2 * PARITY_OFFSET + 1; q++) {
+						int sum = p + q - PARITY_OFFSET;
+						if (brickParities.test(q) && sum >= 0 && sum < 2 * PARITY_OFFSET + 1) parities[depth][k].set(sum);
+					}
+				}
+			}
+		}
+
+		int threads = threadCount > 0 ? threadCount : (int)std::thread::hardware_concurrency();
+		if (threads <= 0) threads = 1;
+
+		std::atomic<bool> found{ false }, cancelled{ false };
+		std::mutex solutionMutex;
+
+		//trying every height the board can be cleared at (the empty fields need to be a multiple of 4)
+		for (int height = board.getHeight(); height <= maxHeight && !found && !cancelled; height++) {
+			if ((height * fieldX - board.getCount()) % 4 != 0) continue;
+
+			std::vector<Placement> roots;
+			generatePlacements(board, bricks[0], roots, *kicks);
+			std::atomic<size_t> nextRoot{ 0 };
+			std::atomic<uint64_t> nodes{ 0 };
+
+			//every thread takes the next location of the first brick until one finds a solution
+			auto work = [&]() {
+				SearchContext context;
+				context.bricks = bricks;
+				context.count = brickCount;
+				context.kicks = kicks;
+				context.parities = &parities;
+				context.found = &found;
+				context.cancelled = &cancelled;
+				context.deadline = deadline;
+				for (size_t i = nextRoot++; i < roots.size() && !found && !cancelled; i = nextRoot++) {
+					if (!isBelow(bricks[0], roots[i], height)) continue;
+					BitBoard next = board;
+					int removed = next.place(bricks[0], roots[i]);
+					context.path[0] = roots[i];
+					if (search(context, next, 1, height - removed)) {
+						std::lock_guard<std::mutex> lock(solutionMutex);
+						if (!found) {
+							found = true;
+							//the number of used bricks equals the depth at which the board became empty
+							int used = (height * fieldX - board.getCount()) / 4;
+							solution.assign(context.path, context.path + used);
+						}
+					}
+				}
+				nodes += context.nodeCount;
+			};
+
+			std::vector<std::thread> workers;
+			for (int i = 1; i < threads; i++) {
+				workers.emplace_back(work);
+			}
+			work();
+			for (std::thread& worker : workers) {
+				worker.join();
+			}
+			nodeCount += nodes;
+		}
+
+		timedOut = cancelled && !found;
+		return found;
+	}
+
+}
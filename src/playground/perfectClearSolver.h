@@ -0,0 +1,72 @@
+#ifndef PERFECT_CLEAR_SOLVER_H
+#define PERFECT_CLEAR_SOLVER_H
+
+#include <vector>
+#include <stdint.h>
+#include "bitBoard.h"
+
+namespace gameUtils {
+
+	/*
+	* class that checks whether a board can be cleared completely with a known sequence of bricks
+	*
+	* the search is a depth-first search over the final locations of generatePlacements (so every solution can be played with
+	* the rotations and translations of BrickDroppingField), bricks are never placed above a fixed height
+	* branches are pruned if:
+	*  - the empty fields below that height can't be filled by the remaining bricks (fill-count)
+	*  - the difference between empty fields in even and odd columns can't be produced by the remaining bricks (cell-parity)
+	*  - the same board was already checked at the same depth (memoization)
+	* the locations of the first brick are distributed over multiple threads
+	*/
+	class PerfectClearSolver {
+		//maximum height bricks are placed at (at most MAX_HEIGHT)
+		int maxHeight;
+		//number of threads (0 for the number of hardware threads)
+		int threadCount;
+		//maximum duration of a search (in milliseconds)
+		long timeBudget;
+		//kick table of the rotations the placements are generated with
+		const gameData::KickTable* kicks;
+		//statistics of the last search
+		uint64_t nodeCount = 0;
+		bool timedOut = false;
+	public:
+		//limits of the packed representation used for memoization
+		const static int MAX_HEIGHT = 6;
+		const static int MAX_BRICKS = 15;
+		/*
+		* constructs a solver
+		* @param _maxHeight maximum height bricks are placed at
+		* @param _threadCount number of threads (0 for the number of hardware threads)
+		* @param _timeBudget maximum duration of a search (in milliseconds)
+		* @param _kicks kick table of the rotations (needs to equal the table of the BrickDroppingField)
+		*/
+		PerfectClearSolver(const int _maxHeight = 4, const int _threadCount = 0, const long _timeBudget = 1000, const gameData::KickTable* _kicks = &gameData::KICKS_LEGACY);
+		/*
+		* search a sequence of placements that clears the board completely
+		* @param board the board to be cleared
+		* @param bricks types of the bricks in the order they are dropped (the first brick starts at it's initial location)
+		* @param count number of bricks (bricks after MAX_BRICKS are ignored)
+		* @param solution vector, the placement of every used brick will be applied to (in the order of 'bricks')
+		* @return whether a solution was found or not
+		*/
+		bool solve(const BitBoard& board, const int* bricks, const int count, std::vector<Placement>& solution);
+		/*
+		* get the number of checked boards during the last search
+		* @return number of boards
+		*/
+		inline uint64_t getNodeCount() {
+			return nodeCount;
+		}
+		/*
+		* check whether the last search was cancelled because of it's time budget
+		* @return if the search timed out
+		*/
+		inline bool hasTimedOut() {
+			return timedOut;
+		}
+	};
+
+}
+
+#endif
@@ -0,0 +1,114 @@
+#include "placementTable.h"
+#include <algorithm>
+#include <stdio.h>
+
+using namespace gameData;
+
+namespace gameUtils {
+
+	static_assert(fieldX * PlacementTable::MAX_HEIGHT + 22 <= 64, "an entry needs to fit into 64 bits");
+
+	//number of bits of the placement inside an entry
+	constexpr int PLACEMENT_BITS = 16;
+
+	//pack the rows below MAX_HEIGHT and the brick types (everything of an entry except the placement)
+	static inline uint64_t getKey(const BitBoard& board, const int brick, const int nextBrick) {
+		uint64_t key = 0;
+		for (int y = 0; y < PlacementTable::MAX_HEIGHT; y++) {
+			key |= (uint64_t)board.rows[y] << (fieldX * y);
+		}
+		return key << 6 | (uint64_t)brick << 3 | (uint64_t)nextBrick;
+	}
+
+	bool PlacementTable::open(const char* path, const KickTable& kicks) {
+		close();
+		if (!file.open(path)) return false;
+
+		//validating the header and the size (the entries are not read)
+		const PlacementTableHeader* h = (const PlacementTableHeader*)file.data();
+		if (file.size() < sizeof(PlacementTableHeader) || h->magic != MAGIC || h->version != VERSION
+			|| h->fieldX != fieldX || h->fieldY != fieldY || h->maxHeight > MAX_HEIGHT || h->rulesHash != getRulesHash(kicks)
+			|| file.size() != sizeof(PlacementTableHeader) + h->entryCount * sizeof(uint64_t)) {
+			file.close();
+			return false;
+		}
+		header = h;
+		entries = (const uint64_t*)(h + 1);
+		return true;
+	}
+
+	void PlacementTable::close() {
+		file.close();
+		header = nullptr;
+		entries = nullptr;
+	}
+
+	bool PlacementTable::lookup(const BitBoard& board, const int brick, const int nextBrick, Placement* placement) const {
+		if (header == nullptr || board.getHeight() > (int)header->maxHeight) return false;
+
+		//binary search of the first entry with the same key
+		const uint64_t key = getKey(board, brick, nextBrick);
+		const uint64_t* end = entries + header->entryCount;
+		const uint64_t* entry = std::lower_bound(entries, end, key << PLACEMENT_BITS);
+		if (entry == end || *entry >> PLACEMENT_BITS != key) return false;
+
+		placement->x = (int8_t)((*entry & 0x1f) - 8);
+		placement->y = (int8_t)((*entry >> 5 & 0x3f) - 8);
+		placement->rotation = (int8_t)(*entry >> 11 & 0x3);
+		return true;
+	}
+
+	uint64_t PlacementTable::getRulesHash(const KickTable& kicks) {
+		//FNV-1a over the field's dimensions, every brick mask and every kick
+		uint64_t hash = 14695981039346656037ull;
+		auto add = [&hash](const uint32_t value) {
+			for (int i = 0; i < 4; i++) {
+				hash ^= (value >> (8 * i)) & 0xff;
+				hash *= 1099511628211ull;
+			}
+		};
+		add(fieldX);
+		add(fieldY);
+		for (int type = 0; type < brickCount; type++) {
+			for (int rotation = 0; rotation < 4; rotation++) {
+				const BrickMask& mask = getBrickMask(type, rotation);
+				add(mask.size);
+				for (int y = 0; y < 4; y++) {
+					add(mask.rows[y]);
+				}
+			}
+			for (int transition = 0; transition < 8; transition++) {
+				add(kicks.counts[type][transition]);
+				for (int kick = 0; kick < kicks.counts[type][transition]; kick++) {
+					add((uint8_t)kicks.dx[type][transition][kick] | (uint8_t)kicks.dy[type][transition][kick] << 8);
+				}
+			}
+		}
+		return hash;
+	}
+
+	uint64_t PlacementTable::packEntry(const BitBoard& board, const int brick, const int nextBrick, const Placement& placement) {
+		uint64_t value = (uint64_t)(placement.x + 8) | (uint64_t)(placement.y + 8) << 5 | (uint64_t)placement.rotation << 11;
+		return getKey(board, brick, nextBrick) << PLACEMENT_BITS | value;
+	}
+
+	bool PlacementTable::write(const char* path, const int maxHeight, std::vector<uint64_t>& entries) {
+		std::sort(entries.begin(), entries.end());
+
+		PlacementTableHeader h = {};
+		h.magic = MAGIC;
+		h.version = VERSION;
+		h.fieldX = fieldX;
+		h.fieldY = fieldY;
+		h.maxHeight = maxHeight;
+		h.rulesHash = getRulesHash();
+		h.entryCount = entries.size();
+
+		FILE* f = fopen(path, "wb");
+		if (f == nullptr) return false;
+		bool success = fwrite(&h, sizeof(h), 1, f) == 1
+			&& fwrite(entries.data(), sizeof(uint64_t), entries.size(), f) == entries.size();
+		return fclose(f) == 0 && success;
+	}
+
+}
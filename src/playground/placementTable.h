@@ -0,0 +1,115 @@
+#ifndef PLACEMENT_TABLE_H
+#define PLACEMENT_TABLE_H
+
+#include <vector>
+#include <stdint.h>
+#include <common/mappedfile.hpp>
+#include "bitBoard.h"
+
+namespace gameUtils {
+
+	/*
+	* header at the start of a placement table file
+	*
+	* the header is followed by 'entryCount' sorted uint64_t entries, every entry packs (from the highest to the lowest bits):
+	*  - board      the rows below 'maxHeight' (fieldX bits per row, row 0 in the lowest bits)
+	*  - brick      type of the current brick (3 bits)
+	*  - nextBrick  type of the next brick (3 bits)
+	*  - placement  the chosen placement (16 bits: rotation, y + 8, x + 8)
+	* the entries can be searched directly in the mapped file, so opening a table takes constant time
+	*/
+	struct PlacementTableHeader {
+		uint32_t magic;
+		uint32_t version;
+		//dimensions of the field and height of the stored boards
+		uint32_t fieldX, fieldY;
+		uint32_t maxHeight;
+		uint32_t reserved;
+		//hash of the brick shapes and rotation rules the table was built with (see PlacementTable::getRulesHash)
+		uint64_t rulesHash;
+		uint64_t entryCount;
+	};
+
+	/*
+	* class that looks up precomputed placements (built by the placementtable tool) in a memory-mapped file
+	*/
+	class PlacementTable {
+		//the mapped file, it's header and entries
+		MappedFile file;
+		const PlacementTableHeader* header = nullptr;
+		const uint64_t* entries = nullptr;
+	public:
+		//identification of the file ("PLCT") and version of it's layout
+		const static uint32_t MAGIC = 0x54434c50;
+		const static uint32_t VERSION = 1;
+		//maximum height of the stored boards (limited by the bits of an entry)
+		const static int MAX_HEIGHT = 4;
+		/*
+		* map a table file
+		* @param path path of the file
+		* @param kicks kick table of the rotations the placements need to be reachable with
+		* @return whether the file could be mapped and was built for the current field and rules
+		*/
+		bool open(const char* path, const gameData::KickTable& kicks = gameData::KICKS_LEGACY);
+		/*
+		* unmap the table file
+		*/
+		void close();
+		/*
+		* look up the placement of a brick
+		* @param board the board the brick is dropped on
+		* @param brick type of the current brick
+		* @param nextBrick type of the next brick
+		* @param placement the stored placement will be applied to
+		* @return whether the table contains the combination or not
+		*/
+		bool lookup(const BitBoard& board, const int brick, const int nextBrick, Placement* placement) const;
+		/*
+		* check whether a table is mapped
+		* @return if a table is mapped
+		*/
+		inline bool isOpen() const {
+			return header != nullptr;
+		}
+		/*
+		* get the height of the stored boards
+		* @return maximum height
+		*/
+		inline int getMaxHeight() const {
+			return header != nullptr ? (int)header->maxHeight : 0;
+		}
+		/*
+		* get the number of stored combinations
+		* @return number of entries
+		*/
+		inline uint64_t getEntryCount() const {
+			return header != nullptr ? header->entryCount : 0;
+		}
+		/*
+		* calculate a hash of every brick mask, the kicks and the field's dimensions (tables of different rules are rejected)
+		* @param kicks kick table of the rotations
+		* @return the hash
+		*/
+		static uint64_t getRulesHash(const gameData::KickTable& kicks = gameData::KICKS_LEGACY);
+		/*
+		* pack a combination into an entry
+		* @param board the board (it's height needs to be at most MAX_HEIGHT)
+		* @param brick type of the current brick
+		* @param nextBrick type of the next brick
+		* @param placement the chosen placement
+		* @return the entry
+		*/
+		static uint64_t packEntry(const BitBoard& board, const int brick, const int nextBrick, const Placement& placement);
+		/*
+		* sort the entries and write them into a table file
+		* @param path path of the file
+		* @param maxHeight height of the stored boards
+		* @param entries the entries (sorted by this function)
+		* @return whether the file could be written or not
+		*/
+		static bool write(const char* path, const int maxHeight, std::vector<uint64_t>& entries);
+	};
+
+}
+
+#endif
@@ -0,0 +1,95 @@
+#include "placementTable.h"
+#include "bot.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace gameData;
+using namespace gameUtils;
+using namespace std::chrono;
+
+/*
+* offline builder of the placement table the bot uses for low boards
+* usage: placementtable [maxHeight] [file]
+*
+* every board that can be reached from the empty field without exceeding 'maxHeight' rows is enumerated with generatePlacements
+* (the same final locations the BrickDroppingField can reach), the placement for every combination of current and next brick
+* is calculated by Bot::searchAll and stored in the table (see placementTable.h for the file's layout)
+*/
+
+//pack the rows of a board below the height
+static uint64_t packRows(const BitBoard& board, const int height) {
+	uint64_t key = 0;
+	for (int y = 0; y < height; y++) {
+		key |= (uint64_t)board.rows[y] << (fieldX * y);
+	}
+	return key;
+}
+
+int main(int argc, char* argv[]) {
+	int maxHeight = argc > 1 ? atoi(argv[1]) : 2;
+	const char* path = argc > 2 ? argv[2] : "placements.bin";
+	if (maxHeight <= 0 || maxHeight > PlacementTable::MAX_HEIGHT) {
+		fprintf(stderr, "usage: %s [maxHeight (1-%d)] [file]\n", argv[0], PlacementTable::MAX_HEIGHT);
+		return -1;
+	}
+	auto tStart = high_resolution_clock::now();
+
+	//breadth-first enumeration of the reachable boards
+	std::vector<BitBoard> boards(1);
+	std::unordered_set<uint64_t> visited{ 0 };
+	std::vector<Placement> placements;
+	for (size_t i = 0; i < boards.size(); i++) {
+		for (int type = 0; type < brickCount; type++) {
+			placements.clear();
+			generatePlacements(boards[i], type, placements);
+			for (const Placement& placement : placements) {
+				BitBoard board = boards[i];
+				board.place(type, placement);
+				if (board.getHeight() <= maxHeight && visited.insert(packRows(board, maxHeight)).second) {
+					boards.push_back(board);
+				}
+			}
+		}
+	}
+	printf("%d boards with at most %d rows\n", (int)boards.size(), maxHeight);
+	fflush(stdout);
+
+	//searching the placements of every board on all hardware threads
+	std::vector<uint64_t> entries;
+	std::mutex entriesMutex;
+	std::atomic<size_t> nextBoard{ 0 };
+	auto work = [&]() {
+		std::vector<uint64_t> local;
+		Placement best[brickCount];
+		for (size_t i; (i = nextBoard++) < boards.size();) {
+			for (int brick = 0; brick < brickCount; brick++) {
+				if (!Bot::searchAll(boards[i], brick, best)) continue;
+				for (int nextBrick = 0; nextBrick < brickCount; nextBrick++) {
+					local.push_back(PlacementTable::packEntry(boards[i], brick, nextBrick, best[nextBrick]));
+				}
+			}
+		}
+		std::lock_guard<std::mutex> lock(entriesMutex);
+		entries.insert(entries.end(), local.begin(), local.end());
+	};
+	std::vector<std::thread> threads;
+	int threadCount = std::max(1u, std::thread::hardware_concurrency());
+	for (int i = 0; i < threadCount; i++) {
+		threads.emplace_back(work);
+	}
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+
+	if (!PlacementTable::write(path, maxHeight, entries)) {
+		fprintf(stderr, "can't write %s\n", path);
+		return -1;
+	}
+	printf("wrote %d entries to %s in %.1f s\n", (int)entries.size(), path, duration_cast<milliseconds>(high_resolution_clock::now() - tStart).count() / 1000.0);
+	return 0;
+}
@@ -9,6 +9,7 @@ GLFWwindow* window;
 using namespace glm;
 
 #include <common/shader.hpp>
+#include <embeddedShaders.h>
 
 // Include standard headers
 #include <stdio.h>
@@ -17,6 +18,11 @@ using namespace glm;
 // gameData and gameUtils
 #include "gameData.h"
 #include "gameUtils.h"
+#include "bitBoard.h"
+#include "perfectClearSolver.h"
+#include "placementTable.h"
+#include "bot.h"
+#include "fieldVertices.h"
 
 // some libraries for sleeping, time measurement, calculation
 #include <iostream>
@@ -24,6 +30,7 @@ using namespace glm;
 #include <thread>
 #include <string>
 #include <math.h>
+#include <algorithm>
 
 /* library for playing music under windows
 *  music files "Tetris.wav" and "TetrisIntro.wav" need to be located in the output directory and all comments starting with '//music:' need to be uncommented
@@ -43,77 +50,66 @@ void staticInitVertexBuffer() {
 
 	glGenBuffers(1, &vertexbuffer); 
 	glGenBuffers(1, &colorbuffer);
+	glGenBuffers(1, &shapebuffer);
 
 	//getting the background color for every single field
-	float r = fieldBackgroundColor.get()[0];
-	float g = fieldBackgroundColor.get()[1];
-	float b = fieldBackgroundColor.get()[2];
-
-	//iterating through every field of the preview section
-	for (int y = 0; y < 4; y++)
-	{
-		for (int x = 0; x < 4; x++)
-		{
-			//calculation the single field offset
-			float px = 1.0f - (4 - x) * mxPreview - spacing * mxPreview;
-			float py = 1.0f - (4 - y) * myPreview - spacing * myPreview;
-
-			//transforming the data in template "vertex_buffer_single" to the vertex buffer (and inserting the colors in the color-buffer)
-			for (int i = 0; i < 6; i++)
-			{
-				g_vertex_buffer_data[18 * (x + (3 - y) * 4) + 3 * i] = px + vertex_buffer_single[3 * i] * mxPreview * (1 - spacing * 2);
-				g_vertex_buffer_data[18 * (x + (3 - y) * 4) + 3 * i + 1] = py + vertex_buffer_single[3 * i + 1] * myPreview * (1 - spacing * 2);
-				g_vertex_buffer_data[18 * (x + (3 - y) * 4) + 3 * i + 2] = vertex_buffer_single[3 * i + 2];
-				g_color_buffer_data[18 * (x + (3 - y) * 4) + 3 * i] = r;
-				g_color_buffer_data[18 * (x + (3 - y) * 4) + 3 * i + 1] = g;
-				g_color_buffer_data[18 * (x + (3 - y) * 4) + 3 * i + 2] = b;
-			}
-		}
+	float r = fieldBackgroundColor[0];
+	float g = fieldBackgroundColor[1];
+	float b = fieldBackgroundColor[2];
+
+	//the vertices are stored in fields of their region (placed in the window by the shader, see updateLayout)
+	//every row of both regions is transformed at once (see transformFieldRow)
+	for (int y = 0; y < 4; y++) {
+		transformFieldRow(4, y, FIELD_TRANSFORM_IDENTITY, &g_vertex_buffer_data[18 * getPreviewFieldIndex(0, y)], &g_shape_buffer_data[24 * getPreviewFieldIndex(0, y)]);
 	}
-
-	//iterating through every field of the main field
 	for (int y = 0; y < fieldY; y++) {
-		for (int x = 0; x < fieldX; x++)
-		{
-			//calculation the single field offset
-			float px = x * mx + spacing * mx - 1.0f;
-			float py = y * my + spacing * my - 1.0f;
-
-			//transforming the data in template "vertex_buffer_single" to the vertex buffer (and inserting the colors in the color-buffer)
-			for (int i = 0; i < 6; i++)
-			{
-				g_vertex_buffer_data[18 * (16 + x + (fieldY - 1 - y) * fieldX) + 3 * i] = px + vertex_buffer_single[3 * i] * mx * (1 - spacing * 2);
-				g_vertex_buffer_data[18 * (16 + x + (fieldY - 1 - y) * fieldX) + 3 * i + 1] = py + vertex_buffer_single[3 * i + 1] * my * (1 - spacing * 2);
-				g_vertex_buffer_data[18 * (16 + x + (fieldY - 1 - y) * fieldX) + 3 * i + 2] = vertex_buffer_single[3 * i + 2];
-				g_color_buffer_data[18 * (16 + x + (fieldY - 1 - y) * fieldX) + 3 * i] = r;
-				g_color_buffer_data[18 * (16 + x + (fieldY - 1 - y) * fieldX) + 3 * i + 1] = g;
-				g_color_buffer_data[18 * (16 + x + (fieldY - 1 - y) * fieldX) + 3 * i + 2] = b;
-			}
-		}
+		transformFieldRow(fieldX, y, FIELD_TRANSFORM_IDENTITY, &g_vertex_buffer_data[18 * getMainFieldIndex(0, y)], &g_shape_buffer_data[24 * getMainFieldIndex(0, y)]);
+	}
+
+	//inserting the background color of every field in the color-buffer
+	for (int i = 0; i < 6 * (fieldX * fieldY + 16); i++)
+	{
+		g_color_buffer_data[3 * i] = r;
+		g_color_buffer_data[3 * i + 1] = g;
+		g_color_buffer_data[3 * i + 2] = b;
 	}
 }
 
 void updateField(int x, int y) {
 	//getting the new type from the field-array
 	int type = brickDroppingField->get(x, y);
+	setBoardTextureField(x, y, type);
 
 	float r, g, b;
 	//getting the type-specific color
 	getTypeColor(type, &r, &g, &b);
 
+	//skipping fields that keep their color (e.g. the unchanged fields of a moved brick's area)
+	const float* color = &g_color_buffer_data[18 * getMainFieldIndex(x, y)];
+	if (color[0] == r && color[1] == g && color[2] == b) return;
+	damageField(x, y);
+
 	//applying the color to the corresponding vertices
 	for (int i = 0; i < 6; i++)
 	{
-		g_color_buffer_data[18 * (16 + x + (fieldY - 1 - y) * fieldX) + 3 * i] = r;
-		g_color_buffer_data[18 * (16 + x + (fieldY - 1 - y) * fieldX) + 3 * i + 1] = g;
-		g_color_buffer_data[18 * (16 + x + (fieldY - 1 - y) * fieldX) + 3 * i + 2] = b;
+		g_color_buffer_data[18 * getMainFieldIndex(x, y) + 3 * i] = r;
+		g_color_buffer_data[18 * getMainFieldIndex(x, y) + 3 * i + 1] = g;
+		g_color_buffer_data[18 * getMainFieldIndex(x, y) + 3 * i + 2] = b;
 	}
 }
 
 void updatePreviewField(int x, int y, int type) {
+	//row y of the preview is drawn at row 3 - y
+	setBoardTextureField(x, fieldY + 3 - y, type);
+
 	float r, g, b;
 	//getting the type-specific color
 	getTypeColor(type, &r, &g, &b);
+
+	//skipping fields that keep their color
+	const float* color = &g_color_buffer_data[18 * (x + y * 4)];
+	if (color[0] == r && color[1] == g && color[2] == b) return;
+	damagedPreview = true;
 	
 	//applying the color to the corresponding vertices
 	for (int i = 0; i < 6; i++)
@@ -212,14 +208,8 @@ void updateGameMechanics() {
 
 					for (int y = 0; y < fieldY; y++)
 					{
-						//check if the row is filled
-						bool filled = true;
-						for (int x = 0; x < fieldX; x++) {
-							if (brickDroppingField->get(x, y) == -1) {
-								filled = false;
-								break;
-							}
-						}
+						//check if the row is filled (the brick has already been placed in the field)
+						bool filled = brickDroppingField->isRowFull(y);
 
 						//increasing collapseCount if row is filled and changing collapseConfiguration (which is needed for the collapse-animation)
 						//refer to 'playground.h' for further detail on 'collapseConfiguration'
@@ -271,6 +261,8 @@ void setProgramState(int state) {
 		}
 		else if (state == PROGRAM_STATE_IDLE) {//stopping any music if this feature is enabled
 			//music: PlaySound((LPCSTR)NULL, NULL, SND_FILENAME | SND_ASYNC | SND_LOOP);
+			//the finished game can't be rewound
+			snapshotRing.clear();
 		}
 		else if (state == PROGRAM_STATE_WAIT_DELAY) {//resetting the wait time
 			tAnimationStart = high_resolution_clock::now();
@@ -278,29 +270,236 @@ void setProgramState(int state) {
 	}
 }
 
-void applyTransformToSingleField(const int x, const int y, const mat3* const transform) {
-	//calculating the initial coordinates of the field
-	float px = x * mx + spacing * mx - 1.0f;
-	float py = y * my + spacing * my - 1.0f;
+void saveSnapshot(GameSnapshot* snapshot) {
+	auto now = high_resolution_clock::now();
 
-	//applying the transformation to every vertex
-	for (int i = 0; i < 6; i++)
+	brickDroppingField->saveState(&snapshot->field);
+	snapshot->brickGenerator = brickGenerator;
+	snapshot->score = score;
+	snapshot->nextBrick = nextBrick;
+	snapshot->programState = programState;
+	snapshot->programStateAfterWait = programStateAfterWait;
+	snapshot->dTDrop = dTDrop;
+
+	//storing the timers relative to the current time
+	snapshot->elapsedStart = (int32_t)duration_cast<milliseconds>(now - tStart).count();
+	snapshot->elapsedAnimationStart = (int32_t)duration_cast<milliseconds>(now - tAnimationStart).count();
+	snapshot->elapsedPauseStart = (int32_t)duration_cast<milliseconds>(now - pauseStart).count();
+	snapshot->pause = pause;
+
+	snapshot->animationPhase = (int8_t)animationPhase;
+	snapshot->collapseRowCount = (int8_t)collapseRowCount;
+	for (int y = 0; y < fieldY; y++) {
+		snapshot->collapseConfiguration[y] = (int8_t)collapseConfiguration.get()[y];
+	}
+}
+
+void restoreSnapshot(const GameSnapshot* snapshot) {
+	auto now = high_resolution_clock::now();
+
+	//restoring the field (updates the main-area), the preview-field and the score
+	brickDroppingField->restoreState(&snapshot->field);
+	//the restored brick may have left it's initial location, the bot starts with the next brick
+	botMoved = true;
+	brickGenerator = snapshot->brickGenerator;
+	setNextBrick(snapshot->nextBrick);
+	setScore(snapshot->score);
+	//the program state is set directly, setProgramState() would apply the side effects of entering the state
+	programState = snapshot->programState;
+	programStateAfterWait = snapshot->programStateAfterWait;
+	dTDrop = snapshot->dTDrop;
+
+	//restoring the timers relative to the current time
+	tStart = now - milliseconds(snapshot->elapsedStart);
+	tAnimationStart = now - milliseconds(snapshot->elapsedAnimationStart);
+	pauseStart = now - milliseconds(snapshot->elapsedPauseStart);
+	pause = snapshot->pause;
+
+	animationPhase = snapshot->animationPhase;
+	collapseRowCount = snapshot->collapseRowCount;
+	for (int y = 0; y < fieldY; y++) {
+		collapseConfiguration.get()[y] = snapshot->collapseConfiguration[y];
+	}
+
+	//restoring every field's coordinates (a running animation recalculates them in the next loop cycle)
+	mat3 transform = {
+		1,0,0,
+		0,1,0,
+		0,0,1
+	};
+	for (int y = 0; y < fieldY; y++)
 	{
-		//getting the coordinates of a vertex inside the field
-		float x1 = vertex_buffer_single[3 * i] * mx * (1 - spacing * 2);
-		float y1 = vertex_buffer_single[3 * i + 1] * my * (1 - spacing * 2);
+		applyTransformToRow(y, &transform);
+	}
+}
 
-		//transforming the vertex-coordinates (simple matrix multiplication)
-		float x2 = x1 * (*transform)[0][0] + y1 * (*transform)[0][1] + (*transform)[0][2];
-		float y2 = x1 * (*transform)[1][0] + y1 * (*transform)[1][1] + (*transform)[1][2];
+void updateRewind() {
+	auto now = high_resolution_clock::now();
 
-		//setting the new values of the field
-		g_vertex_buffer_data[18 * (16 + x + (fieldY - 1 - y) * fieldX) + 3 * i] = px + x2;
-		g_vertex_buffer_data[18 * (16 + x + (fieldY - 1 - y) * fieldX) + 3 * i + 1] = py + y2;
-		g_vertex_buffer_data[18 * (16 + x + (fieldY - 1 - y) * fieldX) + 3 * i + 2] = vertex_buffer_single[3 * i + 2];
+	if (glfwGetKey(window, GLFW_KEY_BACKSPACE)) {
+		if (!pressedRewind && programState != PROGRAM_STATE_IDLE) {//rewind key is pressed the first time
+			pressedRewind = true;
+			//going back 'dTRewind' milliseconds (or to the oldest snapshot)
+			const GameSnapshot* snapshot = snapshotRing.rewind(dTRewind / dTSnapshot);
+			if (snapshot != nullptr) {
+				restoreSnapshot(snapshot);
+			}
+			tLastSnapshot = now;
+		}
+		return;
 	}
+	pressedRewind = false;
+
+	//storing a snapshot every 'dTSnapshot' milliseconds while the game is running (and not paused)
+	if (programState != PROGRAM_STATE_IDLE && !pause && duration_cast<milliseconds>(now - tLastSnapshot).count() >= dTSnapshot) {
+		saveSnapshot(snapshotRing.push());
+		tLastSnapshot = now;
+	}
+}
+
+void startPerfectClear() {
+	if (perfectClearSearch.valid()) return;
+	//the bricks in the order they will be dropped
+	static_assert(perfectClearBrickCount - 2 <= BrickGenerator::MAX_LOOKAHEAD, "the upcoming bricks need to fit into the lookahead of the generator");
+	PerfectClearResult result;
+	result.bricks[0] = brickDroppingField->getBrickType();
+	result.bricks[1] = nextBrick;
+	brickGenerator.peek(result.bricks + 2, perfectClearBrickCount - 2);
+	if (result.bricks[0] < 0) return;
+
+	//the search only uses copies of the board and the bricks, the game keeps running while it's searching
+	const BitBoard board = BitBoard::fromField(*field);
+	perfectClearSearch = std::async(std::launch::async, [board, result]() mutable {
+		PerfectClearSolver solver{ 4, 0, 1000, kickTable };
+		result.found = solver.solve(board, result.bricks, perfectClearBrickCount, result.solution);
+		result.timedOut = solver.hasTimedOut();
+		result.nodeCount = solver.getNodeCount();
+		return result;
+	});
+}
+
+void updatePerfectClear() {
+	if (!perfectClearSearch.valid() || perfectClearSearch.wait_for(milliseconds(0)) != std::future_status::ready) return;
+	const PerfectClearResult result = perfectClearSearch.get();
+	if (result.found) {
+		printf("perfect clear with %d bricks:", (int)result.solution.size());
+		for (size_t i = 0; i < result.solution.size(); i++) {
+			printf(" %d(x=%d, y=%d, rotation=%d)", result.bricks[i], result.solution[i].x, result.solution[i].y, result.solution[i].rotation);
+		}
+		printf("\n");
+	}
+	else if (result.timedOut) printf("perfect clear: no solution found within the time budget (%llu boards)\n", (unsigned long long)result.nodeCount);
+	else printf("perfect clear: not possible (%llu boards)\n", (unsigned long long)result.nodeCount);
+}
+
+void updateBot() {
+	if (botMoved || !brickDroppingField->hasBrick()) return;
+	botMoved = true;
+
+	const int brick = brickDroppingField->getBrickType();
+	BitBoard board = BitBoard::fromField(*field);
+	Placement placement;
+	std::vector<int> moves;
+	if (!bot.choose(board, brick, nextBrick, &placement) || !findPath(board, brick, placement, moves, *kickTable)) return;
+
+	for (int move : moves) {
+		if (move == BrickDroppingField::TYPE_ROTATE_LEFT || move == BrickDroppingField::TYPE_ROTATE_RIGHT) {
+			int flag = brickDroppingField->canRotateBrick(move);
+			if (!flag) return;
+			brickDroppingField->rotateBrick(move, flag);
+		}
+		else {
+			if (!brickDroppingField->canMoveBrick(move)) return;
+			brickDroppingField->moveBrick(move);
+		}
+	}
+}
+
+void damageField(int x, int y) {
+	//extending the damaged area by the field
+	damageMinX = std::min(damageMinX, x);
+	damageMinY = std::min(damageMinY, y);
+	damageMaxX = std::max(damageMaxX, x);
+	damageMaxY = std::max(damageMaxY, y);
+}
+
+void setBoardTextureField(int x, int y, int type) {
+	const int8_t index = getBoardPaletteIndex(type);
+	int8_t& value = boardTextureData[x + y * boardTextureWidth];
+	if (value == index) return;
+	value = index;
+	boardDirtyMinY = std::min(boardDirtyMinY, y);
+	boardDirtyMaxY = std::max(boardDirtyMaxY, y);
+}
+
+int8_t getBoardPaletteIndex(int type) {
+	//0: empty field, 1 to brickCount: bricks, brickCount + 1: type -2, brickCount + 2 and above: types below -2
+	if (type >= 0) return (int8_t)(1 + type);
+	if (type == -1) return 0;
+	return (int8_t)(brickCount - 1 - type);
+}
+
+bool useBoardTexture() {
+	return rendererMode == RENDERER_TEXTURE && programState != PROGRAM_STATE_ANIMATE_END && programState != PROGRAM_STATE_ANIMATE_COLLAPSE;
+}
+
+bool needsFrame() {
+	return damagedAll || damagedPreview || damageMinX <= damageMaxX || needsPresent;
+}
+
+void updateLayout() {
+	//size of a field of the main field (the layout is centered in the framebuffer)
+	float scale = std::min(frameBufferWidth / layoutWidth, frameBufferHeight / layoutHeight);
+	mainLayout.scale = scale;
+	mainLayout.x = (frameBufferWidth - layoutWidth * scale) / 2;
+	mainLayout.y = (frameBufferHeight - layoutHeight * scale) / 2;
+
+	//the preview field is placed in the upper right corner of the layout
+	previewLayout.scale = previewScale * scale;
+	previewLayout.x = mainLayout.x + (layoutWidth - (4 + 2 * spacing) * previewScale) * scale;
+	previewLayout.y = mainLayout.y + (layoutHeight - (4 + 2 * spacing) * previewScale) * scale;
+
+	//every field is redrawn
+	damagedAll = true;
 }
 
+void applyLayout(const RegionLayout& region) {
+	//scale and offset from fields to normalized device coordinates
+	renderStats.changeState(glUniform4f, layoutTransformID, 2 * region.scale / frameBufferWidth, 2 * region.scale / frameBufferHeight,
+		2 * region.x / frameBufferWidth - 1, 2 * region.y / frameBufferHeight - 1);
+}
+
+void redrawArea(int x, int y, int w, int h) {
+	//clearing and drawing every field, pixels outside of the area are discarded by the scissor test
+	renderStats.changeState(glScissor, x, y, w, h);
+	glClear(GL_COLOR_BUFFER_BIT);
+	renderStats.countCalls(1);
+	if (useBoardTexture()) {
+		//a single triangle covering the framebuffer (see BoardVertexShader)
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+		renderStats.countDraw(3);
+		return;
+	}
+	//the preview field (the first 16 fields) and the main field
+	applyLayout(previewLayout);
+	glDrawArrays(GL_TRIANGLES, 0, 6 * 16);
+	applyLayout(mainLayout);
+	glDrawArrays(GL_TRIANGLES, 6 * 16, 6 * fieldX * fieldY); // (6 indices per rectangle)*fieldcount
+	renderStats.countDraw(6 * 16);
+	renderStats.countDraw(6 * fieldX * fieldY);
+}
+
+void applyTransformToRow(const int y, const mat3* const transform) {
+	//transformed fields may leave their area, so the whole window is redrawn
+	damagedAll = true;
+
+	//the first two rows of the matrix (the last row is always 0, 0, 1)
+	const FieldTransform fieldTransform{
+		(*transform)[0][0], (*transform)[0][1], (*transform)[0][2],
+		(*transform)[1][0], (*transform)[1][1], (*transform)[1][2]
+	};
+	transformFieldRow(fieldX, y, fieldTransform, &g_vertex_buffer_data[18 * getMainFieldIndex(0, y)], &g_shape_buffer_data[24 * getMainFieldIndex(0, y)]);
+}
 void updateAnimationCollapse() {
 	//calculating the elapsed time since the start of the animation
 	auto now = high_resolution_clock::now();
@@ -326,7 +525,7 @@ void updateAnimationCollapse() {
 		}
 
 		//calculating the collapse-factor of the filled rows (between 1 and 0)
-		float f = min(progress * 1.0f / (1.0f - 2 * spacing), 1);
+		float f = min(progress * 1.0f / (1.0f - 2 * spacing), 1.0f);
 		fTurn = max(0.0, 1 - std::sin(PI / 2 * f));
 
 		//calculating the translation-factor of every other row (between 0 and 1) (downwards)
@@ -338,10 +537,7 @@ void updateAnimationCollapse() {
 
 		if (animationPhase == 1) {
 			//adding a collapseRowCount-related value to the current score
-			if (collapseRowCount == 1) setScore(score + POINTS_SINGLE_ROW);
-			else if (collapseRowCount == 2) setScore(score + POINTS_DOUBLE_ROW);
-			else if (collapseRowCount == 3) setScore(score + POINTS_TRIPLE_ROW);
-			else if (collapseRowCount == 4) setScore(score + POINTS_QUADRUPLE_ROW);
+			setScore(score + getCollapsePoints(collapseRowCount));
 			animationPhase = 2;
 		}
 
@@ -356,17 +552,14 @@ void updateAnimationCollapse() {
 				//applying the matrix to every field and dropping the values in the field-array
 				for (int y = 0; y < fieldY; y++)
 				{
-					for (int x = 0; x < fieldX; x++)
-					{
-						int mode = collapseConfiguration.get()[y];
-						//dropping the values in the field-array
-						if (mode > 0) {
-							brickDroppingField->set(x, y - mode, brickDroppingField->get(x, y));
-							brickDroppingField->set(x, y, -1);
-						}
-						//applying the matrix
-						applyTransformToSingleField(x, y, &transform);
+					int mode = collapseConfiguration.get()[y];
+					//dropping the values in the field-array
+					if (mode > 0) {
+						brickDroppingField->copyRow(y, y - mode);
+						brickDroppingField->clearRow(y);
 					}
+					//applying the matrix
+					applyTransformToRow(y, &transform);
 				}
 				//return to the main program
 				setProgramState(PROGRAM_STATE_GAME);
@@ -391,7 +584,7 @@ void updateAnimationCollapse() {
 			//calculating the translation matrix depending on fTrans and mode
 			transform = {
 				1,0,0,
-				0,1,-fTrans * my * mode,
+				0,1,-fTrans * mode,
 				0,0,1
 			};
 		}
@@ -407,17 +600,14 @@ void updateAnimationCollapse() {
 			//calculating the scale/translation matrix depending on mode, fTurn, fTurn2, fTrans, fTrans2 and fTrans3
 			transform = {
 				1,0,0,
-				0,fTurn * fTurn2,my * (-fTrans * mode + fTrans2 * (fieldY - 1 - y) - fTrans3 * (collapseRowCount - 1 - mode)),
+				0,fTurn * fTurn2,-fTrans * mode + fTrans2 * (fieldY - 1 - y) - fTrans3 * (collapseRowCount - 1 - mode),
 				0,0,1
 			};
 		}
 		else continue;
 
 		//applying the calculated transformation to every field in this row
-		for (int x = 0; x < fieldX; x++)
-		{
-			applyTransformToSingleField(x, y, &transform);
-		}
+		applyTransformToRow(y, &transform);
 	}
 }
 
@@ -471,7 +661,7 @@ void updateAnimationEnd() {
 
 	//calculating the scale matrix (scaled around the center of every field)
 	mat3 transform{
-		folding,0,mx * (1 - spacing * 2) * (1.0f - folding) / 2.0f,
+		folding,0,(1 - spacing * 2) * (1.0f - folding) / 2.0f,
 		0,1,0,
 		0,0,1
 	};
@@ -479,19 +669,17 @@ void updateAnimationEnd() {
 	//applying the matrix to every field
 	for (int y = 0; y < fieldY; y++)
 	{
-		for (int x = 0; x < fieldX; x++)
-		{
-			applyTransformToSingleField(x, y, &transform);
-		}
+		applyTransformToRow(y, &transform);
 	}
 }
 
 int generateRandomBrickIndex() {
-	return rand() % brickCount;
+	return brickGenerator.next();
 }
 
 void startBrick() {
 	brickDroppingField->startBrick(nextBrick);
+	botMoved = false;
 	setNextBrick(generateRandomBrickIndex());
 }
 
@@ -500,7 +688,7 @@ void setNextBrick(int type) {
 	nextBrick = type;
 
 	//getting the brick's size
-	int brickSize = brickSizes.get()[type];
+	int brickSize = brickSizes[type];
 
 	//updating every single field in the preview-area
 	for (int y = 0; y < 4; y++)
@@ -509,13 +697,13 @@ void setNextBrick(int type) {
 		{
 			//for each brickSize another translation is applied to the brick (which is represented as an array)
 			//the translation takes part in the if-statements by deciding whether the field needs to be set or not
-			if (brickSize == 2 && y > 0 && x > 0 && y - 1 < brickSize && x - 1 < brickSize && bricks.get()[type].get()[x - 1 + (y - 1) * brickSize]) {
+			if (brickSize == 2 && y > 0 && x > 0 && y - 1 < brickSize && x - 1 < brickSize && bricks[type][x - 1 + (y - 1) * brickSize]) {
 				updatePreviewField(x, y, type);
 			}
-			else if (brickSize == 3 && y > 0 && y - 1 < brickSize && x < brickSize && bricks.get()[type].get()[x + (y - 1) * brickSize]) {
+			else if (brickSize == 3 && y > 0 && y - 1 < brickSize && x < brickSize && bricks[type][x + (y - 1) * brickSize]) {
 				updatePreviewField(x, y, type);
 			}
-			else if (brickSize == 4 && y < brickSize && x < brickSize && bricks.get()[type].get()[x + y * brickSize]) {
+			else if (brickSize == 4 && y < brickSize && x < brickSize && bricks[type][x + y * brickSize]) {
 				updatePreviewField(x, y, type);
 			}
 			else {//clearing the field -> invalid state
@@ -535,13 +723,17 @@ int main(void)
 	if (!windowInitialized) return -1;
 
 	//<modified>
-	//seeding the random-function
-	srand(time(NULL));
+	//seeding the brick generator
+	brickGenerator.seed(time(NULL));
+	//mapping the placements of the bot (optional)
+	if (placementTable.open(placementTablePath, *kickTable)) {
+		printf("placement table: %llu entries for boards up to %d rows\n", (unsigned long long)placementTable.getEntryCount(), placementTable.getMaxHeight());
+	}
 
 	//music: PlaySound((LPCSTR)"TetrisIntro.wav", NULL, SND_FILENAME | SND_ASYNC);
 	
 	//setting the background color
-	glClearColor(backgroundColor.get()[0], backgroundColor.get()[1], backgroundColor.get()[2], 1.0f);
+	glClearColor(backgroundColor[0], backgroundColor[1], backgroundColor[2], 1.0f);
 
 	//initializing the used vertex buffers
 	staticInitVertexBuffer();
@@ -552,6 +744,9 @@ int main(void)
 	//initializing the animation-collapse configuration
 	collapseConfiguration = { new int[fieldY] {}, std::default_delete<int[]>() };
 
+	//applying the rotation rules
+	brickDroppingField->setKickTable(kickTable);
+
 	//adding a listener to the field to apply changes to the vertex/color-buffers
 	brickDroppingField->setOnChanged([](int x, int y, int v) {
 		updateField(x, y);
@@ -573,8 +768,35 @@ int main(void)
 	bool vertexbufferInitialized = initializeVertexbuffer();
 	if (!vertexbufferInitialized) return -1;
 
+	//<modified>
+	//Initialize the offscreen framebuffer (keeps the last frame for partial redraws)
+	bool frameBufferInitialized = initializeFrameBuffer();
+	if (!frameBufferInitialized) return -1;
+	//presenting the last frame again when the window's content was lost (e.g. after being covered)
+	glfwSetWindowRefreshCallback(window, [](GLFWwindow*) {
+		needsPresent = true;
+		});
+	//resizing the offscreen framebuffer and placing the regions again if the window's framebuffer is resized
+	glfwSetFramebufferSizeCallback(window, [](GLFWwindow*, int width, int height) {
+		if (width <= 0 || height <= 0) return;//minimized
+		cleanupFrameBuffer();
+		initializeFrameBuffer();
+		});
+	//</modified>
+
 	// Create and compile our GLSL program from the shaders
-	programID = LoadShaders("SimpleVertexShader.vertexshader", "SimpleFragmentShader.fragmentshader");
+	//<modified>
+	programID = loadProgram("SimpleVertexShader.vertexshader", "SimpleFragmentShader.fragmentshader");
+	initializeProgram();
+	if (rendererMode == RENDERER_TEXTURE && !initializeBoardTexture()) return -1;
+	if (renderStatsEnabled) renderStats.enable();
+	//watching the shader files of the used programs
+	if (hotReloadShaders) {
+		programSlot = shaderReloader.watch("SimpleVertexShader.vertexshader", "SimpleFragmentShader.fragmentshader");
+		if (rendererMode == RENDERER_TEXTURE) boardProgramSlot = shaderReloader.watch("BoardVertexShader.vertexshader", "BoardFragmentShader.fragmentshader");
+		shaderReloader.start(window);
+	}
+	//</modified>
 
 	do {
 		//<modified>
@@ -603,8 +825,25 @@ int main(void)
 				}
 			}
 			else pressedPause = false;
+			if (glfwGetKey(window, GLFW_KEY_C)) {//perfect-clear-button is pressed
+				if (!pressedPerfectClear) {
+					pressedPerfectClear = true;
+					startPerfectClear();
+				}
+			}
+			else pressedPerfectClear = false;
+			if (glfwGetKey(window, GLFW_KEY_A)) {//autoplay-button is pressed
+				if (!pressedAutoplay) {
+					pressedAutoplay = true;
+					autoplay = !autoplay;
+					//a running brick isn't at it's initial location anymore, the bot starts with the next brick
+					botMoved = true;
+				}
+			}
+			else pressedAutoplay = false;
 			if (!pause) {
-				//updating the game mechanics if game isn't paused
+				//letting the bot move the brick and updating the game mechanics if game isn't paused
+				if (autoplay) updateBot();
 				updateGameMechanics();
 			}
 			else {
@@ -636,11 +875,23 @@ int main(void)
 		//consuming space events if they are not already consumed
 		glfwGetKey(window, GLFW_KEY_SPACE);
 
-		//updating buffered data
-		initializeVertexbuffer();
-		//</modified>
-		updateAnimationLoop();
-		//<modified>
+		//storing snapshots and handling the rewind key
+		updateRewind();
+		//printing the result of a finished perfect clear search
+		updatePerfectClear();
+
+		//updating buffered data and drawing a frame (skipped if nothing changed since the last frame)
+		if (hotReloadShaders) updateShaderReload();
+		if (needsFrame()) {
+			renderStats.beginFrame();
+			if (useBoardTexture()) uploadBoardTexture();
+			else initializeVertexbuffer();
+			//</modified>
+			updateAnimationLoop();
+			//<modified>
+			renderStats.endFrame();
+		}
+		glfwPollEvents();
 		
 		//delay game loop (down to one call every 5 milliseconds)
 		auto now = high_resolution_clock::now();
@@ -655,6 +906,15 @@ int main(void)
 		glfwWindowShouldClose(window) == 0);
 
 	//Cleanup and close window
+	//<modified>
+	renderStats.printSummary(stdout);
+	renderStats.disable();
+	shaderReloader.stop();
+	//waiting for a running perfect clear search
+	if (perfectClearSearch.valid()) perfectClearSearch.wait();
+	//</modified>
+	if (rendererMode == RENDERER_TEXTURE) cleanupBoardTexture();
+	cleanupFrameBuffer();
 	cleanupVertexbuffer();
 	glDeleteProgram(programID);
 	closeWindow();
@@ -666,39 +926,106 @@ int main(void)
 // modified regions are marked by //<modified>, //</modified> comments
 void updateAnimationLoop()
 {
-	// Clear the screen
-	glClear(GL_COLOR_BUFFER_BIT);
+	//<modified>
+	// drawing into the offscreen framebuffer, only the damaged areas are cleared and redrawn
+	renderStats.beginSection(RenderStats::SECTION_DRAW);
+	renderStats.changeState(glBindFramebuffer, GL_FRAMEBUFFER, frameBuffer);
+	renderStats.changeState(glEnable, GL_SCISSOR_TEST);
+	//</modified>
 
-	// Use our shader
-	glUseProgram(programID);
-
-	// 1rst attribute buffer : vertices
-	glEnableVertexAttribArray(0);
-	glBindBuffer(GL_ARRAY_BUFFER, vertexbuffer);
-	glVertexAttribPointer(
-		0,                  // attribute 0. No particular reason for 0, but must match the layout in the shader.
-		3,  // size
-		GL_FLOAT,           // type
-		GL_FALSE,           // normalized?
-		0,                  // stride
-		(void*)0            // array buffer offset
-	);
-
-	//<modified> 2nd attribute buffer: colors
-	glEnableVertexAttribArray(1);
-	glBindBuffer(GL_ARRAY_BUFFER, colorbuffer);
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+	//<modified>
+	//switching between the renderers redraws everything
+	const bool texture = useBoardTexture();
+	if (texture != lastFrameTexture) damagedAll = true;
+	lastFrameTexture = texture;
+	if (texture) {
+		//the fields are drawn by the board program (placed at the regions' pixels)
+		renderStats.changeState(glUseProgram, boardProgramID);
+		renderStats.changeState(glUniform3f, boardMainLayoutID, mainLayout.x, mainLayout.y, mainLayout.scale);
+		renderStats.changeState(glUniform3f, boardPreviewLayoutID, previewLayout.x, previewLayout.y, previewLayout.scale);
+		renderStats.changeState(glActiveTexture, GL_TEXTURE0);
+		renderStats.changeState(glBindTexture, GL_TEXTURE_2D, boardTexture);
+	}
+	else {
+		//</modified>
+		// Use our shader
+		//<modified> (the state changes are counted by renderStats)
+		renderStats.changeState(glUseProgram, programID);
+		renderStats.changeState(glUniform1i, sdfAntialiasingID, antialiasingMode == ANTIALIASING_SDF);
+		renderStats.changeState(glUniform2f, framebufferSizeID, (float)frameBufferWidth, (float)frameBufferHeight);
+		renderStats.changeState(glUniform1f, cornerRadiusID, cornerRadius);
+		//the coverage of the rounded rectangles is applied by blending
+		if (antialiasingMode == ANTIALIASING_SDF) {
+			renderStats.changeState(glEnable, GL_BLEND);
+			renderStats.changeState(glBlendFunc, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		}
+
+		// 1rst attribute buffer : vertices
+		renderStats.changeState(glEnableVertexAttribArray, 0);
+		renderStats.changeState(glBindBuffer, GL_ARRAY_BUFFER, vertexbuffer);
+		renderStats.changeState(glVertexAttribPointer,
+			0,                  // attribute 0. No particular reason for 0, but must match the layout in the shader.
+			3,  // size
+			GL_FLOAT,           // type
+			GL_FALSE,           // normalized?
+			0,                  // stride
+			(void*)0            // array buffer offset
+		);
+
+		// 2nd attribute buffer: colors
+		renderStats.changeState(glEnableVertexAttribArray, 1);
+		renderStats.changeState(glBindBuffer, GL_ARRAY_BUFFER, colorbuffer);
+		renderStats.changeState(glVertexAttribPointer, 1, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+
+		//3rd attribute buffer: shapes
+		renderStats.changeState(glEnableVertexAttribArray, 2);
+		renderStats.changeState(glBindBuffer, GL_ARRAY_BUFFER, shapebuffer);
+		renderStats.changeState(glVertexAttribPointer, 2, 4, GL_FLOAT, GL_FALSE, 0, (void*)0);
+	}
+	//</modified>
 
 	// Draw the triangle !
-	glDrawArrays(GL_TRIANGLES, 0, 6 * (fieldX * fieldY + 16)); // (6 indices per rectangle)*(fieldcount+previewFieldCount)
+	if (damagedAll) {
+		redrawArea(0, 0, frameBufferWidth, frameBufferHeight);
+	}
+	else {
+		//redrawing the area of the fields [x0, x1) x [y0, y1) of a region (with one pixel of padding for the antialiased edges)
+		auto redrawFields = [](const RegionLayout& region, int x0, int y0, int x1, int y1) {
+			int px0 = (int)std::floor(region.x + x0 * region.scale) - 1, py0 = (int)std::floor(region.y + y0 * region.scale) - 1;
+			int px1 = (int)std::ceil(region.x + x1 * region.scale) + 1, py1 = (int)std::ceil(region.y + y1 * region.scale) + 1;
+			redrawArea(px0, py0, px1 - px0, py1 - py0);
+		};
+		if (damageMinX <= damageMaxX) {
+			redrawFields(mainLayout, damageMinX, damageMinY, damageMaxX + 1, damageMaxY + 1);
+		}
+		if (damagedPreview) {
+			redrawFields(previewLayout, 0, 0, 4, 4);
+		}
+	}
 	
-	glDisableVertexAttribArray(0);
-	glDisableVertexAttribArray(1);
+	renderStats.changeState(glDisableVertexAttribArray, 0);
+	renderStats.changeState(glDisableVertexAttribArray, 1);
+	renderStats.changeState(glDisableVertexAttribArray, 2);
+	renderStats.changeState(glDisable, GL_SCISSOR_TEST);
+	renderStats.changeState(glDisable, GL_BLEND);
+
+	// resolving the offscreen framebuffer to the window
+	renderStats.changeState(glBindFramebuffer, GL_READ_FRAMEBUFFER, frameBuffer);
+	renderStats.changeState(glBindFramebuffer, GL_DRAW_FRAMEBUFFER, 0);
+	glBlitFramebuffer(0, 0, frameBufferWidth, frameBufferHeight, 0, 0, frameBufferWidth, frameBufferHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+	renderStats.countCalls(1);
+	renderStats.changeState(glBindFramebuffer, GL_FRAMEBUFFER, 0);
+	renderStats.endSection(RenderStats::SECTION_DRAW);
+
+	// resetting the damage
+	damageMinX = fieldX;
+	damageMinY = fieldY;
+	damageMaxX = damageMaxY = -1;
+	damagedPreview = damagedAll = needsPresent = false;
 	//</modified>
 
 	// Swap buffers
 	glfwSwapBuffers(window);
-	glfwPollEvents();
 }
 
 bool initializeWindow()
@@ -711,18 +1038,21 @@ bool initializeWindow()
 		return false;
 	}
 
-	glfwWindowHint(GLFW_SAMPLES, 4);
+	// <modified>
+	// antialiasing is done in the offscreen framebuffer (see antialiasingMode)
+	glfwWindowHint(GLFW_SAMPLES, 0);
+	// </modified>
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
 	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE); // To make MacOS happy; should not be needed
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 	// <modified>
-	// disabling window resizing
-	glfwWindowHint(GLFW_RESIZABLE, false);
+	// the window can be resized (the layout is fitted into the framebuffer, see updateLayout)
+	glfwWindowHint(GLFW_RESIZABLE, true);
 
-	// calculating window dimensions depending of the aspect ratio of the field
+	// calculating the initial window dimensions depending of the aspect ratio of the layout
 	// and the maximum dimensions (maxWindowSizeX and maxWindowSizeY)
-	float f = 1.0f * fieldX / fieldY * 2.0f / widthMainField;
+	float f = layoutWidth / layoutHeight;
 
 	int w = maxWindowSizeX;
 	int h = w / f;
@@ -770,27 +1100,165 @@ bool initializeVertexbuffer()
 
 	// </modified>
 
-	glBindBuffer(GL_ARRAY_BUFFER, vertexbuffer);
+	//<modified>
+	renderStats.beginSection(RenderStats::SECTION_UPLOAD);
+	//</modified>
+
+	renderStats.changeState(glBindBuffer, GL_ARRAY_BUFFER, vertexbuffer);
 
 	glBufferData(GL_ARRAY_BUFFER, sizeof(g_vertex_buffer_data), g_vertex_buffer_data, GL_STATIC_DRAW);
 
 	// <modified>
 	
-	glBindBuffer(GL_ARRAY_BUFFER, colorbuffer);
+	renderStats.changeState(glBindBuffer, GL_ARRAY_BUFFER, colorbuffer);
 
 	glBufferData(GL_ARRAY_BUFFER, sizeof(g_color_buffer_data), g_color_buffer_data, GL_STATIC_DRAW);
 
+	renderStats.changeState(glBindBuffer, GL_ARRAY_BUFFER, shapebuffer);
+
+	glBufferData(GL_ARRAY_BUFFER, sizeof(g_shape_buffer_data), g_shape_buffer_data, GL_STATIC_DRAW);
+
+	renderStats.endSection(RenderStats::SECTION_UPLOAD);
+	renderStats.countUpload(sizeof(g_vertex_buffer_data));
+	renderStats.countUpload(sizeof(g_color_buffer_data));
+	renderStats.countUpload(sizeof(g_shape_buffer_data));
 	//</modified>
 
 	return true;
 }
 
+GLuint loadProgram(const char* vertexShader, const char* fragmentShader)
+{
+	if (loadShaderFiles || hotReloadShaders) return LoadShaders(vertexShader, fragmentShader);
+	//the shaders are embedded by the build (see embed_shaders in CMakeLists.txt)
+	const char* vertexSource = embeddedShaders::find(vertexShader);
+	const char* fragmentSource = embeddedShaders::find(fragmentShader);
+	if (vertexSource == nullptr || fragmentSource == nullptr) {
+		fprintf(stderr, "The shaders %s and %s aren't embedded\n", vertexShader, fragmentShader);
+		return 0;
+	}
+	return LoadShadersFromSource(vertexSource, fragmentSource, vertexShader, fragmentShader);
+}
+void updateShaderReload()
+{
+	//the reloaded programs replace the previous ones, the next frame redraws everything with them
+	GLuint program;
+	if (shaderReloader.take(programSlot, &program)) {
+		glDeleteProgram(programID);
+		programID = program;
+		initializeProgram();
+		damagedAll = true;
+	}
+	if (boardProgramSlot >= 0 && shaderReloader.take(boardProgramSlot, &program)) {
+		glDeleteProgram(boardProgramID);
+		boardProgramID = program;
+		initializeBoardProgram();
+		damagedAll = true;
+	}
+}
+bool initializeFrameBuffer()
+{
+	//the framebuffer may differ from the window size in screen coordinates (e.g. on high-dpi displays)
+	glfwGetFramebufferSize(window, &frameBufferWidth, &frameBufferHeight);
+
+	//(multisampled) color buffer, it's content is kept between frames
+	glGenRenderbuffers(1, &frameBufferColor);
+	glBindRenderbuffer(GL_RENDERBUFFER, frameBufferColor);
+	glRenderbufferStorageMultisample(GL_RENDERBUFFER, frameBufferSamples, GL_RGBA8, frameBufferWidth, frameBufferHeight);
+
+	glGenFramebuffers(1, &frameBuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, frameBuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, frameBufferColor);
+	bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	if (!complete) {
+		fprintf(stderr, "Failed to create the offscreen framebuffer\n");
+		return false;
+	}
+
+	//placing the regions in the new framebuffer (the first frame redraws everything)
+	glViewport(0, 0, frameBufferWidth, frameBufferHeight);
+	updateLayout();
+	return true;
+}
+
+void initializeProgram()
+{
+	layoutTransformID = glGetUniformLocation(programID, "layoutTransform");
+	sdfAntialiasingID = glGetUniformLocation(programID, "sdfAntialiasing");
+	framebufferSizeID = glGetUniformLocation(programID, "framebufferSize");
+	cornerRadiusID = glGetUniformLocation(programID, "cornerRadius");
+}
+bool initializeBoardProgram()
+{
+	if (boardProgramID == 0) return false;
+	boardMainLayoutID = glGetUniformLocation(boardProgramID, "mainLayout");
+	boardPreviewLayoutID = glGetUniformLocation(boardProgramID, "previewLayout");
+
+	//the uniforms that never change
+	GLfloat palette[3 * boardPaletteSize];
+	for (int type = -2 - brickCount; type < brickCount; type++) {
+		const int index = getBoardPaletteIndex(type);
+		getTypeColor(type, &palette[3 * index], &palette[3 * index + 1], &palette[3 * index + 2]);
+	}
+	glUseProgram(boardProgramID);
+	glUniform3fv(glGetUniformLocation(boardProgramID, "palette"), boardPaletteSize, palette);
+	glUniform3f(glGetUniformLocation(boardProgramID, "backgroundColor"), backgroundColor[0], backgroundColor[1], backgroundColor[2]);
+	glUniform2i(glGetUniformLocation(boardProgramID, "fieldSize"), fieldX, fieldY);
+	glUniform1f(glGetUniformLocation(boardProgramID, "spacing"), spacing);
+	glUniform1i(glGetUniformLocation(boardProgramID, "board"), 0);
+	return true;
+}
+bool initializeBoardTexture()
+{
+	boardProgramID = loadProgram("BoardVertexShader.vertexshader", "BoardFragmentShader.fragmentshader");
+	if (!initializeBoardProgram()) return false;
+
+	//one byte per field, read without filtering by texelFetch
+	glGenTextures(1, &boardTexture);
+	glBindTexture(GL_TEXTURE_2D, boardTexture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_R8I, boardTextureWidth, boardTextureHeight, 0, GL_RED_INTEGER, GL_BYTE, nullptr);
+	//the first upload contains every row
+	boardDirtyMinY = 0;
+	boardDirtyMaxY = boardTextureHeight - 1;
+	return true;
+}
+bool uploadBoardTexture()
+{
+	if (boardDirtyMinY > boardDirtyMaxY) return true;
+	renderStats.beginSection(RenderStats::SECTION_UPLOAD);
+	//the rows are tightly packed
+	renderStats.changeState(glPixelStorei, GL_UNPACK_ALIGNMENT, 1);
+	renderStats.changeState(glBindTexture, GL_TEXTURE_2D, boardTexture);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, boardDirtyMinY, boardTextureWidth, boardDirtyMaxY - boardDirtyMinY + 1, GL_RED_INTEGER, GL_BYTE, &boardTextureData[boardDirtyMinY * boardTextureWidth]);
+	renderStats.endSection(RenderStats::SECTION_UPLOAD);
+	renderStats.countUpload((boardDirtyMaxY - boardDirtyMinY + 1) * boardTextureWidth);
+	boardDirtyMinY = boardTextureHeight;
+	boardDirtyMaxY = -1;
+	return true;
+}
+bool cleanupBoardTexture()
+{
+	glDeleteTextures(1, &boardTexture);
+	glDeleteProgram(boardProgramID);
+	return true;
+}
+bool cleanupFrameBuffer()
+{
+	glDeleteFramebuffers(1, &frameBuffer);
+	glDeleteRenderbuffers(1, &frameBufferColor);
+	return true;
+}
+
 bool cleanupVertexbuffer()
 {
 	// Cleanup VBO
 	glDeleteBuffers(1, &vertexbuffer);
 	//<modified> cleanup color buffer
 	glDeleteBuffers(1, &colorbuffer);
+	glDeleteBuffers(1, &shapebuffer);
 	//</modified>
 	glDeleteVertexArrays(1, &VertexArrayID);
 	return true;
@@ -5,18 +5,42 @@
 #include <GL/glew.h>
 #include <memory>
 #include <chrono>
+#include <future>
 #include <glfw3.h>
 #include <glm/glm.hpp>
+#include "brickGenerator.h"
+#include "gameSnapshot.h"
+#include "placementTable.h"
+#include "bot.h"
+#include "perfectClearSolver.h"
+#include <common/renderstats.hpp>
+#include <common/shaderreloader.hpp>
 using namespace glm;
 
 //some global variables for handling the vertex (and color) buffer
 GLuint vertexbuffer;
 GLuint colorbuffer;
+GLuint shapebuffer;
 GLuint VertexArrayID;
 GLuint vertexbuffer_size;
+//shape buffer: corner of every vertex inside it's rectangle (0 or 1 in x and y) and the rectangle's size (in fields)
+//used by the shaders to calculate the coverage of rounded rectangles (see ANTIALIASING_SDF)
+GLfloat g_shape_buffer_data[4 * 6 * (gameData::fieldX * gameData::fieldY + 16)]{};
 
 //program ID of the shaders, required for handling the shaders with OpenGL
 GLuint programID;
+//whether the shaders are loaded from the working directory (to edit them without rebuilding) instead of the sources compiled into the executable
+const bool loadShaderFiles = false;
+//whether the programs are replaced when their shader files in the working directory change (linux only, implies loadShaderFiles)
+//the changed shaders are compiled on a background thread, a shader that doesn't compile keeps the previous program
+const bool hotReloadShaders = false;
+ShaderReloader shaderReloader;
+//slots of the programs in shaderReloader
+int programSlot = -1, boardProgramSlot = -1;
+//location of the shader's uniform that places a region of fields in the window
+GLint layoutTransformID;
+//locations of the shader's antialiasing uniforms (mode, framebuffer size and corner radius)
+GLint sdfAntialiasingID, framebufferSizeID, cornerRadiusID;
 
 using namespace std::chrono;
 
@@ -27,14 +51,12 @@ constexpr double PI = 3.141592653589793238462643383279502884;
 const int maxWindowSizeX = 1000;
 const int maxWindowSizeY = 900;
 
-//current score and points (depending on row count during collapse) 
+//current score (the points depending on row count during collapse are defined in gameData.h)
 int score = 0;
-constexpr int POINTS_SINGLE_ROW = 20;
-constexpr int POINTS_DOUBLE_ROW = 50;
-constexpr int POINTS_TRIPLE_ROW = 100;
-constexpr int POINTS_QUADRUPLE_ROW = 180;
 //brick to be dropped next (visualized in preview-field)
 int nextBrick;
+//generator of the brick types (seeded at startup)
+gameUtils::BrickGenerator brickGenerator;
 
 //program states and current program state
 const int PROGRAM_STATE_GAME = 0,
@@ -66,6 +88,8 @@ float dTDrop = dTDropInit;
 float factorPressedFaster = 0.85;
 //factor to increase speed on every brick
 float factorIncreaseSpeed = 1.017;
+//translations that are tested when a brick is rotated (gameData::KICKS_LEGACY or gameData::KICKS_SRS)
+const gameData::KickTable* const kickTable = &gameData::KICKS_LEGACY;
 //states of keys that are pressed or not
 bool pressedLeft = false, pressedRight = false, pressedRotateRight = false, pressedFaster = false;
 
@@ -76,6 +100,35 @@ high_resolution_clock::time_point pauseStart;
 //whether the game is in pause state and the pause-button is pressed or not
 bool pause = false, pressedPause = false;
 
+//--PROGRAM_STATE_GAME->analysis--
+
+//whether the perfect-clear-key is pressed or not
+bool pressedPerfectClear = false;
+//number of bricks (current, next and upcoming bricks of 'brickGenerator') the perfect clear search uses
+const int perfectClearBrickCount = 10;
+/*
+* result of a perfect clear search
+*/
+struct PerfectClearResult {
+	//bricks in the order they will be dropped and the placement of each brick (empty if there is no solution)
+	int bricks[perfectClearBrickCount];
+	std::vector<gameUtils::Placement> solution;
+	bool found, timedOut;
+	uint64_t nodeCount;
+};
+//search that runs on a worker thread (invalid if no search is running, printed by updatePerfectClear once it's ready)
+std::future<PerfectClearResult> perfectClearSearch;
+
+//--PROGRAM_STATE_GAME->autoplay--
+
+//file of precomputed placements for low boards (built by the placementtable tool, the bot searches every placement if it's missing)
+const char* const placementTablePath = "placements.bin";
+gameUtils::PlacementTable placementTable;
+//bot that places the bricks while autoplay is enabled
+gameUtils::Bot bot{ &placementTable, kickTable };
+//whether the bot places the bricks, the autoplay-key is pressed and the bot has already moved the current brick
+bool autoplay = false, pressedAutoplay = false, botMoved = false;
+
 //--PROGRAM_STATE_ANIMATE_END || PROGRAM_STATE_ANIMATE_COLLAPSE--
 
 //time point to calculate the progress of an animation
@@ -119,6 +172,86 @@ const long waitDelay = 2500;
 int programStateAfterWait;
 
 
+//--rewind (all states except PROGRAM_STATE_IDLE)--
+
+//how often a snapshot of the game is stored (in milliseconds)
+const long dTSnapshot = 50;
+//how far the game can be rewound (in milliseconds)
+const long dTRewindMax = 10000;
+//how far the game is rewound every time the rewind-key is pressed (in milliseconds)
+const long dTRewind = 1000;
+//snapshots of the last 'dTRewindMax' milliseconds
+gameUtils::SnapshotRing snapshotRing{ dTRewindMax / dTSnapshot };
+//time point of the latest snapshot
+high_resolution_clock::time_point tLastSnapshot;
+//whether the rewind-key is pressed or not
+bool pressedRewind = false;
+
+
+//--rendering (all states)--
+
+//antialiasing of the fields' edges:
+//ANTIALIASING_MSAA: 4 samples per pixel in the offscreen framebuffer (rectangular fields)
+//ANTIALIASING_SDF: one sample per pixel, the fragment shader calculates the coverage of rounded rectangles from their signed distance
+const int ANTIALIASING_MSAA = 0, ANTIALIASING_SDF = 1;
+const int antialiasingMode = ANTIALIASING_MSAA;
+//radius of the rounded corners (relative to half of the smaller side of a field, ANTIALIASING_SDF only)
+const float cornerRadius = 0.3f;
+//number of samples per pixel of the offscreen framebuffer (0 for a framebuffer without multisampling)
+const int frameBufferSamples = antialiasingMode == ANTIALIASING_MSAA ? 4 : 0;
+//offscreen framebuffer that keeps the last frame, so only damaged areas need to be redrawn (it's resolved to the window when a frame is presented)
+GLuint frameBuffer = 0, frameBufferColor = 0;
+int frameBufferWidth = 0, frameBufferHeight = 0;
+//damaged area of the main field in fields (no field is damaged if damageMinX > damageMaxX)
+int damageMinX = gameData::fieldX, damageMinY = gameData::fieldY, damageMaxX = -1, damageMaxY = -1;
+//whether the preview area or the whole window needs to be redrawn (fields that are transformed by animations may leave their area)
+bool damagedPreview = false, damagedAll = true;
+//whether the last frame needs to be presented again without redrawing anything (e.g. after the window was exposed)
+bool needsPresent = true;
+
+//renderers of the fields:
+//RENDERER_VERTICES: two triangles per field with colors per vertex (the vertex- and color-buffer are uploaded on every change)
+//RENDERER_TEXTURE: the types of every field are stored in an integer texture, a fragment shader draws the fields of a fullscreen triangle
+//(only changed rows of the texture are uploaded, the animations that transform single fields always use RENDERER_VERTICES)
+const int RENDERER_VERTICES = 0, RENDERER_TEXTURE = 1;
+const int rendererMode = RENDERER_VERTICES;
+//whether the last frame was drawn by RENDERER_TEXTURE (the whole window is redrawn if the renderer changes)
+bool lastFrameTexture = false;
+//program of RENDERER_TEXTURE and it's uniform locations
+GLuint boardProgramID;
+GLint boardMainLayoutID, boardPreviewLayoutID;
+//texture of the fields' palette indices (rows 0 to fieldY-1: main field, rows fieldY to fieldY+3: preview field from bottom to top)
+//every field starts empty (palette index 0)
+GLuint boardTexture;
+const int boardTextureWidth = gameData::fieldX > 4 ? gameData::fieldX : 4, boardTextureHeight = gameData::fieldY + 4;
+int8_t boardTextureData[boardTextureWidth * boardTextureHeight];
+//number of colors in the board program's palette (see getBoardPaletteIndex)
+const int boardPaletteSize = 2 * gameData::brickCount + 2;
+static_assert(boardPaletteSize == 16, "the palette needs to equal paletteSize of BoardFragmentShader.fragmentshader");
+//rows of the texture that changed since the last upload (no row changed if boardDirtyMinY > boardDirtyMaxY)
+int boardDirtyMinY = 0, boardDirtyMaxY = boardTextureHeight - 1;
+
+//render statistics (GPU time of the uploads and the drawing, GL calls, uploaded bytes, vertices and state changes per frame)
+//the averages are printed when the playground is closed
+const bool renderStatsEnabled = false;
+RenderStats renderStats;
+
+//size of the layout in fields of the main field (the main field on the left, the preview field in the upper right corner)
+const float layoutWidth = 2.0f / gameData::mx, layoutHeight = 2.0f / gameData::my;
+//size of a preview field in fields of the main field
+const float previewScale = gameData::mxPreview / gameData::mx;
+/*
+* placement of a region of fields in the framebuffer
+* the vertices of a region are stored in fields (field (x, y) covers [x, x+1] x [y, y+1]) and transformed by the shader
+*/
+struct RegionLayout {
+	//size of a field and the region's lower left corner (in pixels)
+	float scale, x, y;
+};
+//placement of the main field and the preview field (set by updateLayout)
+RegionLayout mainLayout, previewLayout;
+
+
 /*
 * initialize the vertex- (and color-) buffer
 * both buffers get filled with their initial values (empty fields and background-colors)
@@ -168,15 +301,100 @@ void setNextBrick(int type);
 void setProgramState(int state);
 
 /*
-* apply a transformation to a single field in the main-area
+* save the complete game state
+* @param snapshot the snapshot the state will be applied to
+*/
+void saveSnapshot(gameUtils::GameSnapshot* snapshot);
+
+/*
+* restore the complete game state and update the view
+* @param snapshot the snapshot to restore
+*/
+void restoreSnapshot(const gameUtils::GameSnapshot* snapshot);
+
+/*
+* store a snapshot every 'dTSnapshot' milliseconds and rewind the game when the rewind-key (backspace) is pressed
+*/
+void updateRewind();
+
+/*
+* start a search on a worker thread that checks whether the field can be cleared completely with the current, the next and
+* the upcoming bricks (the current brick is treated as if it was just started), ignored while a search is running
+*/
+void startPerfectClear();
+
+/*
+* print the result of the perfect clear search to the console once it's ready (called every loop, doesn't block)
+*/
+void updatePerfectClear();
+
+/*
+* move the current brick to the placement chosen by 'bot' (once per brick, called while autoplay is enabled)
+* the brick is moved from it's initial location by the same movements and rotations the player can use
+*/
+void updateBot();
+
+/*
+* mark a field of the main area as damaged (it's area is redrawn with the next frame)
 * @param x field's x-coordinate
 * @param y field's y-coordinate
-* @param transform the transformation-matrix that will be applied to the field (in homogenous coordinates)
 */
-void applyTransformToSingleField(const int x, const int y, const mat3* const transform);
+void damageField(int x, int y);
+
+/*
+* check whether a frame needs to be drawn (something is damaged or the last frame needs to be presented again)
+* @return if a frame needs to be drawn
+*/
+bool needsFrame();
+
+/*
+* store the type of a field in the board texture (the row is uploaded with the next frame of RENDERER_TEXTURE)
+* @param x, y the field's coordinates in the texture
+* @param type the field's type
+*/
+void setBoardTextureField(int x, int y, int type);
+
+/*
+* get the index of a type's color in the palette of RENDERER_TEXTURE
+* @param type the field's type (see gameData::getTypeColor)
+* @return the palette index
+*/
+int8_t getBoardPaletteIndex(int type);
+
+/*
+* check whether the next frame is drawn by RENDERER_TEXTURE
+* @return if the board texture is used
+*/
+bool useBoardTexture();
+
+/*
+* fit the layout into the framebuffer (centered, keeping it's aspect ratio) and update the placement of every region
+* no vertex is modified, the regions are placed by the shader's transformation
+*/
+void updateLayout();
+
+/*
+* set the shader's transformation to a region
+* @param region placement of the region
+*/
+void applyLayout(const RegionLayout& region);
+
+/*
+* clear and redraw an area of the offscreen framebuffer (every other pixel keeps it's value)
+* @param x, y the area's lower left corner (in pixels)
+* @param w, h the area's dimensions (in pixels)
+*/
+void redrawArea(int x, int y, int w, int h);
+
+/*
+* apply a transformation to every field of a row in the main-area
+* @param y row's y-coordinate
+* @param transform the transformation-matrix that will be applied to every field (in homogenous coordinates)
+*/
+void applyTransformToRow(const int y, const mat3* const transform);
 
 /*
-* generate a random index for the next brick
+* generate a random index for the next brick (consumes the next brick of 'brickGenerator')
 */
 int generateRandomBrickIndex();
 
@@ -203,6 +421,15 @@ int main( void ); //<<< main function, called at startup
 void updateAnimationLoop(); //<<< updates the animation loop
 bool initializeWindow(); //<<< initializes the window using GLFW and GLEW
 bool initializeVertexbuffer(); //<<< initializes the vertex buffer array and binds it OpenGL
+GLuint loadProgram(const char* vertexShader, const char* fragmentShader); //<<< loads a program of the playground's shaders (embedded or from the working directory, see loadShaderFiles)
+void initializeProgram(); //<<< gets the uniform locations of programID
+bool initializeBoardProgram(); //<<< gets the uniform locations of boardProgramID and sets it's constant uniforms
+void updateShaderReload(); //<<< replaces the programs that were reloaded by shaderReloader (between frames)
+bool initializeFrameBuffer(); //<<< creates the offscreen framebuffer in the size of the window's framebuffer
+bool initializeBoardTexture(); //<<< creates the board texture and the program of RENDERER_TEXTURE
+bool uploadBoardTexture(); //<<< uploads the changed rows of the board texture
+bool cleanupBoardTexture(); //<<< frees the board texture and it's program
+bool cleanupFrameBuffer(); //<<< frees the offscreen framebuffer
 bool cleanupVertexbuffer(); //<<< frees all resources from the vertex buffer
 bool closeWindow(); //<<< Closes the OpenGL window and terminates GLFW
 